@@ -23,8 +23,11 @@ unique_ptr<io::ostream> io::sterr;
 static void init_runtime_work()
 {
     //io::stin  = make_unique<io::ifstream>(0);
-    io::stout = make_unique<io::ofstream>(1);
-    io::sterr = make_unique<io::ofstream>(2);
+    // Standard output is line buffered for terminals and fully buffered
+    // for files and pipes. Standard error is always line buffered so
+    // diagnostics show up in a timely fashion.
+    io::stout = make_unique<io::ofstream>(1, io::buffer_mode::automatic);
+    io::sterr = make_unique<io::ofstream>(2, io::buffer_mode::line);
 }
 
 namespace sys::nonpublic {
@@ -34,4 +37,13 @@ namespace sys::nonpublic {
         static once_flag of;
         call_once(of, init_runtime_work);
     }
+
+    void term_runtime()
+    {
+        // Commit any output still lingering in the standard streams
+        if (io::stout)
+            io::stout->flush();
+        if (io::sterr)
+            io::sterr->flush();
+    }
 }
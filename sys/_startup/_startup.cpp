@@ -15,6 +15,7 @@ extern sys::app* CreateApp();
 
 namespace sys::nonpublic {
     extern void init_runtime();
+    extern void term_runtime();
 }
 
 int main (int argc, char* argv[])
@@ -24,7 +25,14 @@ int main (int argc, char* argv[])
     // Until we're ready to do something with them
     (void)argc; (void)argv;
 
-    sys::unique_ptr<sys::app> app(CreateApp());
-    auto res = app->Run();
+    int res;
+    {
+        sys::unique_ptr<sys::app> app(CreateApp());
+        res = app->Run();
+    }
+
+    // Flush standard output (and friends) now that the app is gone
+    sys::nonpublic::term_runtime();
+
     return res;
 }
@@ -0,0 +1,226 @@
+/**
+ * @file    char_set.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Vectorized char_set search and count kernels
+ *
+ * A block of chars is tested against the set with three byte lookups: the
+ * low nibble of each char picks a byte from each half of the bitmap, and
+ * the high nibble picks the bit within it. Built for AVX2 with 32-byte
+ * blocks and for SSSE3 with 16-byte blocks; without a byte shuffle, a
+ * plain bitmap loop is quicker, so that's the baseline.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <char_set_.h>
+#include <imp/vec_kernel.h>
+
+_SYS_BEGIN_NS
+namespace imp {
+
+namespace {
+
+/// Tests c against a char_set bitmap
+inline bool is_member(const uint8_t* bits, char c) noexcept
+{
+    const auto uc = static_cast<uint8_t>(c);
+    return (bits[(uc & 15u) | ((uc >> 7) << 4)] >> ((uc >> 4) & 7)) & 1u;
+}
+
+/// Lookup tables for one set, each repeated across 16-byte lanes
+template <size_t W>
+struct set_tables
+{
+    using u8v = vec<uint8_t, W>;
+
+    explicit SYS_KERNEL set_tables(const uint8_t* bits) noexcept
+    {
+        for (size_t i = 0; i < W; ++i) {
+            lo_half[i] = bits[i & 15];
+            hi_half[i] = bits[16 + (i & 15)];
+            bit[i]     = static_cast<uint8_t>(1u << (i & 7));
+        }
+    }
+
+    /// Sets each lane of m whose char in v is (match) or isn't in the set
+    SYS_KERNEL void test(u8v& m, const u8v& v, bool match) const noexcept
+    {
+        const uint8_t nibble = 15, top = 0x80;
+        const u8v lo = v & nibble;
+        const u8v hi = v >> 4;
+
+        u8v a, b, sel;
+        lookup16(a, lo_half, lo);
+        lookup16(b, hi_half, lo);
+        lookup16(sel, bit, hi);
+
+        const u8v low = reinterpret_cast<u8v>(v < top);
+        const u8v in = ((a & low) | (b & ~low)) & sel;
+        m = match ? reinterpret_cast<u8v>(in != 0) : reinterpret_cast<u8v>(in == 0);
+    }
+
+    u8v lo_half, hi_half, bit;
+};
+
+template <size_t W>
+SYS_KERNEL size_t find_in_set_blocks(const char* p, size_t len, const uint8_t* bits, bool match) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const set_tables<W> t(bits);
+    u8v v, m;
+    size_t i = 0;
+    for (; len - i >= W; i += W) {
+        load(v, p + i);
+        t.test(m, v, match);
+        if (any_set(m))
+            return i + first_set(m);
+    }
+
+    if (i == len)
+        return len;
+
+    // Finish with the last full block (len is at least W), overlapping what's been searched
+    load(v, p + len - W);
+    t.test(m, v, match);
+    return any_set(m) ? len - W + first_set(m) : len;
+}
+
+template <size_t W>
+SYS_KERNEL size_t rfind_in_set_blocks(const char* p, size_t len, const uint8_t* bits, bool match) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const set_tables<W> t(bits);
+    u8v v, m;
+    size_t i = len;
+    for (; i >= W; i -= W) {
+        load(v, p + i - W);
+        t.test(m, v, match);
+        if (any_set(m))
+            return i - W + last_set(m);
+    }
+
+    if (i == 0)
+        return len;
+
+    // Finish with the first full block, overlapping what's been searched
+    load(v, p);
+    t.test(m, v, match);
+    return any_set(m) ? last_set(m) : len;
+}
+
+template <size_t W>
+SYS_KERNEL size_t count_in_set_blocks(const char* p, size_t len, const uint8_t* bits) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const set_tables<W> t(bits);
+
+    // Members are tallied per lane, and the lanes summed before they can
+    // wrap
+    size_t count = 0, done = 0;
+    while (len - done >= W) {
+        const size_t blocks = ((len - done) / W < 255) ? (len - done) / W : 255;
+        u8v tally{};
+        for (size_t i = 0; i < blocks; ++i, done += W) {
+            u8v v, m;
+            load(v, p + done);
+            t.test(m, v, true);
+            tally -= m;
+        }
+        for (size_t i = 0; i < W; ++i)
+            count += tally[i];
+    }
+
+    for (; done < len; ++done)
+        count += is_member(bits, p[done]);
+    return count;
+}
+
+/// A set of kernels built for one target
+struct set_kernels
+{
+    size_t (*find)(const char*, size_t, const uint8_t*, bool) noexcept;
+    size_t (*rfind)(const char*, size_t, const uint8_t*, bool) noexcept;
+    size_t (*count)(const char*, size_t, const uint8_t*) noexcept;
+};
+
+#define SYS_KERNEL_SET(name, attr, width)                                                   \
+    attr size_t name##_find(const char* p, size_t n, const uint8_t* b, bool m) noexcept     \
+        { return find_in_set_blocks<width>(p, n, b, m); }                                   \
+    attr size_t name##_rfind(const char* p, size_t n, const uint8_t* b, bool m) noexcept    \
+        { return rfind_in_set_blocks<width>(p, n, b, m); }                                  \
+    attr size_t name##_count(const char* p, size_t n, const uint8_t* b) noexcept            \
+        { return count_in_set_blocks<width>(p, n, b); }                                     \
+    constexpr set_kernels name##_kernels{ name##_find, name##_rfind, name##_count };
+
+#ifdef SYS_KERNEL_X86
+SYS_KERNEL_SET(avx2,  __attribute__((target("avx2"))),  32)
+SYS_KERNEL_SET(ssse3, __attribute__((target("ssse3"))), 16)
+#endif
+
+#undef SYS_KERNEL_SET
+
+size_t base_find(const char* p, size_t n, const uint8_t* b, bool m) noexcept
+{
+    size_t i = 0;
+    for (; (i < n) && (is_member(b, p[i]) != m); ++i);
+    return i;
+}
+
+size_t base_rfind(const char* p, size_t n, const uint8_t* b, bool m) noexcept
+{
+    for (size_t i = n; i--; ) {
+        if (is_member(b, p[i]) == m)
+            return i;
+    }
+    return n;
+}
+
+size_t base_count(const char* p, size_t n, const uint8_t* b) noexcept
+{
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += is_member(b, p[i]);
+    return count;
+}
+
+constexpr set_kernels base_kernels{ base_find, base_rfind, base_count };
+
+const set_kernels& select_kernels() noexcept
+{
+    switch (detect_kernel_isa()) {
+#ifdef SYS_KERNEL_X86
+        case kernel_isa::avx2:  return avx2_kernels;
+        case kernel_isa::ssse3: return ssse3_kernels;
+#endif
+        default:                return base_kernels;
+    }
+}
+
+const set_kernels& kernels() noexcept
+{
+    static const set_kernels& selected = select_kernels();
+    return selected;
+}
+
+}   // end anonymous namespace
+
+size_t find_in_set_kernel(const char* p, size_t len, const uint8_t* bits, bool match) noexcept
+{
+    return kernels().find(p, len, bits, match);
+}
+
+size_t rfind_in_set_kernel(const char* p, size_t len, const uint8_t* bits, bool match) noexcept
+{
+    return kernels().rfind(p, len, bits, match);
+}
+
+size_t count_in_set_kernel(const char* p, size_t len, const uint8_t* bits) noexcept
+{
+    return kernels().count(p, len, bits);
+}
+
+} // end namespace imp
+_SYS_END_NS
@@ -0,0 +1,432 @@
+/**
+ * @file    char_traits.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Vectorized length, compare, find, and case mapping kernels for
+ *          char_traits<char>, and substring search
+ *
+ * Built for AVX2 with 32-byte blocks and for the baseline SSE2 with 16-byte
+ * blocks; the best set the CPU supports is picked the first time one is
+ * used.
+ *
+ * Null-terminated strings have no known end, so a block may extend past
+ * the terminator. Those reads never cross into the next page, which might
+ * not be mapped: length() uses aligned blocks, and compare() takes a block
+ * a char at a time when either string is within a block of a page end.
+ * Searches over a known length never read outside it.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <char_traits_.h>
+#include <imp/string_search.h>
+#include <imp/vec_kernel.h>
+
+_SYS_BEGIN_NS
+namespace imp {
+
+namespace {
+
+constexpr size_t page_size = 4096;
+
+// The length and compare kernels read whole blocks past the terminator on
+// purpose (see above). That's safe, but AddressSanitizer can't tell, so
+// these kernels and the entry points they're inlined into go uninstrumented.
+#define SYS_OVERREAD __attribute__((no_sanitize_address))
+
+alignas(32) constexpr uint8_t lane_index[32] = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31 };
+
+/// True if a block of W bytes at p would cross into the next page
+template <size_t W>
+SYS_KERNEL bool near_page_end(const char* p) noexcept
+{
+    return (reinterpret_cast<uintptr_t>(p) & (page_size - 1)) > page_size - W;
+}
+
+template <size_t W>
+SYS_KERNEL SYS_OVERREAD size_t length_blocks(const char* s) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    // Start with the aligned block holding s, ignoring lanes before it
+    const auto off = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(s) & (W - 1));
+    const char* p = s - off;
+
+    u8v v, lanes;
+    load(v, p);
+    load(lanes, lane_index);
+    u8v m = reinterpret_cast<u8v>(v == 0) & reinterpret_cast<u8v>(lanes >= off);
+    while (!any_set(m)) {
+        p += W;
+        load(v, p);
+        m = reinterpret_cast<u8v>(v == 0);
+    }
+
+    return static_cast<size_t>(p - s) + first_set(m);
+}
+
+template <size_t W>
+SYS_KERNEL SYS_OVERREAD size_t mismatch_blocks(const char* s1, const char* s2, size_t count) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    size_t i = 0;
+    while (i < count) {
+        if (near_page_end<W>(s1 + i) || near_page_end<W>(s2 + i)) {
+            const size_t stop = (count - i < W) ? count : i + W;
+            for (; i < stop; ++i) {
+                if ((s1[i] != s2[i]) || (s1[i] == 0))
+                    return i;
+            }
+            continue;
+        }
+
+        // The block may run past count (but not past the page)
+        u8v v1, v2;
+        load(v1, s1 + i);
+        load(v2, s2 + i);
+        const u8v m = reinterpret_cast<u8v>(v1 != v2) | reinterpret_cast<u8v>(v1 == 0);
+        if (any_set(m)) {
+            const size_t at = i + first_set(m);
+            return (at < count) ? at : count;
+        }
+        i += W;
+    }
+
+    return count;
+}
+
+template <size_t W>
+SYS_KERNEL size_t find_blocks(const char* p, size_t len, char ch) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const u8v c = u8v{} + static_cast<uint8_t>(ch);
+    size_t i = 0;
+    for (; len - i >= W; i += W) {
+        u8v v;
+        load(v, p + i);
+        const u8v m = reinterpret_cast<u8v>(v == c);
+        if (any_set(m))
+            return i + first_set(m);
+    }
+
+    if (i == len)
+        return len;
+
+    // Finish with the last full block, overlapping what's been searched
+    if (len >= W) {
+        u8v v;
+        load(v, p + len - W);
+        const u8v m = reinterpret_cast<u8v>(v == c);
+        return any_set(m) ? len - W + first_set(m) : len;
+    }
+
+    for (; i < len; ++i) {
+        if (p[i] == ch)
+            return i;
+    }
+    return len;
+}
+
+template <size_t W>
+SYS_KERNEL size_t rfind_blocks(const char* p, size_t len, char ch) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const u8v c = u8v{} + static_cast<uint8_t>(ch);
+    size_t i = len;
+    for (; i >= W; i -= W) {
+        u8v v;
+        load(v, p + i - W);
+        const u8v m = reinterpret_cast<u8v>(v == c);
+        if (any_set(m))
+            return i - W + last_set(m);
+    }
+
+    if (i == 0)
+        return len;
+
+    // Finish with the first full block, overlapping what's been searched
+    if (len >= W) {
+        u8v v;
+        load(v, p);
+        const u8v m = reinterpret_cast<u8v>(v == c);
+        return any_set(m) ? last_set(m) : len;
+    }
+
+    while (i--) {
+        if (p[i] == ch)
+            return i;
+    }
+    return len;
+}
+
+/// Index of the first difference between a[0, len) and b[0, len), or len
+template <size_t W>
+SYS_KERNEL size_t mismatch_n_blocks(const char* a, const char* b, size_t len) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    size_t i = 0;
+    for (; len - i >= W; i += W) {
+        u8v v1, v2;
+        load(v1, a + i);
+        load(v2, b + i);
+        const u8v m = reinterpret_cast<u8v>(v1 != v2);
+        if (any_set(m))
+            return i + first_set(m);
+    }
+
+    for (; (i < len) && (a[i] == b[i]); ++i);
+    return i;
+}
+
+/**
+ * @brief Substring search budget
+ *
+ * Chars compared checking candidates are charged against the positions
+ * covered; past this, we give up and leave the rest to Two-Way.
+ */
+constexpr bool search_over_budget(size_t compared, size_t covered) noexcept
+{
+    return compared > 2 * covered + 1024;
+}
+
+template <size_t W>
+SYS_KERNEL size_t find_str_blocks(const char* h, size_t n, const char* nd, size_t m, size_t& at) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    // Candidate positions are [at, end); a candidate has the needle's
+    // first and last chars in place, then gets a full check on the rest
+    const size_t start = at, end = n - m + 1;
+    const char* mid = nd + 1;
+    const size_t mid_len = m - 2;
+    size_t compared = 0;
+
+    const u8v first = u8v{} + static_cast<uint8_t>(nd[0]);
+    const u8v last  = u8v{} + static_cast<uint8_t>(nd[m - 1]);
+    size_t i = start;
+    for (; end - i >= W; i += W) {
+        u8v v1, v2;
+        load(v1, h + i);
+        load(v2, h + i + m - 1);
+        u8v c = reinterpret_cast<u8v>(v1 == first) & reinterpret_cast<u8v>(v2 == last);
+        while (any_set(c)) {
+            const size_t k = first_set(c);
+            const size_t pos = i + k;
+            const size_t d = mismatch_n_blocks<W>(h + pos + 1, mid, mid_len);
+            if (d == mid_len)
+                return pos;
+            compared += d + 1;
+            if (search_over_budget(compared, pos - start)) {
+                at = pos + 1;
+                return n;
+            }
+            c[k] = 0;
+        }
+    }
+
+    for (; i < end; ++i) {
+        if ((h[i] != nd[0]) || (h[i + m - 1] != nd[m - 1]))
+            continue;
+        const size_t d = mismatch_n_blocks<W>(h + i + 1, mid, mid_len);
+        if (d == mid_len)
+            return i;
+        compared += d + 1;
+        if (search_over_budget(compared, i - start)) {
+            at = i + 1;
+            return n;
+        }
+    }
+
+    at = end;
+    return n;
+}
+
+template <size_t W>
+SYS_KERNEL size_t rfind_str_blocks(const char* h, size_t n, const char* nd, size_t m, size_t& len) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    // Candidate positions are [0, i), taken from the top down. Having
+    // ruled out pos and above, a match has to be in h[0, pos + m - 1).
+    const size_t start = len - m + 1;
+    const char* mid = nd + 1;
+    const size_t mid_len = m - 2;
+    size_t compared = 0;
+
+    const u8v first = u8v{} + static_cast<uint8_t>(nd[0]);
+    const u8v last  = u8v{} + static_cast<uint8_t>(nd[m - 1]);
+    size_t i = start;
+    for (; i >= W; i -= W) {
+        u8v v1, v2;
+        load(v1, h + i - W);
+        load(v2, h + i - W + m - 1);
+        u8v c = reinterpret_cast<u8v>(v1 == first) & reinterpret_cast<u8v>(v2 == last);
+        while (any_set(c)) {
+            const size_t k = last_set(c);
+            const size_t pos = i - W + k;
+            const size_t d = mismatch_n_blocks<W>(h + pos + 1, mid, mid_len);
+            if (d == mid_len)
+                return pos;
+            compared += d + 1;
+            if (search_over_budget(compared, start - pos)) {
+                len = pos + m - 1;
+                return n;
+            }
+            c[k] = 0;
+        }
+    }
+
+    while (i--) {
+        if ((h[i] != nd[0]) || (h[i + m - 1] != nd[m - 1]))
+            continue;
+        const size_t d = mismatch_n_blocks<W>(h + i + 1, mid, mid_len);
+        if (d == mid_len)
+            return i;
+        compared += d + 1;
+        if (search_over_budget(compared, start - i)) {
+            len = i + m - 1;
+            return n;
+        }
+    }
+
+    len = m - 1;
+    return n;
+}
+
+/// Maps one block of ASCII letters to lower (or upper) case, in place
+template <class V>
+SYS_KERNEL void case_map_block(V& v, bool upper) noexcept
+{
+    // Letters of the other case are the 26 values from first
+    const uint8_t first = upper ? 'a' : 'A', letters = 26, flip = 32;
+    const V from = v - first;
+    v ^= reinterpret_cast<V>(from < letters) & flip;
+}
+
+template <size_t W>
+SYS_KERNEL void case_map_blocks(char* p, size_t count, bool upper) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    if (count < W) {
+        const auto& map = upper ? char_classes.upper : char_classes.lower;
+        for (size_t i = 0; i < count; ++i)
+            p[i] = static_cast<char>(map[static_cast<uint8_t>(p[i])]);
+        return;
+    }
+
+    u8v v;
+    for (size_t i = 0; count - i >= W; i += W) {
+        load(v, p + i);
+        case_map_block(v, upper);
+        store(p + i, v);
+    }
+
+    // Finish with the last full block; mapping a char twice is harmless
+    load(v, p + count - W);
+    case_map_block(v, upper);
+    store(p + count - W, v);
+}
+
+/// A set of kernels built for one target
+struct str_kernels
+{
+    size_t (*length)(const char*) noexcept;
+    size_t (*mismatch)(const char*, const char*, size_t) noexcept;
+    size_t (*find)(const char*, size_t, char) noexcept;
+    size_t (*rfind)(const char*, size_t, char) noexcept;
+    size_t (*find_str)(const char*, size_t, const char*, size_t, size_t&) noexcept;
+    size_t (*rfind_str)(const char*, size_t, const char*, size_t, size_t&) noexcept;
+    void   (*case_map)(char*, size_t, bool) noexcept;
+};
+
+#define SYS_KERNEL_SET(name, attr, width)                                                   \
+    attr SYS_OVERREAD size_t name##_length(const char* s) noexcept                          \
+        { return length_blocks<width>(s); }                                                 \
+    attr SYS_OVERREAD size_t name##_mismatch(const char* s1, const char* s2, size_t n)      \
+        noexcept                                                                            \
+        { return mismatch_blocks<width>(s1, s2, n); }                                       \
+    attr size_t name##_find(const char* p, size_t n, char ch) noexcept                      \
+        { return find_blocks<width>(p, n, ch); }                                            \
+    attr size_t name##_rfind(const char* p, size_t n, char ch) noexcept                     \
+        { return rfind_blocks<width>(p, n, ch); }                                           \
+    attr size_t name##_find_str(const char* h, size_t n, const char* nd, size_t m,          \
+        size_t& at) noexcept                                                                \
+        { return find_str_blocks<width>(h, n, nd, m, at); }                                 \
+    attr size_t name##_rfind_str(const char* h, size_t n, const char* nd, size_t m,         \
+        size_t& len) noexcept                                                               \
+        { return rfind_str_blocks<width>(h, n, nd, m, len); }                               \
+    attr void name##_case_map(char* p, size_t n, bool upper) noexcept                       \
+        { case_map_blocks<width>(p, n, upper); }                                            \
+    constexpr str_kernels name##_kernels{                                                   \
+        name##_length, name##_mismatch, name##_find, name##_rfind,                          \
+        name##_find_str, name##_rfind_str, name##_case_map };
+
+#ifdef SYS_KERNEL_X86
+SYS_KERNEL_SET(avx2, __attribute__((target("avx2"))), 32)
+#endif
+SYS_KERNEL_SET(base, , 16)
+
+#undef SYS_KERNEL_SET
+#undef SYS_OVERREAD
+
+const str_kernels& select_kernels() noexcept
+{
+    switch (detect_kernel_isa()) {
+#ifdef SYS_KERNEL_X86
+        case kernel_isa::avx2:  return avx2_kernels;
+#endif
+        default:                return base_kernels;
+    }
+}
+
+const str_kernels& kernels() noexcept
+{
+    static const str_kernels& selected = select_kernels();
+    return selected;
+}
+
+}   // end anonymous namespace
+
+size_t str_length_kernel(const char* s) noexcept
+{
+    return kernels().length(s);
+}
+
+size_t str_mismatch_kernel(const char* s1, const char* s2, size_t count) noexcept
+{
+    return kernels().mismatch(s1, s2, count);
+}
+
+size_t find_char_kernel(const char* p, size_t len, char ch) noexcept
+{
+    return kernels().find(p, len, ch);
+}
+
+size_t rfind_char_kernel(const char* p, size_t len, char ch) noexcept
+{
+    return kernels().rfind(p, len, ch);
+}
+
+size_t find_str_kernel(const char* h, size_t n, const char* nd, size_t m, size_t& at) noexcept
+{
+    return kernels().find_str(h, n, nd, m, at);
+}
+
+size_t rfind_str_kernel(const char* h, size_t n, const char* nd, size_t m, size_t& len) noexcept
+{
+    return kernels().rfind_str(h, n, nd, m, len);
+}
+
+void case_map_kernel(char* p, size_t count, bool upper) noexcept
+{
+    kernels().case_map(p, count, upper);
+}
+
+} // end namespace imp
+_SYS_END_NS
@@ -0,0 +1,312 @@
+/**
+ * @file    charconv_bytes.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Bulk hex and base64 encoding and decoding, and char counting, kernels
+ *
+ * The kernels are written once, with the compiler's generic vector types,
+ * for a block width of W bytes. They're then built for AVX2 with W = 32
+ * and for SSSE3 (which the base64 byte shuffles want) with W = 16; the
+ * baseline SSE2 build only has the hex kernels. The best set the CPU
+ * supports is picked the first time one is used.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <imp/charconv_bytes.h>
+#include <imp/vec_kernel.h>
+
+_SYS_BEGIN_NS
+namespace imp {
+
+namespace {
+
+// Shuffle masks, as tables for the widest block; narrower blocks use a
+// prefix. Entries of the interleave with the top bit set select from the
+// second vector.
+alignas(32) constexpr uint8_t interleave_mask[32] = {
+    0x00, 0x80, 0x01, 0x81, 0x02, 0x82, 0x03, 0x83, 0x04, 0x84, 0x05, 0x85, 0x06, 0x86, 0x07, 0x87,
+    0x08, 0x88, 0x09, 0x89, 0x0A, 0x8A, 0x0B, 0x8B, 0x0C, 0x8C, 0x0D, 0x8D, 0x0E, 0x8E, 0x0F, 0x8F };
+alignas(32) constexpr uint8_t base64_gather_mask[32] = {
+     2,  1,  0,  0,  5,  4,  3,  3,  8,  7,  6,  6, 11, 10,  9,  9,
+    14, 13, 12, 12, 17, 16, 15, 15, 20, 19, 18, 18, 23, 22, 21, 21 };
+alignas(32) constexpr uint8_t base64_scatter_mask[32] = {
+     2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, 18, 17, 16, 22,
+    21, 20, 26, 25, 24, 30, 29, 28,  0,  0,  0,  0,  0,  0,  0,  0 };
+
+/// Map nibbles to hex digits, in place
+template <class V>
+SYS_KERNEL void hex_digits(V& n, uint8_t alpha_adj) noexcept
+{
+    n += uint8_t{'0'} + (reinterpret_cast<V>(n > 9) & alpha_adj);
+}
+
+/// Map 6-bit values to chars of a base64 alphabet, in place
+template <class V>
+SYS_KERNEL void base64_chars(V& n, bool url) noexcept
+{
+    // Offsets from value to char for each run of the alphabet: A-Z, a-z,
+    // 0-9, then the two symbols. Offsets are mod 256.
+    V off = V{} + uint8_t{'A'};
+    off += reinterpret_cast<V>(n >= 26) & uint8_t{'a' - 26 - 'A'};
+    off += reinterpret_cast<V>(n >= 52) & static_cast<uint8_t>('0' - 52 - ('a' - 26));
+    if (url) {
+        off += reinterpret_cast<V>(n >= 62) & static_cast<uint8_t>('-' - 62 - ('0' - 52));
+        off += reinterpret_cast<V>(n == 63) & static_cast<uint8_t>('_' - 63 - ('-' - 62));
+    }
+    else {
+        off += reinterpret_cast<V>(n >= 62) & static_cast<uint8_t>('+' - 62 - ('0' - 52));
+        off += reinterpret_cast<V>(n == 63) & static_cast<uint8_t>('/' - 63 - ('+' - 62));
+    }
+    n += off;
+}
+
+/// Map base64 chars to 6-bit values; valid gets the lanes that were members
+template <class V>
+SYS_KERNEL void base64_values(const V& c, bool url, V& n, V& valid) noexcept
+{
+    const uint8_t ch62 = url ? '-' : '+';
+    const uint8_t ch63 = url ? '_' : '/';
+    const V upper = reinterpret_cast<V>(c - uint8_t{'A'} < 26);
+    const V lower = reinterpret_cast<V>(c - uint8_t{'a'} < 26);
+    const V digit = reinterpret_cast<V>(c - uint8_t{'0'} < 10);
+    const V sym62 = reinterpret_cast<V>(c == ch62);
+    const V sym63 = reinterpret_cast<V>(c == ch63);
+    valid = upper | lower | digit | sym62 | sym63;
+
+    n = ((c - uint8_t{'A'}) & upper)
+      | ((c - uint8_t{'a' - 26}) & lower)
+      | ((c + uint8_t{52 - '0'}) & digit)
+      | (sym62 & 62)
+      | (sym63 & 63);
+}
+
+template <size_t W>
+SYS_KERNEL size_t hex_encode_blocks(char* dst, const uint8_t* src, size_t count, bool upper) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    u8v lo_half;
+    load(lo_half, interleave_mask);
+    lo_half = (lo_half & 0x7F) + ((lo_half >> 7) * uint8_t{W});
+    const u8v hi_half = lo_half + uint8_t{W / 2};
+    const uint8_t alpha_adj = upper ? 'A' - '0' - 10 : 'a' - '0' - 10;
+
+    size_t done = 0;
+    for (; count - done >= W; done += W) {
+        u8v hi, lo;
+        load(hi, src + done);
+        lo = hi & 0xF;
+        hi >>= 4;
+        hex_digits(hi, alpha_adj);
+        hex_digits(lo, alpha_adj);
+        store(dst + done * 2,     __builtin_shuffle(hi, lo, lo_half));
+        store(dst + done * 2 + W, __builtin_shuffle(hi, lo, hi_half));
+    }
+
+    return done;
+}
+
+template <size_t W>
+SYS_KERNEL size_t hex_decode_blocks(uint8_t* dst, const char* src, size_t len) noexcept
+{
+    using u8v  = vec<uint8_t, W>;
+    using u8h  = vec<uint8_t, W / 2>;
+    using u16v = vec<uint16_t, W>;
+
+    size_t done = 0;
+    for (; len - done >= W; done += W) {
+        u8v c;
+        load(c, src + done);
+        const u8v d = c - uint8_t{'0'};
+        const u8v a = (c | 0x20) - uint8_t{'a'};
+        const u8v is_d = reinterpret_cast<u8v>(d < 10);
+        const u8v is_a = reinterpret_cast<u8v>(a < 6);
+        if (!all_set(is_d | is_a))
+            break;
+
+        // Lane pairs are (high, low) nibbles; as 16-bit words that's low << 8 | high
+        const u8v n = (d & is_d) | ((a + 10) & is_a);
+        const u16v w = reinterpret_cast<u16v>(n);
+        const u16v b = ((w << 4) | (w >> 8)) & 0xFF;
+        store(dst + done / 2, __builtin_convertvector(b, u8h));
+    }
+
+    return done;
+}
+
+template <size_t W>
+SYS_KERNEL size_t base64_encode_blocks(char* dst, const uint8_t* src, size_t count, bool url) noexcept
+{
+    using u8v  = vec<uint8_t, W>;
+    using u32v = vec<uint32_t, W>;
+
+    // Each 32-bit lane gets one 3-byte group, big-end first, as b2 b1 b0 in
+    // little-endian order so the lane's value is the 24-bit group.
+    u8v gather;
+    load(gather, base64_gather_mask);
+
+    size_t done = 0;
+    for (; count - done >= W; done += W / 4 * 3) {
+        u8v v;
+        load(v, src + done);
+        const u32v w = reinterpret_cast<u32v>(__builtin_shuffle(v, gather));
+        const u32v idx = ((w >> 18) & 63)
+                       | (((w >> 12) & 63) << 8)
+                       | (((w >>  6) & 63) << 16)
+                       | ((w & 63) << 24);
+        u8v chars = reinterpret_cast<u8v>(idx);
+        base64_chars(chars, url);
+        store(dst + done / 3 * 4, chars);
+    }
+
+    return done;
+}
+
+template <size_t W>
+SYS_KERNEL size_t base64_decode_blocks(uint8_t* dst, const char* src, size_t len, bool url) noexcept
+{
+    using u8v  = vec<uint8_t, W>;
+    using u32v = vec<uint32_t, W>;
+
+    // Pulls the three bytes out of each 32-bit lane
+    u8v scatter;
+    load(scatter, base64_scatter_mask);
+
+    size_t done = 0;
+    for (; len - done >= W; done += W) {
+        u8v c, n, valid;
+        load(c, src + done);
+        base64_values(c, url, n, valid);
+        if (!all_set(valid))
+            break;
+
+        const u32v w = reinterpret_cast<u32v>(n);
+        const u32v g = ((w & 0xFF) << 18)
+                     | (((w >>  8) & 0xFF) << 12)
+                     | (((w >> 16) & 0xFF) << 6)
+                     | (w >> 24);
+        const u8v b = __builtin_shuffle(reinterpret_cast<u8v>(g), scatter);
+        __builtin_memcpy(dst + done / 4 * 3, &b, W / 4 * 3);
+    }
+
+    return done;
+}
+
+template <size_t W>
+SYS_KERNEL size_t count_either_blocks(const char* src, size_t len, char a, char b,
+    size_t& count) noexcept
+{
+    using u8v = vec<uint8_t, W>;
+
+    const u8v va = u8v{} + static_cast<uint8_t>(a);
+    const u8v vb = u8v{} + static_cast<uint8_t>(b);
+
+    // Matches are tallied per lane, and the lanes summed before they can
+    // wrap
+    size_t done = 0;
+    while (len - done >= W) {
+        const size_t blocks = ((len - done) / W < 255) ? (len - done) / W : 255;
+        u8v tally{};
+        for (size_t i = 0; i < blocks; ++i, done += W) {
+            u8v c;
+            load(c, src + done);
+            tally -= reinterpret_cast<u8v>((c == va) | (c == vb));
+        }
+        for (size_t i = 0; i < W; ++i)
+            count += tally[i];
+    }
+
+    return done;
+}
+
+/// A set of kernels built for one target
+struct bytes_kernels
+{
+    size_t (*hex_encode)(char*, const uint8_t*, size_t, bool) noexcept;
+    size_t (*hex_decode)(uint8_t*, const char*, size_t) noexcept;
+    size_t (*base64_encode)(char*, const uint8_t*, size_t, bool) noexcept;
+    size_t (*base64_decode)(uint8_t*, const char*, size_t, bool) noexcept;
+    size_t (*count_either)(const char*, size_t, char, char, size_t&) noexcept;
+};
+
+#define SYS_KERNEL_SET(name, attr, width)                                                   \
+    attr size_t name##_hex_encode(char* d, const uint8_t* s, size_t n, bool u) noexcept     \
+        { return hex_encode_blocks<width>(d, s, n, u); }                                    \
+    attr size_t name##_hex_decode(uint8_t* d, const char* s, size_t n) noexcept             \
+        { return hex_decode_blocks<width>(d, s, n); }                                       \
+    attr size_t name##_base64_encode(char* d, const uint8_t* s, size_t n, bool u) noexcept  \
+        { return base64_encode_blocks<width>(d, s, n, u); }                                 \
+    attr size_t name##_base64_decode(uint8_t* d, const char* s, size_t n, bool u) noexcept  \
+        { return base64_decode_blocks<width>(d, s, n, u); }                                 \
+    attr size_t name##_count_either(const char* s, size_t n, char a, char b, size_t& c) noexcept \
+        { return count_either_blocks<width>(s, n, a, b, c); }                               \
+    constexpr bytes_kernels name##_kernels{                                                 \
+        name##_hex_encode, name##_hex_decode, name##_base64_encode, name##_base64_decode,   \
+        name##_count_either };
+
+#ifdef SYS_KERNEL_X86
+SYS_KERNEL_SET(avx2,  __attribute__((target("avx2"))),  32)
+SYS_KERNEL_SET(ssse3, __attribute__((target("ssse3"))), 16)
+#endif
+
+// Without a byte shuffle instruction, base64 is quicker done by the
+// table-driven scalar loops, so the baseline set leaves it to them.
+size_t base_hex_encode(char* d, const uint8_t* s, size_t n, bool u) noexcept
+    { return hex_encode_blocks<16>(d, s, n, u); }
+size_t base_hex_decode(uint8_t* d, const char* s, size_t n) noexcept
+    { return hex_decode_blocks<16>(d, s, n); }
+size_t base_no_blocks(char*, const uint8_t*, size_t, bool) noexcept { return 0; }
+size_t base_no_blocks(uint8_t*, const char*, size_t, bool) noexcept { return 0; }
+size_t base_count_either(const char* s, size_t n, char a, char b, size_t& c) noexcept
+    { return count_either_blocks<16>(s, n, a, b, c); }
+constexpr bytes_kernels base_kernels{
+    base_hex_encode, base_hex_decode, base_no_blocks, base_no_blocks, base_count_either };
+
+#undef SYS_KERNEL_SET
+
+const bytes_kernels& select_kernels() noexcept
+{
+    switch (detect_kernel_isa()) {
+#ifdef SYS_KERNEL_X86
+        case kernel_isa::avx2:  return avx2_kernels;
+        case kernel_isa::ssse3: return ssse3_kernels;
+#endif
+        default:                return base_kernels;
+    }
+}
+
+const bytes_kernels& kernels() noexcept
+{
+    static const bytes_kernels& selected = select_kernels();
+    return selected;
+}
+
+}   // end anonymous namespace
+
+size_t hex_encode_kernel(char* dst, const uint8_t* src, size_t count, bool upper) noexcept
+{
+    return kernels().hex_encode(dst, src, count, upper);
+}
+
+size_t hex_decode_kernel(uint8_t* dst, const char* src, size_t len) noexcept
+{
+    return kernels().hex_decode(dst, src, len);
+}
+
+size_t base64_encode_kernel(char* dst, const uint8_t* src, size_t count, bool url) noexcept
+{
+    return kernels().base64_encode(dst, src, count, url);
+}
+
+size_t base64_decode_kernel(uint8_t* dst, const char* src, size_t len, bool url) noexcept
+{
+    return kernels().base64_decode(dst, src, len, url);
+}
+
+size_t count_either_kernel(const char* src, size_t len, char a, char b, size_t& count) noexcept
+{
+    return kernels().count_either(src, len, a, b, count);
+}
+
+} // end namespace imp
+_SYS_END_NS
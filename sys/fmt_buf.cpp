@@ -0,0 +1,21 @@
+/**
+ * @file    fmt_buf.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Per-thread scratch storage for formatting
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <imp/fmt_buf.h>
+
+_SYS_BEGIN_NS
+namespace imp {
+
+fmt_scratch& fmt_thread_scratch() noexcept
+{
+    static thread_local fmt_scratch scratch;
+    return scratch;
+}
+
+} // end namespace imp
+_SYS_END_NS
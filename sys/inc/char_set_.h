@@ -0,0 +1,227 @@
+/**
+ * @file    char_set_.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   sys::char_set: a set of chars as a 256-bit bitmap
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef sys_char_set__included
+#define sys_char_set__included
+
+#include <_core_.h>
+#include <types_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+// Run-time kernels for char_set (char_set.cpp). Both take a char_set's
+// bitmap and look for a char that is (match) or isn't (!match) a member.
+
+/// Returns the index of the first such char in p[0, len), or len
+size_t find_in_set_kernel(const char* p, size_t len, const uint8_t* bits, bool match) noexcept;
+/// Returns the index of the last such char in p[0, len), or len
+size_t rfind_in_set_kernel(const char* p, size_t len, const uint8_t* bits, bool match) noexcept;
+/// Returns the number of chars in p[0, len) that are members
+size_t count_in_set_kernel(const char* p, size_t len, const uint8_t* bits) noexcept;
+
+}   // end namespace imp
+
+/**
+ * @brief A set of chars
+ *
+ * Membership is a single bit test, so a set is built once and then used to
+ * classify any number of chars; the *_of searches in string_view and
+ * string use one. Sets from literals can be constexpr:
+ *
+ *      constexpr char_set delims(",;:");
+ *
+ * The bitmap is laid out for a nibble lookup: char c is bit (c >> 4) & 7
+ * of byte (c & 15) + 16 * (c >> 7). Each 16-byte half is then a table,
+ * indexed by the low nibble, of which high nibbles are members. That lets
+ * the run-time searches test a vector of chars with a couple of byte
+ * shuffles.
+ */
+class char_set
+{
+public:
+
+    /// Number of bytes in the bitmap
+    static constexpr size_t bitmap_size = 32;
+
+    /// Searches shorter than this don't bother with the kernels
+    static constexpr size_t kernel_min_len = 32;
+
+    /// Constructs an empty set
+    constexpr char_set() noexcept = default;
+
+    /// Constructs a set of the chars in s[0, count)
+    constexpr char_set(const char* s, size_t count) noexcept
+        { insert(s, count); }
+
+    /// Constructs a set of the chars in null-terminated string s
+    constexpr char_set(const char* s) noexcept
+    {
+        for (; *s; ++s)
+            insert(*s);
+    }
+
+    /// The standard whitespace chars: space, \t, \n, \v, \f, \r
+    static constexpr char_set whitespace() noexcept
+        { return char_set(" \t\n\v\f\r"); }
+
+    // -- Modifiers
+
+    /// Adds c to the set
+    constexpr char_set& insert(char c) noexcept
+    {
+        _bits[index_of(c)] |= mask_of(c);
+        return *this;
+    }
+
+    /// Adds the chars in s[0, count) to the set
+    constexpr char_set& insert(const char* s, size_t count) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+            insert(s[i]);
+        return *this;
+    }
+
+    /// Removes c from the set
+    constexpr char_set& erase(char c) noexcept
+    {
+        _bits[index_of(c)] &= static_cast<uint8_t>(~mask_of(c));
+        return *this;
+    }
+
+    /// Removes all chars from the set
+    constexpr void clear() noexcept
+    {
+        for (auto& b : _bits)
+            b = 0;
+    }
+
+    // -- Queries
+
+    /// Returns true if c is in the set
+    constexpr bool contains(char c) const noexcept
+        { return _bits[index_of(c)] & mask_of(c); }
+
+    /// Returns true if the set has no chars
+    constexpr bool is_empty() const noexcept
+    {
+        for (auto b : _bits) {
+            if (b)
+                return false;
+        }
+        return true;
+    }
+
+    /// Returns the number of chars in the set
+    constexpr size_t count() const noexcept
+    {
+        size_t n = 0;
+        for (auto b : _bits)
+            n += static_cast<size_t>(__builtin_popcount(b));
+        return n;
+    }
+
+    /// Returns the bitmap, in the layout described above
+    constexpr const uint8_t* data() const noexcept
+        { return _bits; }
+
+    // -- Set operations
+
+    /// Returns the set of chars not in this set
+    constexpr char_set operator~() const noexcept
+    {
+        char_set s;
+        for (size_t i = 0; i < bitmap_size; ++i)
+            s._bits[i] = static_cast<uint8_t>(~_bits[i]);
+        return s;
+    }
+
+    constexpr char_set& operator|=(const char_set& rhs) noexcept
+    {
+        for (size_t i = 0; i < bitmap_size; ++i)
+            _bits[i] |= rhs._bits[i];
+        return *this;
+    }
+
+    constexpr char_set& operator&=(const char_set& rhs) noexcept
+    {
+        for (size_t i = 0; i < bitmap_size; ++i)
+            _bits[i] &= rhs._bits[i];
+        return *this;
+    }
+
+    friend constexpr char_set operator|(char_set lhs, const char_set& rhs) noexcept
+        { return lhs |= rhs; }
+    friend constexpr char_set operator&(char_set lhs, const char_set& rhs) noexcept
+        { return lhs &= rhs; }
+
+    friend constexpr bool operator==(const char_set& lhs, const char_set& rhs) noexcept
+    {
+        for (size_t i = 0; i < bitmap_size; ++i) {
+            if (lhs._bits[i] != rhs._bits[i])
+                return false;
+        }
+        return true;
+    }
+
+    // -- Searches
+
+    /// Returns the index of the first char in p[0, len) that is (match) or isn't in the set, or len
+    constexpr size_t find_first(const char* p, size_t len, bool match = true) const noexcept
+    {
+        if (!is_constant_evaluated() && (len >= kernel_min_len))
+            return imp::find_in_set_kernel(p, len, _bits, match);
+
+        size_t i = 0;
+        for (; (i < len) && (contains(p[i]) != match); ++i);
+        return i;
+    }
+
+    /// Returns the index of the last char in p[0, len) that is (match) or isn't in the set, or len
+    constexpr size_t find_last(const char* p, size_t len, bool match = true) const noexcept
+    {
+        if (!is_constant_evaluated() && (len >= kernel_min_len))
+            return imp::rfind_in_set_kernel(p, len, _bits, match);
+
+        for (size_t i = len; i--; ) {
+            if (contains(p[i]) == match)
+                return i;
+        }
+        return len;
+    }
+
+    /// Returns the number of chars in p[0, len) that are in the set
+    constexpr size_t count_in(const char* p, size_t len) const noexcept
+    {
+        if (!is_constant_evaluated() && (len >= kernel_min_len))
+            return imp::count_in_set_kernel(p, len, _bits);
+
+        size_t n = 0;
+        for (size_t i = 0; i < len; ++i)
+            n += contains(p[i]);
+        return n;
+    }
+
+private:
+
+    static constexpr size_t index_of(char c) noexcept
+    {
+        const auto uc = static_cast<uint8_t>(c);
+        return (uc & 15u) | ((uc >> 7) << 4);
+    }
+
+    static constexpr uint8_t mask_of(char c) noexcept
+        { return static_cast<uint8_t>(1u << ((static_cast<uint8_t>(c) >> 4) & 7)); }
+
+    uint8_t _bits[bitmap_size]{};
+};
+
+_SYS_END_NS
+
+#endif // ifndef sys_char_set__included
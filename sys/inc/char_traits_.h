@@ -11,9 +11,106 @@
 
 #include <_core_.h>
 #include <memory_.h>
+#include <char_set_.h>
 
 _SYS_BEGIN_NS
 
+namespace imp {
+
+// Run-time kernels for char_traits<char> (char_traits.cpp)
+
+/// Returns the length of the null-terminated string s
+size_t str_length_kernel(const char* s) noexcept;
+/// Returns the index of the first of the first count chars that differs between s1 and s2 or is null in both; else count
+size_t str_mismatch_kernel(const char* s1, const char* s2, size_t count) noexcept;
+/// Returns the index of the first ch in p[0, len), or len
+size_t find_char_kernel(const char* p, size_t len, char ch) noexcept;
+/// Returns the index of the last ch in p[0, len), or len
+size_t rfind_char_kernel(const char* p, size_t len, char ch) noexcept;
+
+/// Maps each char to lower or upper case, in place
+void case_map_kernel(char* p, size_t count, bool upper) noexcept;
+
+}   // end namespace imp
+
+/**
+ * @brief Char classes for char_traits::is_class and count_if_class
+ *
+ * These are bit flags; a char is in a combination of them if it's in any
+ * one. Classes are those of the "C" locale: only ASCII chars are members.
+ */
+enum class char_class : uint16_t {
+    none    = 0,
+    control = 1 << 0,   ///< 0-31 and 127
+    space   = 1 << 1,   ///< Space, \t, \n, \v, \f, \r
+    blank   = 1 << 2,   ///< Space, \t
+    upper   = 1 << 3,   ///< A-Z
+    lower   = 1 << 4,   ///< a-z
+    digit   = 1 << 5,   ///< 0-9
+    xdigit  = 1 << 6,   ///< 0-9, A-F, a-f
+    punct   = 1 << 7,   ///< Graphical chars that aren't alphanumeric
+    print   = 1 << 8,   ///< 32-126
+
+    alpha   = upper | lower,
+    alnum   = alpha | digit,
+    graph   = alnum | punct
+};
+
+constexpr char_class operator|(char_class a, char_class b) noexcept
+    { return char_class(static_cast<uint16_t>(static_cast<uint16_t>(a) | static_cast<uint16_t>(b))); }
+constexpr char_class operator&(char_class a, char_class b) noexcept
+    { return char_class(static_cast<uint16_t>(static_cast<uint16_t>(a) & static_cast<uint16_t>(b))); }
+
+namespace imp {
+
+/// Class flags and case mappings for each value of an unsigned char
+struct char_class_table
+{
+    constexpr char_class_table() noexcept
+    {
+        for (unsigned c = 0; c < 256; ++c) {
+            char_class f = char_class::none;
+            if ((c < 32) || (c == 127))
+                f = f | char_class::control;
+            if ((c == ' ') || ((c >= '\t') && (c <= '\r')))
+                f = f | char_class::space;
+            if ((c == ' ') || (c == '\t'))
+                f = f | char_class::blank;
+            if ((c >= 'A') && (c <= 'Z'))
+                f = f | char_class::upper;
+            if ((c >= 'a') && (c <= 'z'))
+                f = f | char_class::lower;
+            if ((c >= '0') && (c <= '9'))
+                f = f | char_class::digit | char_class::xdigit;
+            if (((c >= 'A') && (c <= 'F')) || ((c >= 'a') && (c <= 'f')))
+                f = f | char_class::xdigit;
+            if ((c > ' ') && (c < 127) && ((f & char_class::alnum) == char_class::none))
+                f = f | char_class::punct;
+            if ((c >= ' ') && (c < 127))
+                f = f | char_class::print;
+
+            flags[c] = static_cast<uint16_t>(f);
+            lower[c] = static_cast<uint8_t>(((c >= 'A') && (c <= 'Z')) ? c + 32 : c);
+            upper[c] = static_cast<uint8_t>(((c >= 'a') && (c <= 'z')) ? c - 32 : c);
+        }
+    }
+
+    uint16_t flags[256]{};
+    uint8_t  lower[256]{};
+    uint8_t  upper[256]{};
+};
+
+inline constexpr char_class_table char_classes{};
+
+}   // end namespace imp
+
+/**
+ * @brief Basic operations on chars and sequences of them
+ *
+ * For char, length, compare, find, find_last, and the bulk classification
+ * routines use vectorized kernels at run time; the loops here are used
+ * during constant evaluation.
+ */
 template <class T>
 struct char_traits {
 
@@ -25,6 +122,11 @@ struct char_traits {
     /// Returns the length of the character sequence pointed to by s
     static constexpr inline size_t length(const char_t* s)
     {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated())
+                return imp::str_length_kernel(s);
+        }
+
         size_t len = 0;
         while (*s++ != null_term) ++len;
         return len;
@@ -50,6 +152,13 @@ struct char_traits {
     /// Compares the first count characters of the character strings s1 and s2
     static constexpr inline int compare(const char_t* s1, const char_t* s2, size_t count)
     {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                const size_t i = imp::str_mismatch_kernel(s1, s2, count);
+                return ((i == count) || (s1[i] == s2[i])) ? 0 : (s1[i] < s2[i]) ? -1 : 1;
+            }
+        }
+
         while (count && (*s1 != null_term) && (*s2 != null_term) && (*s1 == *s2))
             s1++, s2++, count--;
         return (!count || (*s1 == *s2)) ? 0 : (*s1 < *s2) ? -1 : 1;
@@ -58,104 +167,157 @@ struct char_traits {
     /// Compares characters of the character strings s1 and s2 up to null terminator
     static constexpr inline int compare(const char_t* s1, const char_t* s2)
     {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                const size_t i = imp::str_mismatch_kernel(s1, s2, size_t(-1));
+                return (s1[i] == s2[i]) ? 0 : (s1[i] < s2[i]) ? -1 : 1;
+            }
+        }
+
         while ((*s1 != null_term) && (*s2 != null_term) && (*s1 == *s2))
             s1++, s2++;
         return (*s1 == *s2) ? 0 : (*s1 < *s2) ? -1 : 1;
     }
 
+    /// Returns a pointer to the first ch in the first count chars of p, or nullptr
+    static constexpr inline const char_t* find(const char_t* p, size_t count, char_t ch)
+    {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                const size_t i = imp::find_char_kernel(p, count, ch);
+                return (i < count) ? p + i : nullptr;
+            }
+        }
+
+        for (; count; --count, ++p) {
+            if (*p == ch)
+                return p;
+        }
+        return nullptr;
+    }
+
+    /// Returns a pointer to the last ch in the first count chars of p, or nullptr
+    static constexpr inline const char_t* find_last(const char_t* p, size_t count, char_t ch)
+    {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                const size_t i = imp::rfind_char_kernel(p, count, ch);
+                return (i < count) ? p + i : nullptr;
+            }
+        }
+
+        while (count--) {
+            if (p[count] == ch)
+                return p + count;
+        }
+        return nullptr;
+    }
+
+    // -- Classification
+    //
+    // Each of these is a lookup in imp::char_classes. Only the low 8 bits
+    // of a char are considered.
+
+    /// Returns true if c is in any of the classes in cls
+    static constexpr inline bool is_class(char_t c, char_class cls)
+    {
+        return imp::char_classes.flags[static_cast<unsigned char>(c)] & static_cast<uint16_t>(cls);
+    }
+
     /// Return lower case version of c
     static constexpr inline char_t to_lower(char_t c)
-        { return ((c >= 'A') && (c <= 'Z')) ? (c + 32) : c; }
+        { return static_cast<char_t>(imp::char_classes.lower[static_cast<unsigned char>(c)]); }
     /// Return upper case version of c
     static constexpr inline char_t to_upper(char_t c)
-        { return ((c >= 'a') && (c <= 'z')) ? (c - 32) : c; }
-
-    // TODO : This is a quick-and-dirty implementation. It will be faster to
-    // implement this stuff via LUT. Or, maybe move this stuff into an
-    // encoding (utf-8) traits?
+        { return static_cast<char_t>(imp::char_classes.upper[static_cast<unsigned char>(c)]); }
 
     /// Returns true if given char is a control character
     static constexpr inline bool is_control(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return (uc < 32) || (uc == 127);
-    }
+        { return is_class(c, char_class::control); }
     /// Returns true if given char is printable (not a control character)
     static constexpr inline bool is_printable(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return (uc >= 32) && (uc < 127);
-    }
+        { return is_class(c, char_class::print); }
     /// Returns true if given char is whitespace, tab, or space
     static constexpr inline bool is_space(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return (uc == 32) || ((uc >= 9) && (uc <= 13));
-    }
+        { return is_class(c, char_class::space); }
     /// Returns true if given char is tab or space
     static constexpr inline bool is_blank(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return (uc == 32) || (uc == 9);
-    }
+        { return is_class(c, char_class::blank); }
     /// Returns true if given char has graphical representation
     static constexpr inline bool is_graph(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return (uc >= 33) && (uc <= 126);
-    }
+        { return is_class(c, char_class::graph); }
     /// Returns true if given char is punctuation
     static constexpr inline bool is_punctuation(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return
-            ((uc >= 48) && (uc <=  57)) ||
-            ((uc >= 65) && (uc <=  90)) ||
-            ((uc >= 97) && (uc <= 122));
-    }
+        { return is_class(c, char_class::punct); }
     /// Returns true if given char is alphanumeric
     static constexpr inline bool is_alnum(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return
-            ((uc >= 'a') && (uc <= 'z')) ||
-            ((uc >= 'A') && (uc <= 'Z')) ||
-            ((uc >= '0') && (uc <= '9'));
-    }
+        { return is_class(c, char_class::alnum); }
     /// Returns true if given char is alphabetic
     static constexpr inline bool is_alpha(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return
-            ((uc >= 'a') && (uc <= 'z')) ||
-            ((uc >= 'A') && (uc <= 'Z'));
-    }
+        { return is_class(c, char_class::alpha); }
     /// Returns true if given char is upper case
     static constexpr inline bool is_upper(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return ((uc >= 'A') && (uc <= 'Z'));
-    }
+        { return is_class(c, char_class::upper); }
     /// Returns true if given char is lower case
     static constexpr inline bool is_lower(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return ((uc >= 'a') && (uc <= 'z'));
-    }
+        { return is_class(c, char_class::lower); }
     /// Returns true if given char is a decimal digit
     static constexpr inline bool is_digit_dec(char_t c)
-    {
-        auto uc = static_cast<unsigned char>(c);
-        return ((uc >= '0') && (uc <= '9'));
-    }
+        { return is_class(c, char_class::digit); }
     /// Returns true if given char is a hexadecimal digit
     static constexpr inline bool is_digit_hex(char_t c)
+        { return is_class(c, char_class::xdigit); }
+
+    // -- Bulk classification
+
+    /// Converts the first count chars of p to lower case
+    static constexpr inline void to_lower_inplace(char_t* p, size_t count)
     {
-        auto uc = static_cast<unsigned char>(c);
-        return
-            ((uc >= '0') && (uc <= '9')) ||
-            ((uc >= 'A') && (uc <= 'F')) ||
-            ((uc >= 'a') && (uc <= 'f'));
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                imp::case_map_kernel(p, count, false);
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            p[i] = to_lower(p[i]);
+    }
+
+    /// Converts the first count chars of p to upper case
+    static constexpr inline void to_upper_inplace(char_t* p, size_t count)
+    {
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated()) {
+                imp::case_map_kernel(p, count, true);
+                return;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            p[i] = to_upper(p[i]);
+    }
+
+    /// Returns the number of the first count chars of p in any of the classes in cls
+    static constexpr inline size_t count_if_class(const char_t* p, size_t count, char_class cls)
+    {
+        // For long runs, it's worth making a char_set of the class so the
+        // vectorized count can be used
+        if constexpr (is_same_v<char_t, char>) {
+            if (!is_constant_evaluated() && (count >= 256)) {
+                char_set set;
+                for (unsigned c = 0; c < 256; ++c) {
+                    if (is_class(static_cast<char>(c), cls))
+                        set.insert(static_cast<char>(c));
+                }
+                return set.count_in(p, count);
+            }
+        }
+
+        size_t n = 0;
+        for (size_t i = 0; i < count; ++i)
+            n += is_class(p[i], cls);
+        return n;
     }
 };
 
@@ -13,6 +13,11 @@
 #include <concepts_.h>
 #include <limits_.h>
 #include <error_.h>
+#include <vector_.h>
+#include "imp/charconv_int.h"
+#include "imp/charconv_fp.h"
+#include "imp/charconv_fp_parse.h"
+#include "imp/charconv_bytes.h"
 
 _SYS_BEGIN_NS
 
@@ -64,28 +69,67 @@ constexpr from_chars_result from_chars(T& value, string_view s, unsigned radix =
         else
             fact = value_type{-1};
     }
-    if (sign)
-        s.remove_prefix(1);
+    if (sign && s.remove_prefix(1).is_empty())
+        return result(0, error_code::bad_parameter);
+
+    // Checks for a 0x or 0b style prefix (either case)
+    auto has_prefix = [&s](char marker) {
+        return (s.length() > 1) && (s[0] == '0') && (ch_traits::to_lower(s[1]) == marker);
+    };
 
-    // Handle auto-radix: 0xn=hex, 0n=oct, 0b=binary, else dec
+    // Handle auto-radix: 0xn=hex, 0bn=binary, 0n=oct, else dec
     if (radix == 0) {
-        if      ((s.length() > 2) && (s[0] == '0') && (ch_traits::to_lower(s[1] == 'x')))
+        if      (has_prefix('x') && (s.length() > 2))
             radix = 16; // Hexadecimal
+        else if (has_prefix('b') && (s.length() > 2))
+            radix =  2; // Binary
         else if ((s.length() > 1) && (s[0] == '0')) // checking for 0n[...]
             radix =  8; // Octal
-        else if ((s.length() > 2) && (s[0] == '0') && (ch_traits::to_lower(s[1] == 'b')))
-            radix =  2; // Binary
         else
             radix = 10; // Decimal
     }
 
     // Eat optional hex/oct/binary prefixes
-    if ((radix == 16) && (s.starts_with("0x") || s.starts_with("0X")))
+    if (((radix == 16) && has_prefix('x')) || ((radix == 2) && has_prefix('b')))
         s.remove_prefix(2);
-    else if ((radix == 8) && s.starts_with("0") && (s.length() > 1))
+    else if ((radix == 8) && (s.length() > 1) && (s[0] == '0'))
         s.remove_prefix(1);
-    else if ((radix == 2) && (s.starts_with("0b") || s.starts_with("0B")))
-        s.remove_prefix(2);
+
+    // Fast paths. At run time, decimal and hex go eight chars at a time.
+    // During constant evaluation 128-bit decimal still goes through 64-bit
+    // chunks rather than a full-width multiply for every digit.
+    constexpr bool is_wide = sizeof(T) > sizeof(uint64_t);
+    // Note: use_swar must not be const; a const initializer would be
+    // manifestly constant-evaluated and is_constant_evaluated() would fold.
+    bool use_swar = false;
+    if (!is_constant_evaluated())
+        use_swar = imp::swar_enabled && ((radix == 10) || (radix == 16));
+    if (use_swar || (is_wide && (radix == 10))) {
+        using uint_type = imp::uint_of_size_t<T>;
+        auto limit = static_cast<uint_type>(int_traits::max);
+        if (sign < 0)
+            ++limit;    // Magnitude of min
+
+        const char* at = s.data();
+        const char* end = at + s.length();
+        uint_type mag{};
+        bool ok = false;
+        if constexpr (is_wide) {
+            ok = use_swar ? imp::uint_from_chars_swar(at, end, radix, mag, limit)
+                          : imp::uint128_from_dec(at, end, mag, limit);
+        }
+        else
+            ok = imp::uint_from_chars_swar(at, end, radix, mag, limit);
+
+        const auto pos = static_cast<result::size_type>(at - s_og.data());
+        if (!ok)
+            return result(pos, error_code::out_of_range);
+        if (at == s.data())
+            return result(0, error_code::bad_parameter);
+
+        value = static_cast<value_type>((sign < 0) ? uint_type{0} - mag : mag);
+        return result(pos);
+    }
 
     // Eat the digits
     value_type digit = 0, radix_mult = static_cast<value_type>(radix);
@@ -121,6 +165,183 @@ constexpr from_chars_result from_chars(T& value, string_view s, unsigned radix =
     return result(s.is_empty() ? s_og.length() :  &s[0] - &s_og[0]);
 }
 
+/**
+ * @brief Parse a floating-point value from text
+ *
+ * Leading whitespace is skipped. Accepts an optional sign followed by
+ * inf, infinity, nan, nan(chars), or a number in the given style. Hex
+ * digits (with an optional p exponent) are parsed when fmt is hex, where
+ * the 0x prefix is optional, or when the number has a 0x prefix. The
+ * result is correctly rounded. long double is parsed as a double.
+ *
+ * If the value is too large or too small (but not zero) for the type
+ * then out_of_range is returned with pos_stop past the number and value
+ * is not modified.
+ */
+template <floating_point T>
+constexpr from_chars_result from_chars(T& value, string_view s,
+    chars_format fmt = chars_format::general) noexcept(true)
+{
+    using result = from_chars_result;
+
+    string_view s_og{s};
+
+    // Eat leading whitespace
+    if (s.trim(true, false).is_empty())
+        return result(0, error_code::bad_parameter);
+
+    const char* at = s.data();
+    imp::fp_conv_type<T> val_work{};
+    const auto ec = imp::fp_parse(at, s.data() + s.length(), fmt, val_work);
+    if (ec == error_code::bad_parameter)
+        return result(0, ec);
+
+    if (!is_error(ec))
+        value = val_work;
+    return result(static_cast<size_t>(at - s_og.data()), ec);
+}
+
+/// Result from parse_numbers
+struct parse_numbers_result
+{
+    size_t      pos_stop{0};    ///< Offset of the first malformed field, else the text length
+    size_t      line{0};        ///< Line of that field, from 0
+    size_t      field{0};       ///< Index of that field within its line, from 0
+    error_code  ec{};
+};
+
+namespace imp {
+
+    /// Counts the chars in s that are delim or a newline
+    inline size_t count_field_ends(string_view s, char delim) noexcept
+    {
+        size_t count = 0;
+        const size_t done = count_either_kernel(s.data(), s.length(), delim, '\n', count);
+        for (size_t i = done; i < s.length(); ++i)
+            count += (s[i] == delim) || (s[i] == '\n');
+        return count;
+    }
+
+    /**
+     * @brief Parse one field for parse_numbers, leaving at past the number
+     *
+     * Integers up to 64 bits go straight to the decimal SWAR parser; other
+     * types use from_chars. Either way, leading whitespace is not allowed,
+     * since from_chars would skip it, perhaps right into the next field.
+     */
+    template <class T>
+    inline error_code parse_number_field(T& value, const char*& at, const char* end, char delim)
+    {
+        if ((*at == delim) || string_view::traits_t::is_space(*at))
+            return error_code::bad_parameter;
+
+        if constexpr (integral<T> && (sizeof(T) <= sizeof(uint64_t)) && swar_enabled) {
+            // Signs are often a coin toss in real data, so no branch here
+            const char* p = at;
+            const bool neg = (*p == '-');
+            p += neg | (*p == '+');
+
+            const char* digits = p;
+            uint64_t mag = 0;
+            const bool fits = dec_u64_from_chars_swar(p, end, mag);
+            if (p == digits)
+                return error_code::bad_parameter;
+
+            auto limit = static_cast<uint64_t>(numeric_limits<T>::max);
+            if constexpr (is_signed_v<T>)
+                limit += neg;
+            else if (neg)
+                return error_code::out_of_range;
+            if (!fits || (mag > limit))
+                return error_code::out_of_range;
+
+            value = static_cast<T>(neg ? uint64_t{0} - mag : mag);
+            at = p;
+            return error_code::no_error;
+        }
+        else {
+            auto [pos, ec] = from_chars(value, string_view(at, static_cast<size_t>(end - at)));
+            at += pos;
+            return ec;
+        }
+    }
+}
+
+/**
+ * @brief Parse delimited text of numbers, such as a CSV column set, into a vector
+ *
+ * Fields are separated by delim and lines by '\n' (or "\r\n"); blank lines
+ * are skipped. Each field is parsed as by from_chars (base 10 for integers,
+ * general for floating-point) and must be nothing but the number. Values
+ * are appended to out in order.
+ *
+ * Parsing stops at the first malformed field, which is reported by offset,
+ * line, and field index. The error is that from_chars gave, or else
+ * bad_parameter; values before the field have been appended.
+ *
+ * Each field is converted in a single pass that stops right at its end,
+ * integers eight digits at a time, so the text is only scanned again to
+ * size the vector up front.
+ */
+template <class T>
+    requires integral<T> || floating_point<T>
+parse_numbers_result parse_numbers(vector<T>& out, string_view text, char delim = ',')
+{
+    out.reserve(out.size() + imp::count_field_ends(text, delim) + 1);
+
+    const char* const begin = text.data();
+    const char* const end = begin + text.length();
+    const char* p = begin;
+    parse_numbers_result res;
+
+    while (p != end) {
+        // Blank line?
+        if (*p == '\n' || ((*p == '\r') && (end - p > 1) && (p[1] == '\n'))) {
+            p += (*p == '\r') ? 2 : 1;
+            ++res.line;
+            continue;
+        }
+
+        T value{};
+        const char* at = p;
+        error_code ec = imp::parse_number_field(value, at, end, delim);
+        if (!is_error(ec) && (at != end) && (*at != delim) && (*at != '\n') &&
+            !((*at == '\r') && (end - at > 1) && (at[1] == '\n')))
+            ec = error_code::bad_parameter;
+        if (is_error(ec)) {
+            res.pos_stop = static_cast<size_t>(p - begin);
+            res.ec = ec;
+            return res;
+        }
+
+        out.push_back(value);
+        p = at;
+        if (p == end)
+            break;
+
+        if (*p == delim) {
+            ++p;
+            ++res.field;
+
+            // A delimiter ends a field, so there's one more to come
+            if ((p == end) || (*p == '\n') || (*p == '\r')) {
+                res.pos_stop = static_cast<size_t>(p - begin);
+                res.ec = error_code::bad_parameter;
+                return res;
+            }
+        }
+        else {
+            p += (*p == '\r') ? 2 : 1;
+            ++res.line;
+            res.field = 0;
+        }
+    }
+
+    res.pos_stop = text.length();
+    res.field = 0;
+    return res;
+}
+
 /// Result from to_chars
 struct to_chars_result
 {
@@ -133,54 +354,240 @@ struct to_chars_result
     error_code      ec{};
 };
 
+/**
+ * @brief Convert an integer to text in the given radix (2 to 36)
+ *
+ * Digits past 9 are uppercase letters. Negative values get a leading '-'.
+ */
 template <integral T>
 constexpr to_chars_result to_chars(char* begin, char* end, const T& val, unsigned base = 10)
 {
     // Check radix. This implementation will handle up to base 36
-    constexpr string_view radix_chars{"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"};
-    if ((base < 2) || (base > radix_chars.length()))
+    if ((base < 2) || (base >= sizeof(imp::radix_digits)))
         return to_chars_result(begin, error_code::bad_parameter);
 
-    T val_use = val;
-    auto at = begin;
-    bool first = true; // Ensures we handle 0 for unsigned types
+    using uint_type = imp::uint_of_size_t<T>;
+    auto val_use = static_cast<uint_type>(val);
 
-    // Handle negative and zero
+    // Handle negative; the magnitude of the minimum value is fine unsigned
     if constexpr (is_signed_v<T>) {
-        if (val_use <= T{0}) {
-            if (val_use < T{0}) {
-                if (begin == end)
-                    return to_chars_result(at, error_code::value_too_large);
-                *at++ = '-';
-                begin++;    // Advance so we don't include in swap below.
-            }
+        if (val < T{0}) {
+            if (begin == end)
+                return to_chars_result(end, error_code::value_too_large);
+            *begin++ = '-';
+            val_use = static_cast<uint_type>(uint_type{0} - val_use);
+        }
+    }
+
+    char* at = imp::uint_to_chars(begin, end, val_use, base);
+    return at ? to_chars_result(at) : to_chars_result(end, error_code::value_too_large);
+}
 
-            // Do first round here. This will decimate the number by one digit
-            // at which point it will be safe to negate and run through the
-            // main loop below.
-            if (at == end)
-                return to_chars_result(at, error_code::value_too_large);
-            *at++ = radix_chars[(val_use % T{base}) * (val_use < T{0} ? -1:1)];
-            val_use /= -T{base};
-            first = false;
+namespace imp {
+
+    template <floating_point T>
+    constexpr to_chars_result fp_to_chars(char* begin, char* end, T val,
+        chars_format fmt, int precision)
+    {
+        fp_repr repr;
+        repr.build(static_cast<fp_conv_type<T>>(val), fmt, precision, false);
+
+        char* at = repr.write(begin, end);
+        return at ? to_chars_result(at) : to_chars_result(end, error_code::value_too_large);
+    }
+}
+
+/**
+ * @brief Convert a floating-point value to the shortest text that
+ *  round-trips
+ *
+ * The text is in fixed or scientific notation, whichever is shorter,
+ * preferring fixed. long double is converted as a double.
+ */
+template <floating_point T>
+constexpr to_chars_result to_chars(char* begin, char* end, T val)
+{
+    return imp::fp_to_chars(begin, end, val, chars_format{}, -1);
+}
+
+/// Convert a floating-point value to the shortest text, in the given style, that round-trips
+template <floating_point T>
+constexpr to_chars_result to_chars(char* begin, char* end, T val, chars_format fmt)
+{
+    return imp::fp_to_chars(begin, end, val, fmt, -1);
+}
+
+/**
+ * @brief Convert a floating-point value to text with the given precision
+ *
+ * Output is exact, correctly rounded (half to even), as printf would
+ * produce with the equivalent %e, %f, %g, or %a conversion (less the 0x
+ * prefix for hex). A negative precision is taken as 6.
+ */
+template <floating_point T>
+constexpr to_chars_result to_chars(char* begin, char* end, T val, chars_format fmt, int precision)
+{
+    return imp::fp_to_chars(begin, end, val, fmt, precision < 0 ? 6 : precision);
+}
+
+/**
+ * @brief A read-only view of a run of bytes
+ *
+ * Input for the hex and base64 encoders, and formattable as hex. Any
+ * contiguous container of uint8_t (sys::vector, sys::array, ...) converts
+ * to one.
+ */
+class byte_view
+{
+public:
+
+    constexpr byte_view() noexcept = default;
+
+    constexpr byte_view(const uint8_t* data, size_t size) noexcept
+        : _data(data), _size(size)
+    {}
+
+    template <class C>
+        requires requires (const C& c) {
+            { c.data() } -> convertible_to<const uint8_t*>;
+            { c.size() } -> convertible_to<size_t>;
         }
+    constexpr byte_view(const C& c) noexcept
+        : _data(c.data()), _size(c.size())
+    {}
+
+    constexpr const uint8_t* data() const noexcept { return _data; }
+    constexpr size_t size() const noexcept { return _size; }
+    constexpr bool is_empty() const noexcept { return _size == 0; }
+
+private:
+
+    const uint8_t*  _data{nullptr};
+    size_t          _size{0};
+};
+
+/// Base64 alphabets: standard (+/) or URL and filename safe (-_); RFC 4648
+enum class base64_alphabet : uint8_t { standard, url };
+
+/// Returns the number of chars to_hex produces for count bytes
+constexpr size_t hex_length(size_t count) noexcept
+{
+    return count * 2;
+}
+
+/**
+ * @brief Encode bytes as hex digits, two per byte, high nibble first
+ *
+ * If the output doesn't fit, nothing is written and the result has
+ * error_code::value_too_large.
+ */
+constexpr to_chars_result to_hex(char* begin, char* end, byte_view bytes, bool upper = false) noexcept
+{
+    if (static_cast<size_t>(end - begin) < hex_length(bytes.size()))
+        return to_chars_result(end, error_code::value_too_large);
+
+    imp::hex_encode(begin, bytes.data(), bytes.size(), upper);
+    return to_chars_result(begin + hex_length(bytes.size()));
+}
+
+/**
+ * @brief Decode hex digits (of either case) to bytes
+ *
+ * On input, size is the capacity of dst; on output, it's the number of
+ * bytes written. s must be all hex digits, and an even number of them.
+ * An invalid char gives error_code::bad_parameter with pos_stop at that
+ * char; an odd count gives the same with pos_stop at the end. If dst
+ * is too small, nothing is written and the result has
+ * error_code::value_too_large.
+ */
+constexpr from_chars_result from_hex(uint8_t* dst, size_t& size, string_view s) noexcept
+{
+    using result = from_chars_result;
+
+    const size_t len = s.length();
+    if (len % 2) {
+        size = 0;
+        return result(len, error_code::bad_parameter);
+    }
+    if (size < len / 2) {
+        size = 0;
+        return result(0, error_code::value_too_large);
+    }
+
+    const size_t stop = imp::hex_decode(dst, s.data(), len);
+    size = stop / 2;
+    return (stop == len) ? result(len) : result(stop, error_code::bad_parameter);
+}
+
+/// Returns the number of chars to_base64 produces for count bytes
+constexpr size_t base64_length(size_t count, bool pad = true) noexcept
+{
+    const size_t rem = count % 3;
+    return count / 3 * 4 + (rem ? (pad ? 4 : rem + 1) : 0);
+}
+
+/**
+ * @brief Encode bytes as base64
+ *
+ * The final group is padded with '=' unless pad is false. If the output
+ * doesn't fit, nothing is written and the result has
+ * error_code::value_too_large.
+ */
+constexpr to_chars_result to_base64(char* begin, char* end, byte_view bytes,
+    base64_alphabet alphabet = base64_alphabet::standard, bool pad = true) noexcept
+{
+    if (static_cast<size_t>(end - begin) < base64_length(bytes.size(), pad))
+        return to_chars_result(end, error_code::value_too_large);
+
+    return to_chars_result(imp::base64_encode(begin, bytes.data(), bytes.size(),
+        alphabet == base64_alphabet::url, pad));
+}
+
+/**
+ * @brief Decode base64 to bytes
+ *
+ * On input, size is the capacity of dst; on output, it's the number of
+ * bytes written. Padding is optional, but if present it must complete the
+ * final group. Whitespace is not skipped, and unused bits in the final
+ * group are ignored. An invalid char gives error_code::bad_parameter with
+ * pos_stop at that char; a malformed final group gives the same with
+ * pos_stop where the padding starts (or would). If dst is too small,
+ * nothing is written and the result has error_code::value_too_large.
+ */
+constexpr from_chars_result from_base64(uint8_t* dst, size_t& size, string_view s,
+    base64_alphabet alphabet = base64_alphabet::standard) noexcept
+{
+    using result = from_chars_result;
+
+    // Up to two padding chars may complete the final group
+    size_t len = s.length();
+    size_t pad_count = 0;
+    while ((pad_count < 2) && (len > 0) && (s[len - 1] == imp::base64_pad)) {
+        --len;
+        ++pad_count;
+    }
+
+    if ((len % 4 == 1) || (pad_count && ((len + pad_count) % 4))) {
+        size = 0;
+        return result(len, error_code::bad_parameter);
     }
 
-    // Quickly calculate the digits; they will be in reverse order
-    while (val_use || first) {
-        if (at == end)
-            return to_chars_result(at, error_code::value_too_large);
-        *at++ = radix_chars[val_use % base];
-        val_use /= base;
-        first = false;
+    const size_t rem = len % 4;
+    const size_t need = len / 4 * 3 + (rem ? rem - 1 : 0);
+    if (size < need) {
+        size = 0;
+        return result(0, error_code::value_too_large);
     }
 
-    // Reverse the digits
-    auto loops = (at - begin) >> 1;
-    for (ptrdiff_t i=0; i<loops; ++i)
-        sys::swap(begin[i], at[-(i+1)]);
+    const size_t stop = imp::base64_decode(dst, s.data(), len,
+        alphabet == base64_alphabet::url);
+    if (stop != len) {
+        size = stop / 4 * 3;
+        return result(stop, error_code::bad_parameter);
+    }
 
-    return to_chars_result{at};
+    size = need;
+    return result(s.length());
 }
 
 _SYS_END_NS
@@ -12,24 +12,31 @@
 #include <_core_.h>
 
 _SYS_BEGIN_NS
-
-class strong_ordering;
-class weak_ordering;
-
 namespace imp {
     using cmp_val_t = signed char;
 }
+_SYS_END_NS
+
+// The compiler is assuming that we have std::strong_ordering,
+// std::weak_ordering, and std::partial_ordering, and (as of gcc-12) it
+// insists that they actually be declared in namespace std; aliases into
+// std from elsewhere won't cut it. So, the ordering classes live in std and
+// we pull them into sys below.
+namespace std {
+
+class strong_ordering;
+class weak_ordering;
 
 class partial_ordering
 {
-    imp::cmp_val_t _value;
+    sys::imp::cmp_val_t _value;
 
     // Constructed via the compiler
-    constexpr explicit partial_ordering(imp::cmp_val_t value) noexcept
+    constexpr explicit partial_ordering(sys::imp::cmp_val_t value) noexcept
         : _value(value) {}
 
     /// Returns our value which will be one of -1, 0, or 1
-    constexpr imp::cmp_val_t value() const noexcept
+    constexpr sys::imp::cmp_val_t value() const noexcept
         { return _value; }
 
     friend class strong_ordering;
@@ -85,14 +92,14 @@ inline constexpr partial_ordering partial_ordering::unordered{2};
 
 struct weak_ordering
 {
-    imp::cmp_val_t _value;
+    sys::imp::cmp_val_t _value;
 
     /// Constructed via the compiler
-    constexpr explicit weak_ordering(imp::cmp_val_t value) noexcept
+    constexpr explicit weak_ordering(sys::imp::cmp_val_t value) noexcept
         : _value(value) {}
 
     /// Returns our value which will be one of -1, 0, or 1
-    constexpr imp::cmp_val_t value() const noexcept
+    constexpr sys::imp::cmp_val_t value() const noexcept
         { return _value; }
 
     friend class strong_ordering;
@@ -142,14 +149,14 @@ inline constexpr weak_ordering weak_ordering::greater{1};
 
 struct strong_ordering
 {
-    imp::cmp_val_t _value;
+    sys::imp::cmp_val_t _value;
 
     /// Constructed via the compiler
-    constexpr explicit strong_ordering(imp::cmp_val_t value) noexcept
+    constexpr explicit strong_ordering(sys::imp::cmp_val_t value) noexcept
         : _value(value) {}
 
     /// Returns our value which will be one of -1, 0, or 1
-    constexpr imp::cmp_val_t value() const noexcept
+    constexpr sys::imp::cmp_val_t value() const noexcept
         { return _value; }
 
 public:
@@ -199,6 +206,14 @@ inline constexpr strong_ordering strong_ordering::equal{0};
 inline constexpr strong_ordering strong_ordering::equivalent{0};
 inline constexpr strong_ordering strong_ordering::greater{1};
 
+} // end namespace std
+
+_SYS_BEGIN_NS
+
+using std::partial_ordering;
+using std::weak_ordering;
+using std::strong_ordering;
+
 constexpr bool is_eq(sys::partial_ordering cmp) noexcept
     { return cmp == 0; }
 constexpr bool is_neq(sys::partial_ordering cmp) noexcept
@@ -301,12 +316,4 @@ concept three_way_comparable_with =
 
 _SYS_END_NS
 
-// The compiler is assuming that we have std::strong_ordering and
-// std::partial_ordering. We will just sidle in with our own version.
-namespace std {
-    using strong_ordering  = sys::strong_ordering;
-    using partial_ordering = sys::partial_ordering;
-    using weak_ordering    = sys::weak_ordering;
-}
-
 #endif // ifndef sys_compare__included
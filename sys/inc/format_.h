@@ -12,8 +12,12 @@
 #include "imp/fmt_core.h"
 #include "imp/fmt_std.h"
 #include "imp/fmt_std_int.h"
+#include "imp/fmt_std_float.h"
 #include "imp/fmt_std_str.h"
+#include "imp/fmt_std_range.h"
+#include "imp/fmt_std_bytes.h"
 #include "imp/fmt_buf.h"
+#include "imp/fmt_compiled.h"
 
 _SYS_BEGIN_NS
 
@@ -42,15 +46,74 @@ OutputIt vformat_to(OutputIt out, string_view fmt,
 template <class... FmtArgs>
 inline string format(format_string<FmtArgs...> fmt, FmtArgs&&... args)
 {
-    return vformat(fmt.get_view(), make_format_args(args...));
+    // The format string was compiled when it was constructed, so we skip
+    // vformat and just execute the plan.
+    imp::fmt_buf buf;
+    const auto f_args = make_format_args(args...);
+    format_context f_ctx{f_args, back_insert_iterator(buf)};
+    imp::do_format(fmt, f_ctx);
+    return buf.release_string();
 }
 
 /// Writes out formatted representation of its arguments through an output iterator
 template <class OutputIt, class... FmtArgs>
 inline OutputIt format_to(OutputIt out, format_string<FmtArgs...> fmt, FmtArgs&&... args)
 {
-    return vformat_to(move(out), fmt.get_view(),
-        make_format_args<basic_format_context<OutputIt>, FmtArgs...>(args...));
+    const auto f_args = make_format_args<basic_format_context<OutputIt>, FmtArgs...>(args...);
+    basic_format_context<OutputIt> f_ctx(f_args, move(out));
+    imp::do_format(fmt, f_ctx);
+    return f_ctx.out();
+}
+
+/// Stores formatted representation of the arguments in a new string
+template <class... FmtArgs>
+inline string format(const compiled_format<FmtArgs...>& fmt, const type_identity_t<FmtArgs>&... args)
+{
+    imp::fmt_buf buf;
+    const auto f_args = make_format_args(args...);
+    format_context f_ctx{f_args, back_insert_iterator(buf)};
+    fmt.execute(f_ctx);
+    return buf.release_string();
+}
+
+/// Writes out formatted representation of its arguments through an output iterator
+template <class OutputIt, class... FmtArgs>
+inline OutputIt format_to(OutputIt out, const compiled_format<FmtArgs...>& fmt,
+    const type_identity_t<FmtArgs>&... args)
+{
+    const auto f_args = make_format_args<basic_format_context<OutputIt>>(args...);
+    basic_format_context<OutputIt> f_ctx(f_args, move(out));
+    fmt.execute(f_ctx);
+    return f_ctx.out();
+}
+
+/// Result of format_to_n and format_into
+struct format_to_n_result
+{
+    char*   out;            ///< One past the last char written
+    size_t  size;           ///< Length of the full, untruncated output
+    bool    truncated;      ///< True if output did not fit
+};
+
+/// Writes out at most n chars of formatted output; never allocates
+template <class... FmtArgs>
+inline format_to_n_result format_to_n(char* out, size_t n,
+    format_string<FmtArgs...> fmt, FmtArgs&&... args)
+{
+    const auto it = format_to(imp::fmt_bounded_iterator(out, n), fmt, forward<FmtArgs>(args)...);
+    return format_to_n_result{it.get_out(), it.get_count(), it.get_count() > n};
+}
+
+/// Writes formatted output into a char array, truncating as needed; the
+/// result is always NUL terminated. Never allocates.
+template <size_t N, class... FmtArgs>
+    requires (N > 0)
+inline format_to_n_result format_into(char (&buf)[N],
+    format_string<FmtArgs...> fmt, FmtArgs&&... args)
+{
+    auto res = format_to_n(buf, N - 1, fmt, forward<FmtArgs>(args)...);
+    *res.out = '\0';
+    return res;
 }
 
 /// Determines the number of characters necessary to store formatted output
@@ -0,0 +1,196 @@
+/**
+ * @file    charconv_bytes.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Hex and base64 encoding and decoding internals; bulk char counting
+ *
+ * Each conversion has a scalar, table-driven loop here that works at
+ * compile time and handles whatever's left over at run time. Bulk input
+ * goes to the kernels in charconv_bytes.cpp first; those work a vector
+ * register at a time, using the widest instruction set the CPU supports,
+ * and only ever take whole blocks of valid input. Anything they leave
+ * (a short tail, padding, an invalid char) is then handled by the scalar
+ * loop, which is also where errors are found and reported.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <_core_.h>
+#include <type_traits_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// Digits for hex encoding
+inline constexpr char hex_digits_lower[] = "0123456789abcdef";
+inline constexpr char hex_digits_upper[] = "0123456789ABCDEF";
+
+/// Base64 alphabets (RFC 4648 sections 4 and 5)
+inline constexpr char base64_chars_std[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+inline constexpr char base64_chars_url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+/// Padding char for base64
+inline constexpr char base64_pad = '=';
+
+/// Maps a char to its value in the given alphabet, or -1 if it's not a member
+struct byte_decode_table
+{
+    constexpr byte_decode_table(const char* alphabet, size_t count) noexcept
+    {
+        for (auto& v : value)
+            v = -1;
+        for (size_t i = 0; i < count; ++i)
+            value[static_cast<uint8_t>(alphabet[i])] = static_cast<sint8_t>(i);
+    }
+
+    constexpr sint8_t operator[](char ch) const noexcept
+        { return value[static_cast<uint8_t>(ch)]; }
+
+    sint8_t value[256]{};
+};
+
+inline constexpr byte_decode_table hex_decode_lower{hex_digits_lower, 16};
+inline constexpr byte_decode_table hex_decode_upper{hex_digits_upper, 16};
+inline constexpr byte_decode_table base64_decode_std{base64_chars_std, 64};
+inline constexpr byte_decode_table base64_decode_url{base64_chars_url, 64};
+
+/// Value of a hex digit of either case, or -1
+constexpr int hex_digit_value(char ch) noexcept
+{
+    const sint8_t v = hex_decode_lower[ch];
+    return v >= 0 ? v : hex_decode_upper[ch];
+}
+
+// -- Run-time kernels (charconv_bytes.cpp)
+//
+// Each processes whole blocks from the front of the input and returns the
+// number of input units (bytes to encode, chars to decode) consumed. The
+// decoders stop at the first block holding a char that isn't in the
+// alphabet, padding included.
+
+size_t hex_encode_kernel(char* dst, const uint8_t* src, size_t count, bool upper) noexcept;
+size_t hex_decode_kernel(uint8_t* dst, const char* src, size_t len) noexcept;
+size_t base64_encode_kernel(char* dst, const uint8_t* src, size_t count, bool url) noexcept;
+size_t base64_decode_kernel(uint8_t* dst, const char* src, size_t len, bool url) noexcept;
+
+/// Adds the number of chars that are a or b to count
+size_t count_either_kernel(const char* src, size_t len, char a, char b, size_t& count) noexcept;
+
+/// Encode count bytes as 2 * count hex digits
+constexpr void hex_encode(char* dst, const uint8_t* src, size_t count, bool upper) noexcept
+{
+    if (!is_constant_evaluated()) {
+        const size_t done = hex_encode_kernel(dst, src, count, upper);
+        dst   += done * 2;
+        src   += done;
+        count -= done;
+    }
+
+    const char* digits = upper ? hex_digits_upper : hex_digits_lower;
+    for (size_t i = 0; i < count; ++i) {
+        *dst++ = digits[src[i] >> 4];
+        *dst++ = digits[src[i] & 0xF];
+    }
+}
+
+/**
+ * @brief Decode an even number of hex digits
+ *
+ * Returns the offset of the first invalid char, or len if all were good.
+ * Bytes before the invalid char have been written.
+ */
+constexpr size_t hex_decode(uint8_t* dst, const char* src, size_t len) noexcept
+{
+    size_t at = 0;
+    if (!is_constant_evaluated())
+        at = hex_decode_kernel(dst, src, len);
+
+    for (; at < len; at += 2) {
+        const int hi = hex_digit_value(src[at]);
+        if (hi < 0)
+            return at;
+        const int lo = hex_digit_value(src[at + 1]);
+        if (lo < 0)
+            return at + 1;
+        dst[at / 2] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+
+    return len;
+}
+
+/// Encode count bytes as base64; the final group is padded if pad is set
+constexpr char* base64_encode(char* dst, const uint8_t* src, size_t count,
+    bool url, bool pad) noexcept
+{
+    if (!is_constant_evaluated()) {
+        const size_t done = base64_encode_kernel(dst, src, count, url);
+        dst   += done / 3 * 4;
+        src   += done;
+        count -= done;
+    }
+
+    const char* chars = url ? base64_chars_url : base64_chars_std;
+    for (; count >= 3; count -= 3, src += 3) {
+        const uint32_t w = (uint32_t{src[0]} << 16) | (uint32_t{src[1]} << 8) | src[2];
+        *dst++ = chars[(w >> 18) & 63];
+        *dst++ = chars[(w >> 12) & 63];
+        *dst++ = chars[(w >>  6) & 63];
+        *dst++ = chars[w & 63];
+    }
+
+    if (count) {
+        const uint32_t w = (uint32_t{src[0]} << 16) | ((count > 1) ? uint32_t{src[1]} << 8 : 0u);
+        *dst++ = chars[(w >> 18) & 63];
+        *dst++ = chars[(w >> 12) & 63];
+        if (count > 1)
+            *dst++ = chars[(w >> 6) & 63];
+        else if (pad)
+            *dst++ = base64_pad;
+        if (pad)
+            *dst++ = base64_pad;
+    }
+
+    return dst;
+}
+
+/**
+ * @brief Decode len base64 chars, which have no padding
+ *
+ * len % 4 must not be 1. Returns the offset of the first invalid char, or
+ * len if all were good; bytes for the groups before it have been written.
+ */
+constexpr size_t base64_decode(uint8_t* dst, const char* src, size_t len, bool url) noexcept
+{
+    size_t at = 0;
+    if (!is_constant_evaluated()) {
+        at = base64_decode_kernel(dst, src, len, url);
+        dst += at / 4 * 3;
+    }
+
+    const auto& table = url ? base64_decode_url : base64_decode_std;
+    while (at < len) {
+        const size_t group = (len - at < 4) ? len - at : 4;
+        uint32_t w = 0;
+        for (size_t i = 0; i < group; ++i) {
+            const sint8_t v = table[src[at + i]];
+            if (v < 0)
+                return at + i;
+            w |= static_cast<uint32_t>(v) << (18 - 6 * i);
+        }
+
+        // A group of n chars holds n - 1 bytes
+        for (size_t i = 0; i + 1 < group; ++i)
+            *dst++ = static_cast<uint8_t>(w >> (16 - 8 * i));
+        at += group;
+    }
+
+    return len;
+}
+
+}   // end namespace imp
+
+_SYS_END_NS
@@ -0,0 +1,1002 @@
+/**
+ * @file    charconv_fp.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Floating-point to text conversion internals
+ *
+ * Shortest round-trip digits come from Ryu (Ulf Adams, "Ryu: fast
+ * float-to-string conversion", PLDI 2018). The 128-bit power-of-5 tables
+ * that it needs are generated at compile time rather than pasted in.
+ * Conversions with an explicit precision are exact: the value is expanded
+ * in full with a small big-integer and then correctly rounded.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <_core_.h>
+#include <bit_.h>
+#include <char_traits_.h>
+#include <error_.h>
+#include <string_view_.h>
+#include "charconv_int.h"
+
+_SYS_BEGIN_NS
+
+/// Floating-point formatting styles for to_chars
+enum class chars_format {
+    scientific = 0x1,
+    fixed      = 0x2,
+    hex        = 0x4,
+    general    = fixed | scientific
+};
+
+namespace imp {
+
+// ---------------- IEEE-754 layout ----------------------------------------
+
+template <class T> struct fp_traits;
+
+template <> struct fp_traits<float> {
+    using uint_type = uint32_t;
+    static constexpr sint32_t mantissa_bits = 23;
+    static constexpr sint32_t exponent_bits = 8;
+    static constexpr sint32_t bias          = 127;
+};
+
+template <> struct fp_traits<double> {
+    using uint_type = uint64_t;
+    static constexpr sint32_t mantissa_bits = 52;
+    static constexpr sint32_t exponent_bits = 11;
+    static constexpr sint32_t bias          = 1023;
+};
+
+/// The raw fields of a float or double
+struct fp_bits {
+    uint64_t    mantissa{0};        ///< Stored mantissa bits (no implicit bit)
+    uint32_t    exponent{0};        ///< Biased exponent
+    bool        negative{false};    ///< Sign bit
+    bool        is_special{false};  ///< inf or nan (all exponent bits set)
+
+    constexpr bool is_zero() const noexcept { return !exponent && !mantissa; }
+};
+
+template <class T>
+constexpr fp_bits fp_decode(T value) noexcept
+{
+    using traits    = fp_traits<T>;
+    using uint_type = typename traits::uint_type;
+
+    constexpr uint32_t exp_mask = (uint32_t{1} << traits::exponent_bits) - 1;
+
+    const auto raw = bit_cast<uint_type>(value);
+
+    fp_bits ret;
+    ret.mantissa   = raw & ((uint_type{1} << traits::mantissa_bits) - 1);
+    ret.exponent   = static_cast<uint32_t>(raw >> traits::mantissa_bits) & exp_mask;
+    ret.negative   = (raw >> (traits::mantissa_bits + traits::exponent_bits)) != 0;
+    ret.is_special = (ret.exponent == exp_mask);
+    return ret;
+}
+
+// ---------------- Big integer --------------------------------------------
+
+/**
+ * @brief Minimal fixed-capacity unsigned big integer
+ *
+ * Just enough to generate the conversion tables, to expand any double
+ * into its exact decimal digits, and to settle the hard cases when
+ * parsing. There is no overflow checking; callers stay within max_limbs.
+ */
+class fp_bigint
+{
+public:
+
+    /// Enough for the largest values we expand (2^53 * 5^1074 is 2547
+    /// bits) or compare when parsing (768 digits scaled; about 2700 bits)
+    static constexpr size_t max_limbs = 100;
+
+    constexpr fp_bigint() noexcept = default;
+
+    constexpr explicit fp_bigint(uint64_t val) noexcept
+    {
+        _limbs[0] = static_cast<uint32_t>(val);
+        _limbs[1] = static_cast<uint32_t>(val >> 32);
+        _size = 2;
+        trim();
+    }
+
+    // Only the significant limbs are copied
+    constexpr fp_bigint(const fp_bigint& other) noexcept
+        : _size(other._size)
+    {
+        for (size_t i = 0; i < _size; ++i)
+            _limbs[i] = other._limbs[i];
+    }
+
+    constexpr fp_bigint& operator=(const fp_bigint& other) noexcept
+    {
+        _size = other._size;
+        for (size_t i = 0; i < _size; ++i)
+            _limbs[i] = other._limbs[i];
+        return *this;
+    }
+
+    constexpr bool is_zero() const noexcept { return _size == 0; }
+
+    /// Returns the number of significant bits
+    constexpr size_t bit_length() const noexcept
+    {
+        if (!_size)
+            return 0;
+        const auto top = static_cast<size_t>(__builtin_clz(_limbs[_size - 1]));
+        return (_size << 5) - top;
+    }
+
+    /// *this *= val
+    constexpr void mul_small(uint32_t val) noexcept
+    {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < _size; ++i) {
+            const uint64_t prod = uint64_t{_limbs[i]} * val + carry;
+            _limbs[i] = static_cast<uint32_t>(prod);
+            carry = prod >> 32;
+        }
+        if (carry)
+            _limbs[_size++] = static_cast<uint32_t>(carry);
+        trim();
+    }
+
+    /// *this = *this * mul + add
+    constexpr void mul_add_small(uint32_t mul, uint32_t add) noexcept
+    {
+        uint64_t carry = add;
+        for (size_t i = 0; i < _size; ++i) {
+            const uint64_t prod = uint64_t{_limbs[i]} * mul + carry;
+            _limbs[i] = static_cast<uint32_t>(prod);
+            carry = prod >> 32;
+        }
+        if (carry)
+            _limbs[_size++] = static_cast<uint32_t>(carry);
+        trim();
+    }
+
+    /// *this += val
+    constexpr void add_small(uint32_t val) noexcept { mul_add_small(1, val); }
+
+    /// *this *= 5^n
+    constexpr void mul_pow5(uint32_t n) noexcept
+    {
+        constexpr uint32_t pow5_13 = 1220703125u;   // Largest 5^n in 32 bits
+        for (; n >= 13; n -= 13)
+            mul_small(pow5_13);
+
+        uint32_t mult = 1;
+        while (n--)
+            mult *= 5;
+        if (mult > 1)
+            mul_small(mult);
+    }
+
+    /// *this <<= n
+    constexpr void shift_left(uint32_t n) noexcept
+    {
+        if (!_size)
+            return;
+
+        const size_t   limbs = n >> 5;
+        const uint32_t bits  = n & 31;
+
+        if (bits) {
+            uint32_t carry = 0;
+            for (size_t i = 0; i < _size; ++i) {
+                const uint32_t cur = _limbs[i];
+                _limbs[i] = (cur << bits) | carry;
+                carry = cur >> (32 - bits);
+            }
+            if (carry)
+                _limbs[_size++] = carry;
+        }
+
+        if (limbs) {
+            for (size_t i = _size; i-- > 0; )
+                _limbs[i + limbs] = _limbs[i];
+            for (size_t i = 0; i < limbs; ++i)
+                _limbs[i] = 0;
+            _size += limbs;
+        }
+    }
+
+    /// *this >>= n
+    constexpr void shift_right(uint32_t n) noexcept
+    {
+        const size_t   limbs = n >> 5;
+        const uint32_t bits  = n & 31;
+
+        if (limbs >= _size) {
+            _size = 0;
+            return;
+        }
+
+        for (size_t i = 0; i + limbs < _size; ++i) {
+            const uint32_t lo = _limbs[i + limbs] >> bits;
+            const uint32_t hi = (bits && (i + limbs + 1 < _size))
+                ? _limbs[i + limbs + 1] << (32 - bits) : 0;
+            _limbs[i] = lo | hi;
+        }
+        _size -= limbs;
+        trim();
+    }
+
+    /// Returns <0, 0, or >0 as *this is less than, equal to, or greater than other
+    constexpr int compare(const fp_bigint& other) const noexcept
+    {
+        if (_size != other._size)
+            return (_size < other._size) ? -1 : 1;
+        for (size_t i = _size; i-- > 0; ) {
+            if (_limbs[i] != other._limbs[i])
+                return (_limbs[i] < other._limbs[i]) ? -1 : 1;
+        }
+        return 0;
+    }
+
+    /// *this /= val; returns the remainder
+    constexpr uint32_t div_small(uint32_t val) noexcept
+    {
+        uint64_t rem = 0;
+        for (size_t i = _size; i-- > 0; ) {
+            const uint64_t cur = (rem << 32) | _limbs[i];
+            _limbs[i] = static_cast<uint32_t>(cur / val);
+            rem = cur % val;
+        }
+        trim();
+        return static_cast<uint32_t>(rem);
+    }
+
+    /// Returns the 128 bits starting at bit pos; pos < 0 shifts left
+    constexpr uint128_t bits_at(sint32_t pos) const noexcept
+    {
+        uint128_t ret = 0;
+        for (sint32_t b = 0; b < 128; b += 32)
+            ret |= uint128_t{bits32_at(pos + b)} << b;
+        return ret;
+    }
+
+    /**
+     * @brief Writes the decimal digits of the value, most significant first
+     *
+     * This consumes the value (it's zero afterwards).
+     *
+     * @return Returns the number of digits written
+     */
+    constexpr size_t to_decimal(char* dst) noexcept
+    {
+        // Peel off nine digits at a time, least significant first
+        uint32_t chunks[(max_limbs << 5) / 29 + 1];
+        size_t count = 0;
+        do {
+            chunks[count++] = div_small(1000000000u);
+        } while (!is_zero());
+
+        // Leading chunk has no leading zeros; the rest are zero-padded
+        char tmp[10]{};
+        size_t tmp_len = 0;
+        for (uint32_t top = chunks[count - 1]; top; top /= 10)
+            tmp[tmp_len++] = static_cast<char>('0' + top % 10);
+        if (!tmp_len)
+            tmp[tmp_len++] = '0';
+
+        size_t len = 0;
+        while (tmp_len)
+            dst[len++] = tmp[--tmp_len];
+
+        for (size_t c = count - 1; c-- > 0; ) {
+            uint32_t chunk = chunks[c];
+            for (size_t d = 9; d-- > 0; chunk /= 10)
+                dst[len + d] = static_cast<char>('0' + chunk % 10);
+            len += 9;
+        }
+
+        return len;
+    }
+
+private:
+
+    constexpr uint32_t limb(size_t idx) const noexcept
+        { return idx < _size ? _limbs[idx] : 0; }
+
+    /// Returns the 32 bits starting at bit pos; pos < 0 shifts left
+    constexpr uint32_t bits32_at(sint32_t pos) const noexcept
+    {
+        if (pos <= -32)
+            return 0;
+        if (pos < 0)
+            return limb(0) << -pos;
+
+        const auto idx = static_cast<size_t>(pos >> 5);
+        const auto sh  = static_cast<uint32_t>(pos & 31);
+        const uint32_t lo = limb(idx) >> sh;
+        const uint32_t hi = sh ? limb(idx + 1) << (32 - sh) : 0;
+        return lo | hi;
+    }
+
+    constexpr void trim() noexcept
+    {
+        while (_size && !_limbs[_size - 1])
+            --_size;
+    }
+
+    uint32_t    _limbs[max_limbs];      ///< Little-endian limbs
+    size_t      _size{0};               ///< Significant limbs; 0 == zero
+};
+
+// ---------------- Ryu shortest round-trip --------------------------------
+
+inline constexpr sint32_t ryu_pow5_inv_bitcount = 125;
+inline constexpr sint32_t ryu_pow5_bitcount     = 125;
+inline constexpr size_t   ryu_pow5_inv_count    = 342;
+inline constexpr size_t   ryu_pow5_count        = 326;
+
+/// Returns ceil(log2(5^e)) (1 for e == 0); valid for 0 <= e <= 3528
+constexpr sint32_t ryu_pow5bits(sint32_t e) noexcept
+    { return static_cast<sint32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1; }
+
+/// Returns floor(log10(2^e)); valid for 0 <= e <= 1650
+constexpr uint32_t ryu_log10_pow2(sint32_t e) noexcept
+    { return (static_cast<uint32_t>(e) * 78913) >> 18; }
+
+/// Returns floor(log10(5^e)); valid for 0 <= e <= 2620
+constexpr uint32_t ryu_log10_pow5(sint32_t e) noexcept
+    { return (static_cast<uint32_t>(e) * 732923) >> 20; }
+
+struct ryu_tables_t {
+    uint128_t   pow5_inv[ryu_pow5_inv_count]{};     ///< floor(2^k / 5^i) + 1
+    uint128_t   pow5[ryu_pow5_count]{};             ///< Top 125 bits of 5^i
+};
+
+consteval ryu_tables_t ryu_make_tables()
+{
+    ryu_tables_t t{};
+
+    fp_bigint p5{1};
+    for (size_t i = 0; i < ryu_pow5_count; ++i) {
+        const auto len = ryu_pow5bits(static_cast<sint32_t>(i));
+        t.pow5[i] = p5.bits_at(len - ryu_pow5_bitcount);
+        p5.mul_small(5);
+    }
+
+    // Repeated floor division is exact: floor(floor(x/5)/5) == floor(x/25)
+    constexpr sint32_t scale = 1024;
+    fp_bigint inv{1};
+    inv.shift_left(scale);
+    for (size_t i = 0; i < ryu_pow5_inv_count; ++i) {
+        const auto j = ryu_pow5bits(static_cast<sint32_t>(i)) - 1 + ryu_pow5_inv_bitcount;
+        t.pow5_inv[i] = inv.bits_at(scale - j) + 1;
+        inv.div_small(5);
+    }
+
+    return t;
+}
+
+inline constexpr ryu_tables_t ryu_tables = ryu_make_tables();
+
+constexpr uint32_t ryu_pow5_factor(uint64_t val) noexcept
+{
+    uint32_t count = 0;
+    for (; val % 5 == 0; val /= 5)
+        ++count;
+    return count;
+}
+
+constexpr bool ryu_multiple_of_pow5(uint64_t val, uint32_t p) noexcept
+    { return ryu_pow5_factor(val) >= p; }
+
+constexpr bool ryu_multiple_of_pow2(uint64_t val, uint32_t p) noexcept
+    { return (val & ((uint64_t{1} << p) - 1)) == 0; }
+
+constexpr uint64_t ryu_mul_shift(uint64_t m, uint128_t mul, sint32_t j) noexcept
+{
+    const uint128_t b0 = uint128_t{m} * static_cast<uint64_t>(mul);
+    const uint128_t b2 = uint128_t{m} * static_cast<uint64_t>(mul >> 64);
+    return static_cast<uint64_t>(((b0 >> 64) + b2) >> (j - 64));
+}
+
+/// A decimal floating-point value: digits * 10^exponent
+struct fp_decimal {
+    uint64_t    digits{0};
+    sint32_t     exponent{0};
+};
+
+/**
+ * @brief Returns the shortest decimal that round-trips to the given value
+ *
+ * The value must be finite and non-zero. This is Ryu's d2d generalized
+ * over the IEEE layout; float runs through the same double tables.
+ */
+template <class T>
+constexpr fp_decimal fp_shortest(const fp_bits& b) noexcept
+{
+    using traits = fp_traits<T>;
+
+    sint32_t  e2;
+    uint64_t m2;
+    if (b.exponent == 0) {
+        e2 = 1 - traits::bias - traits::mantissa_bits - 2;
+        m2 = b.mantissa;
+    }
+    else {
+        e2 = static_cast<sint32_t>(b.exponent) - traits::bias - traits::mantissa_bits - 2;
+        m2 = (uint64_t{1} << traits::mantissa_bits) | b.mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // Step 2: Determine the interval of valid decimal representations
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = (b.mantissa != 0) || (b.exponent <= 1);
+
+    // Step 3: Convert to a decimal power base using 128-bit arithmetic
+    uint64_t vr, vp, vm;
+    sint32_t  e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+
+    if (e2 >= 0) {
+        const uint32_t q = ryu_log10_pow2(e2) - (e2 > 3);
+        e10 = static_cast<sint32_t>(q);
+        const sint32_t k = ryu_pow5_inv_bitcount + ryu_pow5bits(static_cast<sint32_t>(q)) - 1;
+        const sint32_t i = -e2 + static_cast<sint32_t>(q) + k;
+        const uint128_t mul = ryu_tables.pow5_inv[q];
+        vr = ryu_mul_shift(4 * m2, mul, i);
+        vp = ryu_mul_shift(4 * m2 + 2, mul, i);
+        vm = ryu_mul_shift(4 * m2 - 1 - mm_shift, mul, i);
+        if (q <= 21) {
+            // Only one of mp, mv, and mm can be a multiple of 5, if any
+            if (mv % 5 == 0)
+                vr_trailing_zeros = ryu_multiple_of_pow5(mv, q);
+            else if (accept_bounds)
+                vm_trailing_zeros = ryu_multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= ryu_multiple_of_pow5(mv + 2, q);
+        }
+    }
+    else {
+        const uint32_t q = ryu_log10_pow5(-e2) - (-e2 > 1);
+        e10 = static_cast<sint32_t>(q) + e2;
+        const sint32_t i = -e2 - static_cast<sint32_t>(q);
+        const sint32_t k = ryu_pow5bits(i) - ryu_pow5_bitcount;
+        const sint32_t j = static_cast<sint32_t>(q) - k;
+        const uint128_t mul = ryu_tables.pow5[i];
+        vr = ryu_mul_shift(4 * m2, mul, j);
+        vp = ryu_mul_shift(4 * m2 + 2, mul, j);
+        vm = ryu_mul_shift(4 * m2 - 1 - mm_shift, mul, j);
+        if (q <= 1) {
+            // {vr,vp,vm} is trailing zeros if {mv,mp,mm} has at least q
+            // trailing 0 bits. mv = 4 * m2, so it always has at least two.
+            vr_trailing_zeros = true;
+            if (accept_bounds)
+                vm_trailing_zeros = (mm_shift == 1);
+            else
+                --vp;
+        }
+        else if (q < 63)
+            vr_trailing_zeros = ryu_multiple_of_pow2(mv, q);
+    }
+
+    // Step 4: Find the shortest decimal representation in the interval
+    sint32_t removed = 0;
+    uint32_t last_removed = 0;
+    uint64_t output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        // General case, which happens rarely (~0.7%)
+        for (; vp / 10 > vm / 10; ++removed) {
+            vm_trailing_zeros &= (vm % 10 == 0);
+            vr_trailing_zeros &= (last_removed == 0);
+            last_removed = static_cast<uint32_t>(vr % 10);
+            vr /= 10; vp /= 10; vm /= 10;
+        }
+        if (vm_trailing_zeros) {
+            for (; vm % 10 == 0; ++removed) {
+                vr_trailing_zeros &= (last_removed == 0);
+                last_removed = static_cast<uint32_t>(vr % 10);
+                vr /= 10; vp /= 10; vm /= 10;
+            }
+        }
+        // Round even if the exact number is .....50..0
+        if (vr_trailing_zeros && (last_removed == 5) && (vr % 2 == 0))
+            last_removed = 4;
+        output = vr + (((vr == vm) && (!accept_bounds || !vm_trailing_zeros)) || (last_removed >= 5));
+    }
+    else {
+        // Common case; remove two digits at a time when we can
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = (vr % 100) >= 50;
+            vr /= 100; vp /= 100; vm /= 100;
+            removed += 2;
+        }
+        for (; vp / 10 > vm / 10; ++removed) {
+            round_up = (vr % 10) >= 5;
+            vr /= 10; vp /= 10; vm /= 10;
+        }
+        output = vr + ((vr == vm) || round_up);
+    }
+
+    return fp_decimal{output, e10 + removed};
+}
+
+// ---------------- Text layout --------------------------------------------
+
+/**
+ * @brief A floating-point value laid out as text
+ *
+ * Holds the significant digits of a value and how they're laid out for the
+ * requested style, so callers can measure the result (e.g., for padding)
+ * before emitting it. Excluding the sign, the text is:
+ *
+ *   int_digits [int_zeros] [. [frac_zeros] frac_digits [frac_trail]] [exponent]
+ *
+ * or just special() for inf and nan. Runs of zeros are counts rather than
+ * chars so huge precisions don't need huge buffers.
+ */
+class fp_repr
+{
+public:
+
+    /// Enough for every significant digit of the smallest subnormal double
+    static constexpr size_t max_digits = 800;
+
+    /**
+     * @brief Lay out the given value
+     *
+     * @param value     The value to lay out
+     * @param fmt       The style; chars_format{} picks the shorter of fixed
+     *  and scientific (preferring fixed)
+     * @param precision Digits after the point (significant digits for
+     *  general); < 0 for the shortest text that round-trips
+     * @param alt_form  Always include a decimal point; general style keeps
+     *  trailing zeros
+     */
+    template <class T>
+    constexpr void build(T value, chars_format fmt, int precision, bool alt_form)
+    {
+        const fp_bits bits = fp_decode(value);
+
+        _negative = bits.negative;
+        if (bits.is_special) {
+            _special = bits.mantissa ? "nan" : "inf";
+            return;
+        }
+
+        if (fmt == chars_format::hex)
+            return build_hex<T>(bits, precision, alt_form);
+
+        if (precision < 0)
+            build_shortest<T>(bits, fmt, alt_form);
+        else
+            build_exact<T>(bits, fmt, precision, alt_form);
+    }
+
+    constexpr bool          is_negative()   const noexcept { return _negative; }
+    constexpr string_view   special()       const noexcept { return _special; }
+    constexpr string_view   int_digits()    const noexcept { return string_view(_digits, _int_len); }
+    constexpr size_t        int_zeros()     const noexcept { return _int_zeros; }
+    constexpr bool          has_point()     const noexcept { return _point; }
+    constexpr size_t        frac_zeros()    const noexcept { return _frac_zeros; }
+    constexpr string_view   frac_digits()   const noexcept { return string_view(_digits + _int_len, _frac_len); }
+    constexpr size_t        frac_trail()    const noexcept { return _frac_trail; }
+    constexpr string_view   exponent()      const noexcept { return string_view(_exp_buf, _exp_len); }
+
+    /// Returns the length of the text, excluding any sign
+    constexpr size_t length() const noexcept
+    {
+        if (!_special.is_empty())
+            return _special.length();
+
+        return _int_len + _int_zeros + _point + _frac_zeros + _frac_len + _frac_trail + _exp_len;
+    }
+
+    /// Convert hex digits, exponent, inf, and nan to uppercase
+    constexpr void to_upper() noexcept
+    {
+        using traits = char_traits<char>;
+
+        _special = _special == "nan" ? "NAN" : _special == "inf" ? "INF" : _special;
+        for (size_t i = 0; i < _n; ++i)
+            _digits[i] = traits::to_upper(_digits[i]);
+        for (size_t i = 0; i < _exp_len; ++i)
+            _exp_buf[i] = traits::to_upper(_exp_buf[i]);
+    }
+
+    /// Write the text (with a '-' for negative values) to [first, last)
+    constexpr char* write(char* first, char* last) const noexcept
+    {
+        using traits = char_traits<char>;
+
+        if (static_cast<size_t>(last - first) < length() + _negative)
+            return nullptr;
+
+        auto put = [&first](string_view sv) {
+            traits::copy(first, sv.data(), sv.length());
+            first += sv.length();
+        };
+        auto put_zeros = [&first](size_t count) {
+            traits::fill(first, '0', count);
+            first += count;
+        };
+
+        if (_negative)
+            *first++ = '-';
+        if (!_special.is_empty()) {
+            put(_special);
+            return first;
+        }
+
+        put(int_digits());
+        put_zeros(_int_zeros);
+        if (_point)
+            *first++ = '.';
+        put_zeros(_frac_zeros);
+        put(frac_digits());
+        put_zeros(_frac_trail);
+        put(exponent());
+        return first;
+    }
+
+private:
+
+    template <class T>
+    constexpr void build_shortest(const fp_bits& bits, chars_format fmt, bool alt_form)
+    {
+        if (bits.is_zero())
+            set_digits(0, 0);
+        else {
+            const auto dec = fp_shortest<T>(bits);
+            set_digits(dec.digits, dec.exponent);
+        }
+
+        const auto n = static_cast<sint64_t>(_n);
+        const auto fixed_prec = (n - 1 > _exp10) ? n - 1 - _exp10 : 0;
+
+        if (fmt == chars_format{}) {
+            // Plain: whichever of fixed and scientific is shorter
+            const sint64_t sci_len = n + (n > 1) + ((_exp10 <= -100) || (_exp10 >= 100) ? 5 : 4);
+            const sint64_t fix_len = (_exp10 >= 0 ? _exp10 + 1 : 1) + (fixed_prec ? fixed_prec + 1 : 0);
+            fmt = (fix_len <= sci_len) ? chars_format::fixed : chars_format::scientific;
+        }
+
+        switch (fmt) {
+        case chars_format::scientific:
+            layout_scientific(n - 1, alt_form);
+            break;
+        case chars_format::fixed:
+            // Of the equally short ways to write a large integer, the
+            // exact one is closest to the value.
+            if ((_exp10 >= n) && is_integral<T>(bits))
+                set_exact<T>(bits);
+            layout_fixed(fixed_prec, alt_form);
+            break;
+        default:
+            // General: as %g with a precision of the shortest digit count
+            if ((n > _exp10) && (_exp10 >= -4))
+                layout_fixed(fixed_prec, alt_form);
+            else
+                layout_scientific(n - 1, alt_form);
+            break;
+        }
+    }
+
+    template <class T>
+    constexpr void build_exact(const fp_bits& bits, chars_format fmt, int precision, bool alt_form)
+    {
+        const sint64_t prec = precision;
+
+        if (bits.is_zero())
+            set_digits(0, 0);
+        else if ((fmt != chars_format::fixed) || !set_fixed_fast<T>(bits, prec))
+            set_exact<T>(bits);
+
+        switch (fmt) {
+        case chars_format::scientific:
+            round_sig(prec + 1);
+            layout_scientific(prec, alt_form);
+            break;
+        case chars_format::fixed:
+            round_sig(_exp10 + 1 + prec);   // No-op after set_fixed_fast
+            layout_fixed(prec, alt_form);
+            break;
+        default: {
+            // General: as %g
+            const sint64_t sig = prec ? prec : 1;
+            round_sig(sig);
+            if ((sig > _exp10) && (_exp10 >= -4))
+                layout_fixed(sig - 1 - _exp10, alt_form);
+            else
+                layout_scientific(sig - 1, alt_form);
+            if (!alt_form) {
+                _frac_trail = 0;
+                _point = (_frac_zeros + _frac_len) > 0;
+            }
+            break;
+        }
+        }
+    }
+
+    template <class T>
+    constexpr void build_hex(const fp_bits& bits, int precision, bool alt_form)
+    {
+        using traits = fp_traits<T>;
+
+        // Mantissa as whole nibbles: 13 for double, 6 for float
+        constexpr sint32_t nibbles = (traits::mantissa_bits + 3) >> 2;
+        constexpr sint32_t pad     = (nibbles << 2) - traits::mantissa_bits;
+
+        uint64_t frac = bits.mantissa << pad;
+        uint32_t lead = bits.exponent ? 1 : 0;
+        sint32_t  exp2 = bits.is_zero() ? 0
+            : (bits.exponent ? static_cast<sint32_t>(bits.exponent) : 1) - traits::bias;
+
+        // Round half-to-even to the requested nibble count
+        sint32_t kept = nibbles;
+        if ((precision >= 0) && (precision < nibbles)) {
+            const auto drop = static_cast<uint32_t>(nibbles - precision) << 2;
+            const uint64_t rem  = frac & ((uint64_t{1} << drop) - 1);
+            const uint64_t half = uint64_t{1} << (drop - 1);
+            frac >>= drop;
+
+            const bool odd = precision ? (frac & 1) : (lead & 1);
+            if ((rem > half) || ((rem == half) && odd)) {
+                // Carry out of the kept nibbles goes into the lead digit
+                if (++frac >> (precision << 2)) {
+                    frac = 0;
+                    ++lead;
+                }
+            }
+            kept = precision;
+        }
+
+        constexpr char hex_digits[] = "0123456789abcdef";
+        _n = 0;
+        _digits[_n++] = hex_digits[lead];
+        for (sint32_t i = kept; i-- > 0; )
+            _digits[_n++] = hex_digits[(frac >> (i << 2)) & 0xF];
+
+        if (precision < 0)
+            strip_zeros();
+
+        _int_len    = 1;
+        _frac_len   = _n - 1;
+        _frac_trail = (precision > kept) ? static_cast<size_t>(precision - kept) : 0;
+        _point      = alt_form || (_frac_len + _frac_trail) > 0;
+        set_exponent('p', exp2, 1);
+    }
+
+    /// Returns true if the value has no fractional part
+    template <class T>
+    static constexpr bool is_integral(const fp_bits& bits) noexcept
+    {
+        using traits = fp_traits<T>;
+
+        const sint32_t e2 = static_cast<sint32_t>(bits.exponent) - traits::bias - traits::mantissa_bits;
+        if (!bits.exponent || (e2 < -traits::mantissa_bits))
+            return bits.is_zero();
+        return (e2 >= 0) || ryu_multiple_of_pow2(bits.mantissa, static_cast<uint32_t>(-e2));
+    }
+
+    /// Set digits from a decimal value: digits * 10^exponent
+    constexpr void set_digits(uint64_t digits, sint32_t exponent) noexcept
+    {
+        _n = count_digits10(digits);
+        put_dec_backward(_digits + _n, digits);
+
+        _exp10 = exponent + static_cast<sint32_t>(_n) - 1;
+        strip_zeros();
+    }
+
+    /// Set digits to the exact decimal expansion of the value
+    template <class T>
+    constexpr void set_exact(const fp_bits& bits) noexcept
+    {
+        using traits = fp_traits<T>;
+
+        // value = m * 2^e2
+        uint64_t m  = bits.mantissa;
+        sint32_t  e2 = 1 - traits::bias - traits::mantissa_bits;
+        if (bits.exponent) {
+            m |= uint64_t{1} << traits::mantissa_bits;
+            e2 = static_cast<sint32_t>(bits.exponent) - traits::bias - traits::mantissa_bits;
+        }
+
+        // Dropping trailing zero bits keeps the big integer small
+        const auto tz = __builtin_ctzll(m);
+        m >>= tz;
+        e2 += tz;
+
+        fp_bigint big{m};
+        if (e2 >= 0) {
+            big.shift_left(static_cast<uint32_t>(e2));
+            _n = big.to_decimal(_digits);
+            _exp10 = static_cast<sint32_t>(_n) - 1;
+        }
+        else {
+            // m * 2^e2 == m * 5^-e2 * 10^e2
+            big.mul_pow5(static_cast<uint32_t>(-e2));
+            _n = big.to_decimal(_digits);
+            _exp10 = static_cast<sint32_t>(_n) - 1 + e2;
+        }
+
+        strip_zeros();
+    }
+
+    /**
+     * @brief Set digits for fixed notation with the given precision
+     *
+     * This is the common case of modest values with a few decimals, e.g.
+     * {:.2f}, where value * 10^prec can be correctly rounded to an integer
+     * using 128-bit arithmetic rather than the big integer.
+     *
+     * @return Returns false if the value is out of range for this method
+     */
+    template <class T>
+    constexpr bool set_fixed_fast(const fp_bits& bits, sint64_t prec) noexcept
+    {
+        using traits = fp_traits<T>;
+
+        // m * 5^prec must fit in 128 bits
+        if (prec > 27)
+            return false;
+
+        uint64_t m  = bits.mantissa;
+        sint64_t e2 = 1 - traits::bias - traits::mantissa_bits;
+        if (bits.exponent) {
+            m |= uint64_t{1} << traits::mantissa_bits;
+            e2 = static_cast<sint64_t>(bits.exponent) - traits::bias - traits::mantissa_bits;
+        }
+
+        // value * 10^prec == m * 5^prec / 2^shift
+        const sint64_t shift = -(e2 + prec);
+        if (shift <= 0)
+            return false;   // Large integral values; leave to set_exact
+        if (shift >= 128) {
+            set_digits(0, 0);   // Less than half a unit in the last place
+            return true;
+        }
+
+        uint128_t scaled = m;
+        for (sint64_t i = 0; i < prec; ++i)
+            scaled *= 5;
+
+        const auto sh = static_cast<uint32_t>(shift);
+        uint128_t q = scaled >> sh;
+        const uint128_t rem  = scaled & ((uint128_t{1} << sh) - 1);
+        const uint128_t half = uint128_t{1} << (sh - 1);
+        if ((rem > half) || ((rem == half) && (q & 1)))
+            ++q;
+
+        if (q >> 64)
+            return false;
+        if (q)
+            set_digits(static_cast<uint64_t>(q), static_cast<sint32_t>(-prec));
+        else
+            set_digits(0, 0);
+        return true;
+    }
+
+    /// Round (half-to-even) to keep significant digits; keep may be <= 0
+    constexpr void round_sig(sint64_t keep) noexcept
+    {
+        if (keep >= static_cast<sint64_t>(_n))
+            return;
+
+        if (keep < 0) {
+            set_digits(0, 0);
+            return;
+        }
+
+        // Exact digits have no trailing zeros, so anything after the
+        // first dropped digit makes it more than half.
+        const auto k = static_cast<size_t>(keep);
+        const char first_dropped = _digits[k];
+        const bool more = (_n > k + 1);
+        const bool odd  = k && ((_digits[k - 1] - '0') & 1);
+        const bool up   = (first_dropped > '5') || ((first_dropped == '5') && (more || odd));
+
+        _n = k;
+        if (up) {
+            size_t i = k;
+            while (i && (_digits[i - 1] == '9'))
+                --i;
+            if (i) {
+                ++_digits[i - 1];
+                _n = i;
+            }
+            else {
+                // All nines (or nothing kept): carry into a new digit
+                _digits[0] = '1';
+                _n = 1;
+                ++_exp10;
+            }
+        }
+        else if (!_n)
+            set_digits(0, 0);
+
+        strip_zeros();
+    }
+
+    constexpr void strip_zeros() noexcept
+    {
+        while ((_n > 1) && (_digits[_n - 1] == '0'))
+            --_n;
+    }
+
+    constexpr void layout_fixed(sint64_t prec, bool alt_form) noexcept
+    {
+        const auto n = static_cast<sint64_t>(_n);
+        if (_exp10 >= 0) {
+            const sint64_t int_len = (n < _exp10 + 1) ? n : _exp10 + 1;
+            _int_len    = static_cast<size_t>(int_len);
+            _int_zeros  = static_cast<size_t>(_exp10 + 1 - int_len);
+            _frac_zeros = 0;
+        }
+        else {
+            _int_len    = 0;
+            _int_zeros  = 1;
+            _frac_zeros = static_cast<size_t>(-_exp10 - 1);
+        }
+        _frac_len   = _n - _int_len;
+        _frac_trail = static_cast<size_t>(prec) - _frac_zeros - _frac_len;
+        _point      = alt_form || (prec > 0);
+        _exp_len    = 0;
+    }
+
+    constexpr void layout_scientific(sint64_t prec, bool alt_form) noexcept
+    {
+        _int_len    = 1;
+        _int_zeros  = 0;
+        _frac_zeros = 0;
+        _frac_len   = _n - 1;
+        _frac_trail = static_cast<size_t>(prec) - _frac_len;
+        _point      = alt_form || (prec > 0);
+        set_exponent('e', _exp10, 2);
+    }
+
+    constexpr void set_exponent(char marker, sint32_t exp, size_t min_digits) noexcept
+    {
+        char tmp[8]{};
+        size_t len = 0;
+        auto mag = static_cast<uint32_t>(exp < 0 ? -exp : exp);
+        do {
+            tmp[len++] = static_cast<char>('0' + mag % 10);
+            mag /= 10;
+        } while (mag || (len < min_digits));
+
+        _exp_len = 0;
+        _exp_buf[_exp_len++] = marker;
+        _exp_buf[_exp_len++] = (exp < 0) ? '-' : '+';
+        while (len)
+            _exp_buf[_exp_len++] = tmp[--len];
+    }
+
+    char        _digits[max_digits];    ///< Significant digits: d.ddd x 10^_exp10
+    size_t      _n{0};                  ///< Significant digit count
+    sint32_t     _exp10{0};              ///< Decimal exponent of first digit
+    bool        _negative{false};
+    string_view _special{};             ///< "inf" or "nan" or empty
+
+    size_t      _int_len{0};
+    size_t      _int_zeros{0};
+    size_t      _frac_zeros{0};
+    size_t      _frac_len{0};
+    size_t      _frac_trail{0};
+    bool        _point{false};
+    char        _exp_buf[8]{};
+    size_t      _exp_len{0};
+};
+
+/// The binary type we convert a floating-point type through
+template <class T>
+using fp_conv_type = conditional_t<is_same_v<remove_cv_t<T>, float>, float, double>;
+
+}   // end namespace imp
+
+_SYS_END_NS
@@ -0,0 +1,611 @@
+/**
+ * @file    charconv_fp_parse.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Text to floating-point conversion internals
+ *
+ * Decimal input takes Clinger's fast path when both the digits and the
+ * power of ten are exact in the binary type, and the Eisel-Lemire
+ * algorithm (Daniel Lemire, "Number Parsing at a Gigabyte per Second",
+ * 2021) for nearly everything else. The few inputs that neither can
+ * settle (long digit strings very close to a halfway point) are decided
+ * exactly with fp_bigint. Results are always correctly rounded.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include "charconv_fp.h"
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+// ---------------- Parsing parameters -------------------------------------
+
+template <class T> struct fp_parse_traits;
+
+template <> struct fp_parse_traits<float> {
+    static constexpr sint32_t min_exponent      = -127;
+    static constexpr sint32_t infinite_power    = 0xFF;
+    static constexpr sint32_t min_round_even    = -17;  ///< Range of q where ties are possible
+    static constexpr sint32_t max_round_even    = 10;
+    static constexpr sint32_t smallest_pow10    = -65;  ///< Anything smaller is zero
+    static constexpr sint32_t largest_pow10     = 38;   ///< Anything larger is infinite
+    static constexpr sint32_t max_exact_pow10   = 10;   ///< 10^n is exact for n <= this
+    static constexpr uint64_t max_exact_digits  = uint64_t{1} << 24;
+};
+
+template <> struct fp_parse_traits<double> {
+    static constexpr sint32_t min_exponent      = -1023;
+    static constexpr sint32_t infinite_power    = 0x7FF;
+    static constexpr sint32_t min_round_even    = -4;
+    static constexpr sint32_t max_round_even    = 23;
+    static constexpr sint32_t smallest_pow10    = -342;
+    static constexpr sint32_t largest_pow10     = 308;
+    static constexpr sint32_t max_exact_pow10   = 22;
+    static constexpr uint64_t max_exact_digits  = uint64_t{1} << 53;
+};
+
+/// Returns 10^n, exactly, for 0 <= n <= fp_parse_traits<T>::max_exact_pow10
+template <class T>
+constexpr T fp_exact_pow10(sint64_t n) noexcept
+{
+    constexpr double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    return static_cast<T>(pow10[n]);
+}
+
+/// A binary result under construction: the raw mantissa and exponent fields
+struct fp_adjusted {
+    uint64_t    mantissa{0};        ///< Stored mantissa bits; may carry into the exponent
+    sint32_t    power2{0};          ///< Biased exponent
+
+    constexpr bool operator==(const fp_adjusted&) const noexcept = default;
+
+    /// Returns the IEEE bit pattern, less the sign
+    template <class T>
+    constexpr uint64_t raw() const noexcept
+    {
+        return mantissa | (static_cast<uint64_t>(power2) << fp_traits<T>::mantissa_bits);
+    }
+};
+
+// ---------------- Eisel-Lemire -------------------------------------------
+
+inline constexpr sint32_t lemire_min_pow10 = -342;
+inline constexpr sint32_t lemire_max_pow10 = 308;
+inline constexpr size_t   lemire_count     = lemire_max_pow10 - lemire_min_pow10 + 1;
+
+struct lemire_table_t {
+    uint64_t    pow5[lemire_count * 2]{};   ///< 5^q to 128 bits, MSB set: {high, low}
+};
+
+consteval lemire_table_t lemire_make_table()
+{
+    lemire_table_t t{};
+    size_t idx = 0;
+
+    // Negative powers are the reciprocal 2^b / 5^n, rounded up and then
+    // truncated. Repeated floor division is exact, as with the Ryu tables.
+    // We work up from 5^1 but the table wants 5^-342 first.
+    constexpr sint32_t scale = 1728;
+    fp_bigint inv{1};
+    inv.shift_left(scale);
+    uint128_t neg[-lemire_min_pow10 + 1]{};
+    for (sint32_t n = 1; n <= -lemire_min_pow10; ++n) {
+        inv.div_small(5);
+        const sint32_t b = (n <= 27) ? ryu_pow5bits(n) + 127 : 2 * ryu_pow5bits(n) + 128;
+        fp_bigint c{inv};
+        c.shift_right(static_cast<uint32_t>(scale - b));
+        c.add_small(1);
+        neg[n] = c.bits_at(static_cast<sint32_t>(c.bit_length()) - 128);
+    }
+    for (sint32_t n = -lemire_min_pow10; n >= 1; --n) {
+        t.pow5[idx++] = static_cast<uint64_t>(neg[n] >> 64);
+        t.pow5[idx++] = static_cast<uint64_t>(neg[n]);
+    }
+
+    fp_bigint p5{1};
+    for (sint32_t q = 0; q <= lemire_max_pow10; ++q) {
+        const auto len = static_cast<sint32_t>(p5.bit_length());
+        const uint128_t top = p5.bits_at(len - 128);
+        t.pow5[idx++] = static_cast<uint64_t>(top >> 64);
+        t.pow5[idx++] = static_cast<uint64_t>(top);
+        p5.mul_small(5);
+    }
+
+    return t;
+}
+
+inline constexpr lemire_table_t lemire_table = lemire_make_table();
+
+/// Returns floor(log2(10^q)) + 63; valid for -1233 <= q <= 1233
+constexpr sint32_t lemire_power(sint32_t q) noexcept
+    { return (((152170 + 65536) * q) >> 16) + 63; }
+
+/**
+ * @brief Returns w * 10^q rounded to the binary type
+ *
+ * The result is exact unless w has been truncated from a longer digit
+ * string, in which case it's the correctly rounded value of w * 10^q.
+ */
+template <class T>
+constexpr fp_adjusted lemire_compute(sint64_t q, uint64_t w) noexcept
+{
+    using traits  = fp_traits<T>;
+    using ptraits = fp_parse_traits<T>;
+
+    if (!w || (q < ptraits::smallest_pow10))
+        return {};
+    if (q > ptraits::largest_pow10)
+        return {0, ptraits::infinite_power};
+
+    const auto lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // Only go to the low half of the table when the bits that matter
+    // could be affected by it.
+    constexpr uint64_t precision_mask = ~uint64_t{0} >> (traits::mantissa_bits + 3);
+    const auto idx = 2 * static_cast<size_t>(q - lemire_min_pow10);
+    const uint128_t first = uint128_t{w} * lemire_table.pow5[idx];
+    auto hi = static_cast<uint64_t>(first >> 64);
+    auto lo = static_cast<uint64_t>(first);
+    if ((hi & precision_mask) == precision_mask) {
+        const auto second = static_cast<uint64_t>((uint128_t{w} * lemire_table.pow5[idx + 1]) >> 64);
+        lo += second;
+        if (second > lo)
+            ++hi;
+    }
+
+    const auto upper = static_cast<sint32_t>(hi >> 63);
+    const sint32_t shift = upper + 64 - traits::mantissa_bits - 3;
+
+    fp_adjusted ret;
+    ret.mantissa = hi >> shift;
+    ret.power2   = lemire_power(static_cast<sint32_t>(q)) + upper - lz - ptraits::min_exponent;
+
+    // Subnormal
+    if (ret.power2 <= 0) {
+        if (-ret.power2 + 1 >= 64)
+            return {};
+        ret.mantissa >>= -ret.power2 + 1;
+        ret.mantissa += ret.mantissa & 1;
+        ret.mantissa >>= 1;
+        ret.power2 = (ret.mantissa < (uint64_t{1} << traits::mantissa_bits)) ? 0 : 1;
+        return ret;
+    }
+
+    // Exactly halfway between two values; round to even rather than up
+    if ((lo <= 1) && (q >= ptraits::min_round_even) && (q <= ptraits::max_round_even) &&
+        ((ret.mantissa & 3) == 1) && ((ret.mantissa << shift) == hi))
+        ret.mantissa &= ~uint64_t{1};
+
+    ret.mantissa += ret.mantissa & 1;
+    ret.mantissa >>= 1;
+    if (ret.mantissa >= (uint64_t{2} << traits::mantissa_bits)) {
+        ret.mantissa = uint64_t{1} << traits::mantissa_bits;
+        ++ret.power2;
+    }
+    ret.mantissa &= ~(uint64_t{1} << traits::mantissa_bits);
+
+    if (ret.power2 >= ptraits::infinite_power)
+        return {0, ptraits::infinite_power};
+    return ret;
+}
+
+/**
+ * @brief Decides whether a long decimal rounds up from the given value
+ *
+ * Used when truncating the digits left the result in doubt: lower is the
+ * rounded value of the truncated digits and the true value is at most one
+ * ulp above it. The digits are compared exactly against the halfway point.
+ * No halfway point has more than 767 significant digits, so any beyond
+ * 768 only matter as to whether they're all zero.
+ *
+ * @param lower     The candidate value
+ * @param first     The first significant digit
+ * @param last      One past the last mantissa digit; a '.' may intervene
+ * @param lead_exp  The decimal exponent of the first significant digit
+ */
+template <class T>
+constexpr bool fp_round_up(fp_adjusted lower, const char* first, const char* last,
+    sint64_t lead_exp) noexcept
+{
+    using traits = fp_traits<T>;
+
+    // The halfway point above lower: (2m + 1) * 2^(e2 - 1)
+    uint64_t m = lower.mantissa;
+    sint64_t e2 = 1 - traits::bias - traits::mantissa_bits;
+    if (lower.power2) {
+        m |= uint64_t{1} << traits::mantissa_bits;
+        e2 = lower.power2 - traits::bias - traits::mantissa_bits;
+    }
+    fp_bigint half{2 * m + 1};
+    const sint64_t half_exp2 = e2 - 1;
+
+    // Gather the digits, nine at a time
+    constexpr size_t max_digits = 768;
+    fp_bigint digits;
+    size_t count = 0;
+    bool sticky = false;
+    uint32_t chunk = 0, chunk_mult = 1;
+    for (auto p = first; p != last; ++p) {
+        if (*p == '.')
+            continue;
+        const auto d = static_cast<uint32_t>(*p - '0');
+        if (count == max_digits) {
+            if (d) {
+                sticky = true;
+                break;
+            }
+            continue;
+        }
+        chunk = chunk * 10 + d;
+        chunk_mult *= 10;
+        ++count;
+        if (chunk_mult == 1000000000u) {
+            digits.mul_add_small(chunk_mult, chunk);
+            chunk = 0;
+            chunk_mult = 1;
+        }
+    }
+    if (chunk_mult > 1)
+        digits.mul_add_small(chunk_mult, chunk);
+
+    // digits * 10^exp10 vs half * 2^half_exp2: clear the fives, then the twos
+    const sint64_t exp10 = lead_exp - static_cast<sint64_t>(count) + 1;
+    if (exp10 >= 0)
+        digits.mul_pow5(static_cast<uint32_t>(exp10));
+    else
+        half.mul_pow5(static_cast<uint32_t>(-exp10));
+    if (exp10 > half_exp2)
+        digits.shift_left(static_cast<uint32_t>(exp10 - half_exp2));
+    else
+        half.shift_left(static_cast<uint32_t>(half_exp2 - exp10));
+
+    const int cmp = digits.compare(half);
+    if (cmp)
+        return cmp > 0;
+    return sticky || (m & 1);
+}
+
+// ---------------- Hexadecimal --------------------------------------------
+
+/**
+ * @brief Rounds mant * 2^exp2 to the binary type
+ *
+ * @param sticky    Set if there are non-zero bits below mant
+ */
+template <class T>
+constexpr fp_adjusted fp_assemble(uint64_t mant, sint64_t exp2, bool sticky) noexcept
+{
+    using traits  = fp_traits<T>;
+    using ptraits = fp_parse_traits<T>;
+
+    if (!mant)
+        return {};
+
+    constexpr sint64_t keep = traits::mantissa_bits + 1;
+    const sint64_t bits = 64 - __builtin_clzll(mant);
+    const sint64_t biased = exp2 + bits - 1 + traits::bias;
+    if (biased >= ptraits::infinite_power)
+        return {0, ptraits::infinite_power};
+
+    // Subnormals have fewer bits to work with
+    const sint64_t drop = bits - keep + ((biased <= 0) ? 1 - biased : 0);
+    if (drop > 64)
+        return {};
+
+    uint64_t m = mant;
+    if (drop > 0) {
+        const uint128_t wide = mant;
+        const uint128_t rem  = wide & ((uint128_t{1} << drop) - 1);
+        const uint128_t half = uint128_t{1} << (drop - 1);
+        m = static_cast<uint64_t>(wide >> drop);
+        if ((rem > half) || ((rem == half) && (sticky || (m & 1))))
+            ++m;
+    }
+    else
+        m <<= -drop;
+
+    if (biased <= 0)
+        return {m, 0};      // Rounding may carry into the normal range
+
+    fp_adjusted ret{m, static_cast<sint32_t>(biased)};
+    if (ret.mantissa >= (uint64_t{2} << traits::mantissa_bits)) {
+        ret.mantissa >>= 1;
+        if (++ret.power2 >= ptraits::infinite_power)
+            return {0, ptraits::infinite_power};
+    }
+    ret.mantissa &= ~(uint64_t{1} << traits::mantissa_bits);
+    return ret;
+}
+
+// ---------------- Parsing ------------------------------------------------
+
+constexpr bool fp_is_digit(char ch) noexcept
+    { return static_cast<unsigned char>(ch - '0') < 10; }
+
+constexpr sint32_t fp_hex_digit(char ch) noexcept
+{
+    if (fp_is_digit(ch))
+        return ch - '0';
+    const char lower = static_cast<char>(ch | 0x20);
+    return ((lower >= 'a') && (lower <= 'f')) ? lower - 'a' + 10 : -1;
+}
+
+/// Case-insensitive match of a lowercase word at the front of [at, end)
+constexpr bool fp_match_word(const char* at, const char* end, string_view word) noexcept
+{
+    if (static_cast<size_t>(end - at) < word.length())
+        return false;
+    for (size_t i = 0; i < word.length(); ++i) {
+        if (static_cast<char>(at[i] | 0x20) != word[i])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses an optional exponent: a marker, optional sign, and digits
+ *
+ * The exponent saturates rather than overflowing. If there are no digits
+ * nothing is consumed.
+ *
+ * @return Returns true if an exponent was parsed
+ */
+constexpr bool fp_parse_exponent(const char*& at, const char* end, char marker,
+    sint64_t& exponent) noexcept
+{
+    auto p = at;
+    if ((p == end) || ((*p | 0x20) != marker))
+        return false;
+    ++p;
+
+    bool negative = false;
+    if ((p != end) && ((*p == '-') || (*p == '+')))
+        negative = (*p++ == '-');
+    if ((p == end) || !fp_is_digit(*p))
+        return false;
+
+    sint64_t val = 0;
+    for (; (p != end) && fp_is_digit(*p); ++p) {
+        if (val < 0x10000000)
+            val = val * 10 + (*p - '0');
+    }
+
+    exponent = negative ? -val : val;
+    at = p;
+    return true;
+}
+
+/**
+ * @brief Sets value from the IEEE bits of a positive result
+ *
+ * A non-zero input that rounded to zero or infinity is out of range, in
+ * which case value is not updated.
+ */
+template <class T>
+constexpr error_code fp_finish(uint64_t raw, bool nonzero, T& value) noexcept
+{
+    using traits = fp_traits<T>;
+
+    constexpr uint64_t inf_bits = uint64_t{fp_parse_traits<T>::infinite_power} << traits::mantissa_bits;
+    if (nonzero && ((raw == 0) || (raw == inf_bits)))
+        return error_code::out_of_range;
+
+    value = bit_cast<T>(static_cast<typename traits::uint_type>(raw));
+    return error_code::no_error;
+}
+
+/// Parses hexadecimal digits with an optional binary exponent (no prefix)
+template <class T>
+constexpr error_code fp_parse_hex(const char*& at, const char* end, T& value) noexcept
+{
+    uint64_t mant = 0;
+    sint64_t exp2 = 0;
+    bool sticky = false, matched = false;
+    size_t taken = 0;               // Significant hex digits in mant
+
+    auto p = at;
+    for (sint32_t d; (p != end) && ((d = fp_hex_digit(*p)) >= 0); ++p) {
+        matched = true;
+        if (taken < 16) {
+            if (mant || d) {
+                mant = (mant << 4) | static_cast<uint64_t>(d);
+                ++taken;
+            }
+        }
+        else {
+            exp2 += 4;
+            sticky |= (d != 0);
+        }
+    }
+    if ((p != end) && (*p == '.')) {
+        for (sint32_t d; (++p != end) && ((d = fp_hex_digit(*p)) >= 0); ) {
+            matched = true;
+            if (taken < 16) {
+                if (mant || d) {
+                    mant = (mant << 4) | static_cast<uint64_t>(d);
+                    ++taken;
+                }
+                exp2 -= 4;
+            }
+            else
+                sticky |= (d != 0);
+        }
+    }
+    if (!matched)
+        return error_code::bad_parameter;
+
+    sint64_t exponent = 0;
+    fp_parse_exponent(p, end, 'p', exponent);
+    at = p;
+
+    return fp_finish(fp_assemble<T>(mant, exp2 + exponent, sticky).template raw<T>(), mant != 0, value);
+}
+
+/// Parses decimal digits with an optional exponent, as allowed by fmt
+template <class T>
+constexpr error_code fp_parse_dec(const char*& at, const char* end, chars_format fmt,
+    T& value) noexcept
+{
+    using ptraits = fp_parse_traits<T>;
+
+    constexpr size_t max_taken = 19;    // Always fits in uint64_t
+
+    uint64_t w = 0;
+    sint64_t exp10 = 0;
+    size_t taken = 0;
+    bool truncated = false, matched = false;
+    const char* sig_first = nullptr;
+
+    // Integer part, then fraction
+    auto p = at;
+    for (; (p != end) && fp_is_digit(*p); ++p) {
+        matched = true;
+        const auto d = static_cast<uint64_t>(*p - '0');
+        if (taken < max_taken) {
+            if (w || d) {
+                if (!w)
+                    sig_first = p;
+                w = w * 10 + d;
+                ++taken;
+            }
+        }
+        else {
+            ++exp10;
+            truncated |= (d != 0);
+        }
+    }
+    if ((p != end) && (*p == '.')) {
+        while ((++p != end) && fp_is_digit(*p)) {
+            matched = true;
+            const auto d = static_cast<uint64_t>(*p - '0');
+            if (taken < max_taken) {
+                if (w || d) {
+                    if (!w)
+                        sig_first = p;
+                    w = w * 10 + d;
+                    ++taken;
+                }
+                --exp10;
+            }
+            else
+                truncated |= (d != 0);
+        }
+    }
+    if (!matched)
+        return error_code::bad_parameter;
+    const auto mant_end = p;
+
+    // Fixed takes no exponent; scientific requires one
+    sint64_t exponent = 0;
+    if ((fmt != chars_format::fixed) && !fp_parse_exponent(p, end, 'e', exponent) &&
+        (fmt == chars_format::scientific))
+        return error_code::bad_parameter;
+    at = p;
+
+    if (!w) {
+        value = T{};
+        return error_code::no_error;
+    }
+
+    const sint64_t q = exp10 + exponent;
+
+    // Clinger: both operands exact so a single operation rounds correctly.
+    // Failing that, a few of the excess powers may fit in the digits.
+    if (!truncated && (w <= ptraits::max_exact_digits) &&
+        (q >= -ptraits::max_exact_pow10) && (q <= 2 * ptraits::max_exact_pow10)) {
+        if (q < 0) {
+            value = static_cast<T>(w) / fp_exact_pow10<T>(-q);
+            return error_code::no_error;
+        }
+        uint64_t w_use = w;
+        sint64_t q_use = q;
+        for (; q_use > ptraits::max_exact_pow10 && w_use <= ptraits::max_exact_digits; --q_use)
+            w_use *= 10;
+        if (w_use <= ptraits::max_exact_digits) {
+            value = static_cast<T>(w_use) * fp_exact_pow10<T>(q_use);
+            return error_code::no_error;
+        }
+    }
+
+    const fp_adjusted adj = lemire_compute<T>(q, w);
+    uint64_t raw = adj.raw<T>();
+
+    // If the discarded digits could change the outcome, settle it exactly
+    if (truncated && (adj != lemire_compute<T>(q, w + 1)))
+        raw += fp_round_up<T>(adj, sig_first, mant_end, q + max_taken - 1) ? 1 : 0;
+
+    return fp_finish(raw, true, value);
+}
+
+/**
+ * @brief Parses a floating-point value from [at, end)
+ *
+ * Accepts an optional sign, then inf, infinity, nan, nan(chars), or a
+ * number in the given style. Hexadecimal is parsed when fmt is hex (the
+ * 0x prefix is optional) or when the number has a 0x prefix.
+ *
+ * On success and on out_of_range at is moved past the text that was
+ * parsed. value is only updated on success.
+ */
+template <class T>
+constexpr error_code fp_parse(const char*& at, const char* end, chars_format fmt, T& value) noexcept
+{
+    using traits = fp_traits<T>;
+
+    constexpr uint64_t inf_bits = uint64_t{fp_parse_traits<T>::infinite_power} << traits::mantissa_bits;
+
+    auto p = at;
+    const bool negative = (p != end) && (*p == '-');
+    if ((p != end) && ((*p == '-') || (*p == '+')))
+        ++p;
+
+    T mag{};
+    error_code ec{};
+    if (fp_match_word(p, end, "inf")) {
+        p += fp_match_word(p, end, "infinity") ? 8 : 3;
+        fp_finish(inf_bits, false, mag);
+    }
+    else if (fp_match_word(p, end, "nan")) {
+        p += 3;
+        // Optional (n-char-sequence), ignored
+        if ((p != end) && (*p == '(')) {
+            auto q = p + 1;
+            while ((q != end) && (char_traits<char>::is_alnum(*q) || (*q == '_')))
+                ++q;
+            if ((q != end) && (*q == ')'))
+                p = q + 1;
+        }
+        fp_finish(inf_bits | (uint64_t{1} << (traits::mantissa_bits - 1)), false, mag);
+    }
+    else {
+        const bool have_prefix = (end - p > 2) && (p[0] == '0') && ((p[1] | 0x20) == 'x') &&
+            ((fp_hex_digit(p[2]) >= 0) || ((p[2] == '.') && (end - p > 3) && (fp_hex_digit(p[3]) >= 0)));
+
+        if ((fmt == chars_format::hex) || have_prefix) {
+            if (have_prefix)
+                p += 2;
+            ec = fp_parse_hex(p, end, mag);
+        }
+        else
+            ec = fp_parse_dec(p, end, fmt, mag);
+
+        if (ec == error_code::bad_parameter)
+            return ec;
+    }
+
+    at = p;
+    if (!is_error(ec))
+        value = negative ? -mag : mag;
+    return ec;
+}
+
+}   // end namespace imp
+
+_SYS_END_NS
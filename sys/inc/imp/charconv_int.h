@@ -0,0 +1,465 @@
+/**
+ * @file    charconv_int.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Integer to and from text conversion internals
+ *
+ * The length of the output is worked out first so that digits can be
+ * written directly into place from the right; there's no reversing
+ * afterwards. Decimal goes two digits per division using a table of
+ * digit pairs, and power-of-two radices need only shifts and masks.
+ * 128-bit values are split into 64-bit chunks of 19 decimal digits so
+ * that the work is done with native 64-bit arithmetic.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <_core_.h>
+#include <type_traits_.h>
+#include <limits_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// "00" through "99"
+inline constexpr char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/// Digits for radices up to 36
+inline constexpr char radix_digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/// The unsigned integer type with the same size as T
+template <class T>
+using uint_of_size_t =
+    conditional_t<sizeof(T) == 1, uint8_t,
+    conditional_t<sizeof(T) == 2, uint16_t,
+    conditional_t<sizeof(T) == 4, uint32_t,
+    conditional_t<sizeof(T) == 8, uint64_t, uint128_t>>>>;
+
+/// Returns the number of significant bits in val; 1 for 0
+template <class U>
+constexpr size_t uint_bit_width(U val) noexcept
+{
+    if constexpr (sizeof(U) > sizeof(uint64_t)) {
+        const auto hi = static_cast<uint64_t>(val >> 64);
+        if (hi)
+            return static_cast<size_t>(128 - __builtin_clzll(hi));
+    }
+    return static_cast<size_t>(64 - __builtin_clzll(static_cast<uint64_t>(val) | 1));
+}
+
+/// Powers of ten that fit in 64 bits
+inline constexpr uint64_t pow10_u64[] = {
+    1ull,                   10ull,                  100ull,
+    1000ull,                10000ull,               100000ull,
+    1000000ull,             10000000ull,            100000000ull,
+    1000000000ull,          10000000000ull,         100000000000ull,
+    1000000000000ull,       10000000000000ull,      100000000000000ull,
+    1000000000000000ull,    10000000000000000ull,   100000000000000000ull,
+    1000000000000000000ull, 10000000000000000000ull
+};
+
+/// Most decimal digits that always fit in 64 bits
+inline constexpr size_t chunk_digits10 = 19;
+
+/// Returns the number of decimal digits in val; 1 for 0
+constexpr size_t count_digits10(uint64_t val) noexcept
+{
+    // 1233/4096 is just over log10(2), so this is either the digit count
+    // or one less
+    const size_t guess = (uint_bit_width(val) * 1233) >> 12;
+    return guess + ((val | 1) >= pow10_u64[guess]);
+}
+
+/**
+ * @brief Writes the decimal digits of val so that they end at last
+ *
+ * Eight digits are split off at a time, and then written in pairs, to
+ * keep the chain of dependent divisions short.
+ *
+ * @return Returns a pointer to the first digit written
+ */
+constexpr char* put_dec_backward(char* last, uint64_t val) noexcept
+{
+    auto put_pair = [&last](uint32_t pair) {
+        last -= 2;
+        last[0] = digit_pairs[pair << 1];
+        last[1] = digit_pairs[(pair << 1) + 1];
+    };
+
+    while (val >= 100000000) {
+        const auto chunk = static_cast<uint32_t>(val % 100000000);
+        val /= 100000000;
+        const uint32_t hi = chunk / 10000, lo = chunk % 10000;
+        put_pair(lo % 100);
+        put_pair(lo / 100);
+        put_pair(hi % 100);
+        put_pair(hi / 100);
+    }
+
+    auto rest = static_cast<uint32_t>(val);
+    for (; rest >= 100; rest /= 100)
+        put_pair(rest % 100);
+    if (rest >= 10)
+        put_pair(rest);
+    else
+        *--last = static_cast<char>('0' + rest);
+
+    return last;
+}
+
+/// Writes exactly count decimal digits of val, zero-padded, ending at last
+constexpr char* put_dec_backward(char* last, uint64_t val, size_t count) noexcept
+{
+    char* first = last - count;
+    for (char* at = put_dec_backward(last, val); at != first; )
+        *--at = '0';
+    return first;
+}
+
+/// Writes a 128-bit value in decimal; see uint_to_chars
+constexpr char* uint128_to_dec(char* begin, char* end, uint128_t val) noexcept
+{
+    constexpr uint64_t chunk_div = pow10_u64[chunk_digits10];
+
+    // Split into 19-digit chunks; there are at most three
+    uint64_t chunks[3]{};
+    size_t count = 0;
+    do {
+        chunks[count++] = static_cast<uint64_t>(val % chunk_div);
+        val /= chunk_div;
+    } while (val);
+
+    const size_t len = count_digits10(chunks[count - 1]) + (count - 1) * chunk_digits10;
+    if (len > static_cast<size_t>(end - begin))
+        return nullptr;
+
+    char* at = begin + len;
+    for (size_t i = 0; i + 1 < count; ++i)
+        at = put_dec_backward(at, chunks[i], chunk_digits10);
+    put_dec_backward(at, chunks[count - 1]);
+    return begin + len;
+}
+
+/**
+ * @brief Writes an unsigned value in the given radix
+ *
+ * @return Returns one past the last char written, or nullptr if the
+ *  value doesn't fit in [begin, end)
+ */
+template <class U>
+constexpr char* uint_to_chars(char* begin, char* end, U val, unsigned radix) noexcept
+{
+    const auto room = static_cast<size_t>(end - begin);
+
+    if (radix == 10) {
+        if constexpr (sizeof(U) > sizeof(uint64_t)) {
+            if (val >> 64)
+                return uint128_to_dec(begin, end, val);
+        }
+        const auto val64 = static_cast<uint64_t>(val);
+        const size_t len = count_digits10(val64);
+        if (len > room)
+            return nullptr;
+        put_dec_backward(begin + len, val64);
+        return begin + len;
+    }
+
+    // Power-of-two radix: each digit is a fixed number of bits
+    if (!(radix & (radix - 1))) {
+        const auto shift = static_cast<unsigned>(__builtin_ctz(radix));
+        const size_t len = (uint_bit_width(val) + shift - 1) / shift;
+        if (len > room)
+            return nullptr;
+
+        const U mask = static_cast<U>(radix - 1);
+        char* at = begin + len;
+        do {
+            *--at = radix_digits[val & mask];
+            val = static_cast<U>(val >> shift);
+        } while (val);
+        return begin + len;
+    }
+
+    // Anything else: one division per digit into a scratch buffer sized
+    // for the worst case (base 3)
+    char buf[sizeof(U) * 8];
+    char* first = buf + sizeof(buf);
+    const U radix_u = static_cast<U>(radix);
+    do {
+        *--first = radix_digits[val % radix_u];
+        val = static_cast<U>(val / radix_u);
+    } while (val);
+
+    const auto len = static_cast<size_t>(buf + sizeof(buf) - first);
+    if (len > room)
+        return nullptr;
+    for (size_t i = 0; i < len; ++i)
+        begin[i] = first[i];
+    return begin + len;
+}
+
+/**
+ * @brief Parses decimal digits into a 128-bit value
+ *
+ * Up to 19 digits at a time are gathered with 64-bit arithmetic and then
+ * folded into the result; the first two chunks can't overflow so only
+ * longer input pays for overflow checks.
+ *
+ * @param at    The first char to parse; on return the first char not used
+ * @param limit The largest value allowed; no less than 10^38
+ *
+ * @return Returns false if the value would exceed limit, in which case
+ *  at refers to the digit that took it over
+ */
+constexpr bool uint128_from_dec(const char*& at, const char* end, uint128_t& val,
+    uint128_t limit) noexcept
+{
+    auto is_digit = [](char ch) { return static_cast<unsigned char>(ch - '0') < 10; };
+
+    uint128_t acc = 0;
+    size_t chunks = 0;
+    auto p = at;
+    while ((p != end) && is_digit(*p)) {
+        const auto first = p;
+        const auto stop  = (static_cast<size_t>(end - p) > chunk_digits10) ? p + chunk_digits10 : end;
+        uint64_t chunk = 0;
+        for (; (p != stop) && is_digit(*p); ++p)
+            chunk = chunk * 10 + static_cast<uint64_t>(*p - '0');
+        const auto len = static_cast<size_t>(p - first);
+
+        // Two chunks are less than 10^38 so can't overflow
+        uint128_t next;
+        if (++chunks <= 2)
+            next = acc * pow10_u64[len] + chunk;
+        else if (multiply_overflow(acc, pow10_u64[len], next) ||
+            add_overflow(next, chunk, next) || (next > limit)) {
+            // Find the digit that put us over
+            for (p = first; !multiply_overflow(acc, 10u, acc) &&
+                !add_overflow(acc, static_cast<unsigned>(*p - '0'), acc) && (acc <= limit); ++p)
+                ;
+            at = p;
+            return false;
+        }
+        acc = next;
+
+        if (len < chunk_digits10)
+            break;
+    }
+
+    at = p;
+    val = acc;
+    return true;
+}
+
+// ---------------- SWAR parsing --------------------------------------------
+//
+// Eight chars are loaded into a uint64_t and validated and converted
+// together. The first char is in the low byte, so these are only used
+// on little-endian targets and never during constant evaluation.
+
+inline constexpr bool swar_enabled = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+inline constexpr uint64_t swar_ones = 0x0101010101010101ull;
+
+/// Loads eight chars; not for constant evaluation
+inline uint64_t swar_load(const char* p) noexcept
+{
+    uint64_t word;
+    __builtin_memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/// Flags (with 0x80) each byte of the word that is in [lo, hi]
+constexpr uint64_t swar_in_range(uint64_t word, uint8_t lo, uint8_t hi) noexcept
+{
+    // Working on seven bits with the eighth set aside means no borrows
+    // cross into the next byte
+    const uint64_t high_bits = swar_ones * 0x80;
+    const uint64_t low7 = word & (swar_ones * 0x7F);
+    const uint64_t ge_lo = (low7 | high_bits) - swar_ones * lo;
+    const uint64_t le_hi = (swar_ones * (0x80u | hi)) - low7;
+    return ge_lo & le_hi & ~word & high_bits;
+}
+
+/// Returns the number of leading flagged bytes (0 to 8)
+constexpr size_t swar_leading(uint64_t flags) noexcept
+{
+    const uint64_t unflagged = ~flags & (swar_ones * 0x80);
+    return unflagged ? static_cast<size_t>(__builtin_ctzll(unflagged)) >> 3 : 8;
+}
+
+/// Returns the number of leading decimal digit chars in the word (0 to 8)
+constexpr size_t swar_dec_len(uint64_t word) noexcept
+    { return swar_leading(swar_in_range(word, '0', '9')); }
+
+/// Returns the value of the eight decimal digit chars in the word
+constexpr uint32_t swar_dec_value(uint64_t word) noexcept
+{
+    word -= swar_ones * '0';
+    word = (word * 10) + (word >> 8);       // Pairs
+    word = (((word & 0x000000FF000000FFull) * 0x000F424000000064ull) +
+        (((word >> 16) & 0x000000FF000000FFull) * 0x0000271000000001ull)) >> 32;
+    return static_cast<uint32_t>(word);
+}
+
+/// Returns the number of leading hex digit chars in the word (0 to 8)
+constexpr size_t swar_hex_len(uint64_t word) noexcept
+{
+    return swar_leading(swar_in_range(word, '0', '9') |
+        swar_in_range(word | (swar_ones * 0x20), 'a', 'f'));
+}
+
+/// Returns the value of the eight hex digit chars in the word
+constexpr uint32_t swar_hex_value(uint64_t word) noexcept
+{
+    // Letters have 0x40 set; they're worth 9 more than their low nibble
+    word = (word & (swar_ones * 0x0F)) + ((word >> 6) & swar_ones) * 9;
+
+    // Gather the nibbles, first char most significant
+    word = ((word & 0x00FF00FF00FF00FFull) << 4) | ((word >> 8) & 0x00FF00FF00FF00FFull);
+    word = ((word & 0x0000FFFF0000FFFFull) << 8) | ((word >> 16) & 0x0000FFFF0000FFFFull);
+    word = ((word & 0x00000000FFFFFFFFull) << 16) | (word >> 32);
+    return static_cast<uint32_t>(word);
+}
+
+/**
+ * @brief Parses decimal or hex digits, eight at a time
+ *
+ * Overflow is checked once per group of eight. Not for constant
+ * evaluation.
+ *
+ * @param at    The first char to parse; on return the first char not used
+ * @param radix 10 or 16
+ * @param limit The largest value allowed
+ *
+ * @return Returns false if the value would exceed limit, in which case
+ *  at refers to the digit that took it over
+ */
+template <class U>
+inline bool uint_from_chars_swar(const char*& at, const char* end, unsigned radix,
+    U& val, U limit) noexcept
+{
+    // Small types are gathered in 64 bits and checked against limit
+    using acc_type = conditional_t<(sizeof(U) > sizeof(uint64_t)), uint128_t, uint64_t>;
+
+    const bool hex = (radix == 16);
+    auto digit = [](char ch) -> unsigned {
+        const auto dec = static_cast<unsigned>(static_cast<unsigned char>(ch - '0'));
+        return (dec < 10) ? dec : static_cast<unsigned>((ch | 0x20) - 'a') + 10;
+    };
+
+    acc_type acc = 0;
+    const auto first = at;
+    auto p = at;
+    while (p != end) {
+        // Load the next eight chars. Near the end, load the last eight
+        // in the view and shift off what we've already seen; the bytes
+        // coming in at the top are zero, which isn't a digit.
+        const auto avail = static_cast<size_t>(end - p);
+        uint64_t word = 0;
+        if (avail >= 8)
+            word = swar_load(p);
+        else if (end - first >= 8)
+            word = swar_load(end - 8) >> ((8 - avail) << 3);
+        else {
+            for (size_t i = 0; i < avail; ++i)
+                word |= uint64_t{static_cast<unsigned char>(p[i])} << (i << 3);
+        }
+
+        const size_t len = hex ? swar_hex_len(word) : swar_dec_len(word);
+        if (!len)
+            break;
+
+        // Move the digits to the end of the word behind leading zeros
+        if (len < 8) {
+            const auto pad = static_cast<unsigned>(8 - len) << 3;
+            word = (word << pad) | ((swar_ones * '0') >> (64 - pad));
+        }
+
+        const acc_type mult = hex ? acc_type{1} << (len << 2) : pow10_u64[len];
+        acc_type next;
+        if (multiply_overflow(acc, mult, next) ||
+            add_overflow(next, hex ? swar_hex_value(word) : swar_dec_value(word), next) ||
+            (next > limit)) {
+            // Find the digit that put us over
+            for (; !multiply_overflow(acc, radix, acc) && !add_overflow(acc, digit(*p), acc) &&
+                (acc <= limit); ++p)
+                ;
+            at = p;
+            return false;
+        }
+
+        acc = next;
+        p += len;
+        if (len < 8)
+            break;
+    }
+
+    at = p;
+    val = static_cast<U>(acc);
+    return true;
+}
+
+/**
+ * @brief Parses decimal digits into a uint64_t, tuned for short runs
+ *
+ * Up to seven digits take a single load and no loop, and up to fifteen
+ * take two; only a run longer than sixteen digits checks for overflow.
+ * Not for constant evaluation.
+ *
+ * @param at    The first char to parse; on return the first char not used
+ *
+ * @return Returns false if the value doesn't fit in 64 bits
+ */
+inline bool dec_u64_from_chars_swar(const char*& at, const char* end, uint64_t& val) noexcept
+{
+    const char* p = at;
+    uint64_t acc = 0;
+    for (int i = 0; i < 2; ++i) {
+        const auto avail = static_cast<size_t>(end - p);
+        uint64_t word = 0;
+        if (avail >= 8)
+            word = swar_load(p);
+        else {
+            for (size_t k = 0; k < avail; ++k)
+                word |= uint64_t{static_cast<unsigned char>(p[k])} << (k << 3);
+        }
+
+        const size_t len = swar_dec_len(word);
+        if (len < 8) {
+            // Move the digits to the end of the word behind leading zeros
+            if (len) {
+                const auto pad = static_cast<unsigned>(8 - len) << 3;
+                word = (word << pad) | ((swar_ones * '0') >> (64 - pad));
+                acc = acc * pow10_u64[len] + swar_dec_value(word);
+            }
+            at = p + len;
+            val = acc;
+            return true;
+        }
+
+        acc = acc * 100000000u + swar_dec_value(word);
+        p += 8;
+    }
+
+    // Sixteen digits so far
+    for (; (p != end) && (static_cast<unsigned char>(*p - '0') < 10); ++p) {
+        if (multiply_overflow(acc, 10u, acc) || add_overflow(acc, static_cast<unsigned>(*p - '0'), acc)) {
+            at = p;
+            return false;
+        }
+    }
+
+    at = p;
+    val = acc;
+    return true;
+}
+
+}   // end namespace imp
+
+_SYS_END_NS
@@ -1,7 +1,7 @@
 /**
  * @file    fmt_buf.h
  * @author  Mike DeKoker (dekoker.mike@gmail.com)
- * @brief   Declares sys::imp::format_buf; stack buffer that grows into heap buffer
+ * @brief   Declares sys::imp::format_buf; per-thread scratch buffer for formatting
  *
  * @copyright Copyright (c) 2023
  *
@@ -16,6 +16,35 @@
 _SYS_BEGIN_NS
 namespace imp {
 
+/// Per-thread formatting scratch storage; see fmt_buf
+struct fmt_scratch
+{
+    /// Scratch buffers larger than this are freed rather than kept
+    static constexpr size_t max_keep = 32 * 1024;
+
+    ~fmt_scratch() { delete[] data; }
+
+    char*   data{nullptr};
+    size_t  capacity{0};
+    bool    in_use{false};
+};
+
+/// Returns the calling thread's formatting scratch storage
+fmt_scratch& fmt_thread_scratch() noexcept;
+
+/**
+ * @brief Output buffer for formatting a string
+ *
+ * Output is rendered into the calling thread's scratch buffer, which is
+ * kept between calls, and release_string() then copies it into a string
+ * with a single allocation of exactly the right size (or none at all if
+ * it fits in the string's SSO buffer). A scratch buffer that grew beyond
+ * fmt_scratch::max_keep is freed when we're done with it.
+ *
+ * If the scratch buffer is already in use (e.g., a formatter that itself
+ * calls format) we start out in InitCapacity chars of local storage, and
+ * only go to the heap if the output outgrows that.
+ */
 template <size_t InitCapacity = 512>
 class fmt_buf
 {
@@ -25,47 +54,157 @@ public:
     using size_type      = string::size_type;
     using value_type     = string::value_type;
 
-    fmt_buf() = default;
+    fmt_buf() noexcept
+    {
+        auto& scratch = fmt_thread_scratch();
+        if (!scratch.in_use) {
+            scratch.in_use = true;
+            _scratch = &scratch;
+            _buf = scratch.data;
+            _cap = scratch.capacity;
+        }
+        else {
+            _buf = _local;
+            _cap = InitCapacity;
+        }
+    }
+
+    fmt_buf(const fmt_buf&) = delete;
+    fmt_buf& operator=(const fmt_buf&) = delete;
 
-    constexpr void push_back(char_t ch)
+    ~fmt_buf()
     {
-        if (!_have_str) {
-            if (_auto_len < InitCapacity) {
-                _auto_buf[_auto_len++] = ch;
-                return;
-            }
-
-            // We generally double capacity when growing, so we'll do that
-            // here, too.
-            size_type new_cap;
-            auto overflowed = add_overflow(InitCapacity, InitCapacity*2, new_cap);
-            if (overflowed || (new_cap > string::max_size())) [[unlikely]]
-                new_cap = string::max_size();
-            _str.reserve(new_cap);
-            _str.assign(_auto_buf, InitCapacity);
-            _have_str = true;
-
-            // Fall through
+        if (!_scratch) {
+            if (_buf != _local)
+                delete[] _buf;
+            return;
         }
 
-        _str.push_back(ch);
+        // Hand the (possibly grown) buffer back unless it's gotten too big
+        if (_cap > fmt_scratch::max_keep) {
+            delete[] _buf;
+            _buf = nullptr;
+            _cap = 0;
+        }
+        _scratch->data = _buf;
+        _scratch->capacity = _cap;
+        _scratch->in_use = false;
     }
 
-    constexpr string&& release_string()
+    constexpr void push_back(char_t ch)
     {
-        if (!_have_str && _auto_len)
-            _str.assign(_auto_buf, _auto_len);
+        if (_len == _cap)
+            grow(1);
 
-        return sys::move(_str);
+        _buf[_len++] = ch;
+    }
+
+    /// Append a contiguous run of chars
+    constexpr void append(const char_t* s, size_type count)
+    {
+        if (count > _cap - _len)
+            grow(count);
+
+        string::traits_t::copy(_buf + _len, s, count);
+        _len += count;
+    }
+
+    /// Returns the output as a string
+    string release_string() const
+    {
+        return string(_buf, _len);
     }
 
 private:
 
-    char_t      _auto_buf[InitCapacity];
-    size_type   _auto_len{0};
+    /// Grow the buffer so it has room for count more chars
+    constexpr void grow(size_type count)
+    {
+        // We generally double capacity when growing, so we'll do that
+        // here, too.
+        size_type new_cap;
+        auto overflowed = multiply_overflow(_cap ? _cap : InitCapacity / 2, 2, new_cap);
+        if (overflowed || (new_cap > string::max_size())) [[unlikely]]
+            new_cap = string::max_size();
+        if (new_cap - _len < count) {
+            if (count > string::max_size() - _len) [[unlikely]]
+                throw_error_length();
+            new_cap = _len + count;
+        }
+
+        char_t* new_buf = new char_t[new_cap];
+        string::traits_t::copy(new_buf, _buf, _len);
+        if (_buf != _local)
+            delete[] _buf;
+        _buf = new_buf;
+        _cap = new_cap;
+    }
+
+    char_t*         _buf{nullptr};
+    size_type       _len{0};
+    size_type       _cap{0};
+    fmt_scratch*    _scratch{nullptr};  // Set if we borrowed thread's scratch
+    char_t          _local[InitCapacity];   // Used if we didn't
+};
+
+/**
+ * @brief Output iterator over a fixed-size char buffer
+ *
+ * Chars beyond the end of the buffer are counted but not stored, so the
+ * full formatted length is known even when output is truncated. Never
+ * allocates.
+ */
+class fmt_bounded_iterator
+{
+public:
+
+    using iterator_category = tag_iterator_output;
+    using value_type        = void;
+    using difference_type   = sys::ptrdiff_t;
+    using pointer           = void;
+    using reference         = void;
+    using container_type    = void;
+
+    constexpr fmt_bounded_iterator(char* out, size_t avail) noexcept
+        : _out(out), _avail(avail)
+    {}
+
+    constexpr fmt_bounded_iterator& operator=(char ch) noexcept
+    {
+        if (_avail) {
+            *_out++ = ch;
+            --_avail;
+        }
+        ++_count;
+        return *this;
+    }
+
+    /// Append a contiguous run of chars
+    constexpr fmt_bounded_iterator& append(const char* s, size_t count) noexcept
+    {
+        const size_t n = (count < _avail) ? count : _avail;
+        string::traits_t::copy(_out, s, n);
+        _out += n;
+        _avail -= n;
+        _count += count;
+        return *this;
+    }
+
+    constexpr fmt_bounded_iterator& operator*()     noexcept { return *this; }
+    constexpr fmt_bounded_iterator& operator++()    noexcept { return *this; }
+    constexpr fmt_bounded_iterator& operator++(int) noexcept { return *this; }
+
+    /// Returns one past the last char stored
+    constexpr char* get_out() const noexcept { return _out; }
+
+    /// Returns the number of chars output, including any not stored
+    constexpr size_t get_count() const noexcept { return _count; }
+
+private:
 
-    bool        _have_str{false};       // placeholder for optional bool
-    string      _str;                   // TODO: optional<string>
+    char*   _out;
+    size_t  _avail;
+    size_t  _count{0};
 };
 
 } // end namespace imp
@@ -0,0 +1,153 @@
+/**
+ * @file    fmt_compiled.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Format strings compiled at run time: sys::compiled_format
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <vector_.h>
+#include <memory_.h>
+#include "fmt_core.h"
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// A parsed formatter kept by a fmt_dyn_plan
+struct fmt_kept_base
+{
+    virtual ~fmt_kept_base() = default;
+};
+
+template <class Formatter>
+struct fmt_kept final : public fmt_kept_base
+{
+    explicit fmt_kept(const Formatter& f) : fmt(f) {}
+
+    Formatter fmt;
+};
+
+/**
+ * @brief A format string compiled at run time
+ *
+ * Same layout as fmt_plan, but with no limit on the number of segments.
+ * Fields that format a user-defined type keep a copy of their parsed
+ * formatter, whatever state it has, so they're never parsed again.
+ */
+struct fmt_dyn_plan
+{
+    static constexpr size_t no_field = size_t(-1);
+
+    /// Add a literal-only segment
+    void add_segment(size_t lit_pos, size_t lit_len)
+    {
+        segs.push_back(fmt_plan_seg{lit_pos, lit_len, no_field});
+    }
+
+    /// Add a segment that ends with a replacement field
+    void add_segment(size_t lit_pos, size_t lit_len, const fmt_plan_field& fld)
+    {
+        segs.push_back(fmt_plan_seg{lit_pos, lit_len, fields.size()});
+        fields.push_back(fmt_plan_field{fld});
+        kept.push_back(sys::move(_pending));
+    }
+
+    /// Keep a parsed formatter for the field about to be added
+    template <class Formatter>
+    void keep(const Formatter& f)
+    {
+        _pending.reset(new fmt_kept<Formatter>(f));
+    }
+
+    sys::vector<fmt_plan_seg>                   segs;
+    sys::vector<fmt_plan_field>                 fields;
+    sys::vector<unique_ptr<fmt_kept_base>>      kept;       ///< Per field; may be null
+
+private:
+
+    unique_ptr<fmt_kept_base>   _pending;
+};
+
+}   // end namespace imp
+
+/**
+ * @brief A format string compiled at run time for the given argument types
+ *
+ * Use this for format strings that aren't known at compile time (e.g.,
+ * they come from configuration). The string is validated and broken into
+ * segments once, on construction, along with the parsed formatter state
+ * of each replacement field; format() and format_to() then just execute
+ * the plan. Throws error_format if the format string is invalid.
+ *
+ * A compiled_format is not modified by formatting, so one object may be
+ * used by any number of threads at once.
+ */
+template <class... FmtArgs>
+class compiled_format
+{
+public:
+
+    explicit compiled_format(string_view fmt)
+        : _fmt_str(fmt)
+    {
+        imp::compile_format_into<FmtArgs...>(_plan, _fmt_str);
+    }
+
+    /// Returns the format string
+    string_view get_view() const noexcept { return _fmt_str; }
+
+    /// Returns the number of replacement fields
+    size_t get_field_count() const noexcept { return _plan.fields.size(); }
+
+    /// Format into the given context, whose arguments must match FmtArgs
+    template <class OutputIt>
+    void execute(basic_format_context<OutputIt>& f_ctx) const
+    {
+        const string_view fmt{_fmt_str};
+
+        for (size_t i = 0; i < _plan.segs.size(); ++i) {
+            const auto& seg = _plan.segs[i];
+            f_ctx.advance_to(imp::put_run(f_ctx.out(), fmt.data() + seg.lit_pos, seg.lit_len));
+            if (seg.field == _plan.no_field)
+                continue;
+
+            const auto& fld = _plan.fields[seg.field];
+            if (const auto* kept = _plan.kept[seg.field].get())
+                format_kept<0, FmtArgs...>(fld, *kept, f_ctx);
+            else
+                imp::format_plan_field(fld, fmt, f_ctx);
+        }
+    }
+
+private:
+
+    /// Format a field using a copy of its kept formatter
+    template <size_t Idx, class Arg, class... Args, class FormatCtx>
+    void format_kept(const imp::fmt_plan_field& fld, const imp::fmt_kept_base& kept,
+        FormatCtx& f_ctx) const
+    {
+        if (fld.arg_idx != Idx) {
+            if constexpr (sizeof...(Args) > 0)
+                format_kept<Idx + 1, Args...>(fld, kept, f_ctx);
+            return;
+        }
+
+        using Ts = remove_cvref_t<Arg>;
+        using fmt_type = formatter<Ts>;
+        if constexpr (imp::fmt_arg_type_of<FormatCtx, Arg>() == imp::fmt_arg_type::custom) {
+            fmt_type f{static_cast<const imp::fmt_kept<fmt_type>&>(kept).fmt};
+            const auto* obj = static_cast<const Ts*>(f_ctx.get_arg(Idx).value().p);
+            f_ctx.advance_to(f.format(*obj, f_ctx));
+        }
+        else
+            imp::format_plan_field(fld, _fmt_str, f_ctx);
+    }
+
+    string              _fmt_str;
+    imp::fmt_dyn_plan   _plan;
+};
+
+_SYS_END_NS
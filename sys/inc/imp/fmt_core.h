@@ -43,30 +43,213 @@ struct formatter
     }
 };
 
-// ---------------- Format string ------------------------------------------
+// ---------------- Output helpers -----------------------------------------
+
+/**
+ * @brief An output iterator that can accept a contiguous run of chars
+ *
+ * Output iterators that can do better than one char at a time (e.g.,
+ * memcpy into a buffer or a single write to a stream) advertise this by
+ * implementing append(const char*, size_t). Formatting code uses the
+ * imp::put_* helpers below, which fall back to char-by-char output for
+ * iterators that don't.
+ */
+template <class OutputIt, class CharT = char>
+concept bulk_output_iterator =
+    requires (OutputIt it, const CharT* s, size_t count) {
+        it.append(s, count);
+    };
 
 namespace imp {
-    template <class... FmtArgs>
-    static constexpr void check_format(sys::string_view sv);
+
+/// Write a contiguous run of chars to an output iterator
+template <class OutputIt>
+constexpr OutputIt put_run(OutputIt it, const char* s, size_t count)
+{
+    if constexpr (bulk_output_iterator<OutputIt>) {
+        if (count)
+            it.append(s, count);
+    }
+    else {
+        while (count--)
+            *it++ = *s++;
+    }
+
+    return it;
+}
+
+/// Write a string_view to an output iterator
+template <class OutputIt>
+constexpr OutputIt put_run(OutputIt it, sys::string_view sv)
+{
+    return put_run(sys::move(it), sv.data(), sv.length());
+}
+
+/// Write count copies of ch to an output iterator
+template <class OutputIt>
+constexpr OutputIt put_fill(OutputIt it, char ch, size_t count)
+{
+    if constexpr (bulk_output_iterator<OutputIt>) {
+        // Fill in chunks from a local run of fill chars
+        constexpr size_t chunk_len = 32;
+        char chunk[chunk_len];
+        const size_t fill_len = (count < chunk_len) ? count : chunk_len;
+        for (size_t i = 0; i < fill_len; ++i)
+            chunk[i] = ch;
+
+        while (count) {
+            const size_t n = (count < chunk_len) ? count : chunk_len;
+            it.append(chunk, n);
+            count -= n;
+        }
+    }
+    else {
+        while (count--)
+            *it++ = ch;
+    }
+
+    return it;
 }
 
+}   // end namespace imp
+
+// ---------------- Format specification -----------------------------------
+
+// [[fill]align][sign]["#"]["0"][width]["." precision]["L"][type]
+// fill:  [^{}] == anything but { or }
+// align: [<>^]
+// sign:  [+- ]
+// type:  [aAbBcdeEfFgGopsxX] depending on context
+
+/// Parsed standard format specification for a replacement field
+struct format_spec_t {
+
+    static constexpr string_view align_chars{"<>^"};
+    static constexpr string_view sign_chars{"-+ "};
+    static constexpr char        alt_form_char{'#'};
+    static constexpr char        zero_pad_char{'0'};
+    static constexpr char        use_locale_char{'L'};
+
+    // All defined type chars; subclass may whittle down
+    string_view type_chars{"aAbBcdeEfFgGopsxX"};
+
+    size_t      width{0};           // Minimum field width
+    size_t      precision{0};       // precision
+
+    char        fill{0};            // Fill char; anything but { or }
+    char        align{0};           // Alignment: < > ^
+    char        sign{'-'};          // Sign for numbers: + - ' '
+    char        type{0};            // How data shall be presented
+
+    bool        alt_form{false};    // #
+    bool        zero_pad{false};    // 0
+    bool        use_locale{false};  // L
+    bool        width_in_arg{false};
+    bool        prec_in_arg{false};
+    bool        have_precision{false};
+};
+
+/// A formatter whose parsed state is entirely captured by a format_spec_t
+template <class Formatter>
+concept presettable_formatter =
+    requires (Formatter& f, const Formatter& cf, const format_spec_t& spec) {
+        { cf.get_format_spec() } -> convertible_to<const format_spec_t&>;
+        f.set_format_spec(spec);
+    };
+
+// ---------------- Format string ------------------------------------------
+
+namespace imp {
+
+/// A replacement field compiled from a format string
+struct fmt_plan_field {
+    size_t          arg_idx{0};         ///< Argument to be formatted
+    size_t          spec_pos{0};        ///< Offset of format-spec in format string
+    bool            have_spec{false};   ///< True if spec holds parsed formatter state
+    format_spec_t   spec{};             ///< Pre-parsed format specification
+};
+
+/// A run of literal text, optionally followed by a replacement field
+struct fmt_plan_seg {
+    size_t          lit_pos{0};         ///< Offset of literal text in format string
+    size_t          lit_len{0};         ///< Length of literal text
+    size_t          field{0};           ///< Index of field in plan or no_field
+};
+
+/**
+ * @brief A format string compiled into segments at compile time
+ *
+ * The format string is broken up into literal runs and replacement
+ * fields, each with its argument index and pre-parsed format_spec_t, so
+ * formatting only needs to execute the plan rather than parse the format
+ * string. Format strings too elaborate for the plan's fixed capacity (lots
+ * of escaped braces, repeated manual argument indices) are still validated
+ * but marked invalid, and formatting falls back to parsing at runtime.
+ */
+template <size_t MaxFields>
+struct fmt_plan {
+
+    static constexpr size_t max_fields = MaxFields;
+    static constexpr size_t max_segs   = MaxFields + 4;
+    static constexpr size_t no_field   = size_t(-1);
+
+    /// Add a literal-only segment
+    constexpr void add_segment(size_t lit_pos, size_t lit_len)
+    {
+        if (seg_count == max_segs) {
+            valid = false;
+            return;
+        }
+
+        segs[seg_count++] = fmt_plan_seg{lit_pos, lit_len, no_field};
+    }
+
+    /// Add a segment that ends with a replacement field
+    constexpr void add_segment(size_t lit_pos, size_t lit_len, const fmt_plan_field& fld)
+    {
+        if ((seg_count == max_segs) || (field_count == max_fields)) {
+            valid = false;
+            return;
+        }
+
+        fields[field_count] = fld;
+        segs[seg_count++] = fmt_plan_seg{lit_pos, lit_len, field_count++};
+    }
+
+    sys::array<fmt_plan_seg, max_segs>      segs{};
+    sys::array<fmt_plan_field, max_fields>  fields{};
+    size_t      seg_count{0};
+    size_t      field_count{0};
+    bool        valid{true};
+};
+
+template <class... FmtArgs>
+static constexpr fmt_plan<sizeof...(FmtArgs) + 1> compile_format(sys::string_view fmt);
+
+}   // end namespace imp
+
 template <class... FmtArgs>
 class basic_format_string
 {
 public:
 
+    using plan_type = imp::fmt_plan<sizeof...(FmtArgs) + 1>;
+
+    /// Validate and compile the format string; errors fail compilation
     template <sys::convertible_to<sys::string_view> FmtStr>
     consteval inline basic_format_string(const FmtStr& fmt_str)
-        : _fmt_str(fmt_str)
-    {
-        //imp::check_format<FmtArgs...>(get_view());
-    }
+        : _fmt_str(fmt_str), _plan(imp::compile_format<FmtArgs...>(_fmt_str))
+    {}
 
     constexpr sys::string_view get_view() const noexcept { return _fmt_str; }
 
+    /// Returns the compiled plan for the format string
+    constexpr const plan_type& get_plan() const noexcept { return _plan; }
+
 private:
 
     sys::string_view    _fmt_str;
+    plan_type           _plan;
 };
 
 template <class... FmtArgs>
@@ -79,68 +262,229 @@ class parse_context;
 template <class FormatCtx>
 class handle
 {
-    using format_func = void(*)(parse_context&, FormatCtx&, const void*);
-
-    format_func _func{ nullptr };
-    const void* _arg{ nullptr };
-
 public:
 
+    using format_func = void(*)(parse_context&, FormatCtx&, const void*);
+
     template <class Formattable>
     handle(const Formattable& obj)
-        : _arg(&obj)
-    {
-        using TD = sys::remove_const_t<Formattable>;
-        using TQ = const TD;
+        : _func(&format_as<sys::remove_const_t<Formattable>>), _arg(&obj)
+    {}
 
-        _func = [](parse_context& p_ctx, FormatCtx& f_ctx, const void* argv) {
-            formatter<TD> f;
-            p_ctx.advance_to(f.parse(p_ctx));
-            f_ctx.advance_to(f.format(*static_cast<TQ*>(argv), f_ctx));
-        };
-    }
+    /// Construct from a type-erased object and its format function
+    constexpr handle(format_func func, const void* obj) noexcept
+        : _func(func), _arg(obj)
+    {}
 
     void format(parse_context& p_ctx, FormatCtx& f_ctx)
     {
         _func(p_ctx, f_ctx, _arg);
     }
+
+    /// Parse and format a type-erased object of type TD
+    template <class TD>
+    static void format_as(parse_context& p_ctx, FormatCtx& f_ctx, const void* argv)
+    {
+        formatter<TD> f;
+        p_ctx.advance_to(f.parse(p_ctx));
+        f_ctx.advance_to(f.format(*static_cast<const TD*>(argv), f_ctx));
+    }
+
+private:
+
+    format_func _func{ nullptr };
+    const void* _arg{ nullptr };
 };
 
 // ---------------- Format arguments ---------------------------------------
 
+namespace imp {
+
+/// Type tag of a stored format argument
+enum class fmt_arg_type : uint8_t {
+    none,                               // Invalid type for an argument
+    u8, u16, u32, u64, u128,            // Integral types
+    s8, s16, s32, s64, s128,
+    boolean,                            // The bool type
+    f32, f64,                           // Floating-point types
+    ptr, null_ptr,                      // Pointer types
+    cstr, sv, str,                      // String types
+    custom                              // User-defined types
+};
+
+/**
+ * @brief Value of a stored format argument
+ *
+ * Everything that fits in eight bytes is stored by value; narrow integers
+ * are widened into u or s. 128-bit integers, strings and user-defined
+ * types point at the caller's argument, which outlives the format call.
+ */
+union fmt_arg_value {
+    uint64_t            u{0};
+    sint64_t            s;
+    bool                b;
+    float               f;
+    double              d;
+    const void*         p;
+    const char*         cs;
+    const uint128_t*    u128;
+    const sint128_t*    s128;
+    const string_view*  sv;
+    const string*       str;
+};
+
+/// Returns the type tag under which an argument of type T is stored
+template <class Context, class T>
+consteval fmt_arg_type fmt_arg_type_of()
+{
+    using Ts = remove_cvref_t<T>;
+    using Td = remove_cvref_t<decay_t<T>>;
+
+    if constexpr (is_same_v<Ts, bool>)
+        return fmt_arg_type::boolean;
+    else if constexpr (is_integral_v<Ts> && !is_same_v<Ts, typename Context::char_type>) {
+        static_assert(sizeof(Ts) <= 16, "Integral type is too large");
+        constexpr fmt_arg_type base = is_unsigned_v<Ts> ? fmt_arg_type::u8 : fmt_arg_type::s8;
+        constexpr auto step = (sizeof(Ts) == 1) ? 0 : (sizeof(Ts) == 2) ? 1
+            : (sizeof(Ts) == 4) ? 2 : (sizeof(Ts) == 8) ? 3 : 4;
+        return static_cast<fmt_arg_type>(static_cast<int>(base) + step);
+    }
+    // long double is formatted as a double
+    else if constexpr (is_floating_point_v<Ts>)
+        return is_same_v<fp_conv_type<Ts>, float> ? fmt_arg_type::f32 : fmt_arg_type::f64;
+    else if constexpr (is_same_v<Ts, nullptr_t>)
+        return fmt_arg_type::null_ptr;
+    else if constexpr (is_same_v<Ts, string_view>)
+        return fmt_arg_type::sv;
+    else if constexpr (is_same_v<Ts, string>)
+        return fmt_arg_type::str;
+    else if constexpr (is_pointer_v<Td>) {
+        if constexpr (is_same_v<Td, const char*> || is_same_v<Td, char*>)
+            return fmt_arg_type::cstr;
+        else
+            return fmt_arg_type::ptr;
+    }
+    else
+        return fmt_arg_type::custom;
+}
+
+/// Returns the format function for a user-defined argument type, else nullptr
+template <class Context, class T>
+consteval typename handle<Context>::format_func fmt_custom_func()
+{
+    if constexpr (fmt_arg_type_of<Context, T>() == fmt_arg_type::custom)
+        return &handle<Context>::template format_as<remove_cvref_t<T>>;
+    else
+        return nullptr;
+}
+
+}   // end namespace imp
+
+/**
+ * @brief A single type-erased format argument
+ *
+ * This is a type tag and an imp::fmt_arg_value; visit() switches on the
+ * tag and hands the visitor the value as its stored type, a monostate for
+ * an invalid argument, or a handle for a user-defined type.
+ */
 template <class Context>
-using basic_format_arg = sys::variant<
-        // Invalid type for an argument
-        monostate,
-        // Integral types
-        uint8_t, uint16_t, uint32_t, uint64_t, uint128_t,
-        sint8_t, sint16_t, sint32_t, sint64_t, sint128_t,
-        // The bool type
-        bool,
-        // Pointer types
-        const void*, nullptr_t,
-        // String types
-        const char*, string_view,
-        // User-defined types
-        handle<Context>
->;
+class basic_format_arg
+{
+public:
+
+    using format_func = typename handle<Context>::format_func;
+
+    constexpr basic_format_arg() noexcept = default;
+
+    constexpr basic_format_arg(imp::fmt_arg_type type, imp::fmt_arg_value val,
+        format_func func = nullptr) noexcept
+        : _val(val), _func(func), _type(type)
+    {}
+
+    /// Returns true if this refers to an actual argument
+    constexpr explicit operator bool() const noexcept
+        { return _type != imp::fmt_arg_type::none; }
+
+    constexpr imp::fmt_arg_type type() const noexcept { return _type; }
+    constexpr const imp::fmt_arg_value& value() const noexcept { return _val; }
+
+    /// Invoke vis with the argument as its stored type
+    template <class Visitor>
+    constexpr decltype(auto) visit(Visitor&& vis) const
+    {
+        using imp::fmt_arg_type;
+        switch (_type) {
+        case fmt_arg_type::u8:       return vis(static_cast<uint8_t>(_val.u));
+        case fmt_arg_type::u16:      return vis(static_cast<uint16_t>(_val.u));
+        case fmt_arg_type::u32:      return vis(static_cast<uint32_t>(_val.u));
+        case fmt_arg_type::u64:      return vis(_val.u);
+        case fmt_arg_type::u128:     return vis(*_val.u128);
+        case fmt_arg_type::s8:       return vis(static_cast<sint8_t>(_val.s));
+        case fmt_arg_type::s16:      return vis(static_cast<sint16_t>(_val.s));
+        case fmt_arg_type::s32:      return vis(static_cast<sint32_t>(_val.s));
+        case fmt_arg_type::s64:      return vis(_val.s);
+        case fmt_arg_type::s128:     return vis(*_val.s128);
+        case fmt_arg_type::boolean:  return vis(_val.b);
+        case fmt_arg_type::f32:      return vis(_val.f);
+        case fmt_arg_type::f64:      return vis(_val.d);
+        case fmt_arg_type::ptr:      return vis(_val.p);
+        case fmt_arg_type::null_ptr: return vis(nullptr);
+        case fmt_arg_type::cstr:     return vis(_val.cs);
+        case fmt_arg_type::sv:       return vis(*_val.sv);
+        case fmt_arg_type::str:      return vis(string_view(_val.str->data(), _val.str->size()));
+        case fmt_arg_type::custom:   return vis(handle<Context>(_func, _val.p));
+        case fmt_arg_type::none:     break;
+        }
+        return vis(monostate{});
+    }
+
+private:
+
+    imp::fmt_arg_value  _val{};
+    format_func         _func{ nullptr };
+    imp::fmt_arg_type   _type{ imp::fmt_arg_type::none };
+};
 
+/**
+ * @brief Packed storage for a set of format arguments
+ *
+ * Argument types are known at compile time, so the type tags and the
+ * format functions of user-defined types live in static tables; each
+ * instance only holds one eight-byte imp::fmt_arg_value per argument.
+ */
 template <class Context, class... FmtArgs>
 struct format_args_store
 {
+    using format_func = typename handle<Context>::format_func;
+
+    static constexpr size_t arg_count = sizeof...(FmtArgs);
+
     constexpr format_args_store() = default;
 
     template <class... CxFmtArgs>
     constexpr format_args_store(CxFmtArgs&&... args)
         requires ((sizeof...(CxFmtArgs) > 0) && (sizeof...(CxFmtArgs) == sizeof...(FmtArgs)))
     {
-        init_store<0, CxFmtArgs...>(sys::forward<CxFmtArgs>(args)...);
+        size_t idx = 0;
+        (init_arg(_values[idx++], sys::forward<CxFmtArgs>(args)), ...);
     }
 
+    /// Type tag of each argument
+    static constexpr sys::array<imp::fmt_arg_type, arg_count> types{
+        imp::fmt_arg_type_of<Context, FmtArgs>()...
+    };
+
+    /// Format function of each user-defined argument; nullptr for others
+    static constexpr sys::array<format_func, arg_count> funcs{
+        imp::fmt_custom_func<Context, FmtArgs>()...
+    };
+
+    constexpr const imp::fmt_arg_value* values() const noexcept { return _values.data(); }
+
     constexpr basic_format_arg<Context> get(sys::size_t idx) const noexcept
     {
-        if (idx < sizeof...(FmtArgs))
-            return _args[idx];
+        if (idx < arg_count)
+            return basic_format_arg<Context>(types[idx], _values[idx], funcs[idx]);
 
         return basic_format_arg<Context>{};
     }
@@ -148,98 +492,108 @@ struct format_args_store
 private:
 
     template <class T>
-    constexpr basic_format_arg<Context> init_arg(T&& val)
+    static constexpr void init_arg(imp::fmt_arg_value& v, T&& val)
     {
+        using imp::fmt_arg_type;
         using Ts = remove_cvref_t<T>;
-        using Td = remove_cvref_t<decay_t<T>>;
-
-        if constexpr (is_same_v<Ts, bool> || is_same_v<Ts, typename Context::char_type>)
-            return forward<T>(val);
-        // Pull any (non-bool) integral value into its explicitly sized equivalent.
-        else if constexpr (is_integral_v<Ts> && !is_same_v<Ts, bool>) {
-            if constexpr (is_unsigned_v<Ts>) {
-                if      constexpr (sizeof(Ts) ==  1) return static_cast<uint8_t>(val);
-                else if constexpr (sizeof(Ts) ==  2) return static_cast<uint16_t>(val);
-                else if constexpr (sizeof(Ts) ==  4) return static_cast<uint32_t>(val);
-                else if constexpr (sizeof(Ts) ==  8) return static_cast<uint64_t>(val);
-                else if constexpr (sizeof(Ts) == 16) return static_cast<uint128_t>(val);
-                else static_assert(dependent_false_v<T>, "Unsigned integral type is too large");
-            }
-            else if constexpr (is_signed_v<Ts>) {
-                if      constexpr (sizeof(Ts) ==  1) return static_cast<sint8_t>(val);
-                else if constexpr (sizeof(Ts) ==  2) return static_cast<sint16_t>(val);
-                else if constexpr (sizeof(Ts) ==  4) return static_cast<sint32_t>(val);
-                else if constexpr (sizeof(Ts) ==  8) return static_cast<sint64_t>(val);
-                else if constexpr (sizeof(Ts) == 16) return static_cast<sint128_t>(val);
-                else static_assert(dependent_false_v<T>, "Signed integral type is too large");
-            }
-            else
-                static_assert(dependent_false_v<T>, "Integral type is neither signed nor unsigned");
-        }
-        else if constexpr (is_floating_point_v<Ts>)
-            return forward<T>(val);
-        else if constexpr (is_same_v<Ts, string_view> || is_same_v<Ts, string>)
-            return string_view(val.data(), val.size());
-        else if constexpr (is_pointer_v<Td>) {
-            if constexpr (is_same_v<Td, const char*> || is_same_v<Td, char*>)
-                return static_cast<const char*>(val);
-            else
-                return static_cast<const void*>(val);
-        }
-        else
-            return handle<Context>(val);
-    }
 
-    template <size_t Idx, class Arg, class... Args>
-    constexpr void init_store(Arg&& arg, Args&&... args)
-    {
-        if constexpr (Idx < sizeof...(FmtArgs)) {
-            _args[Idx] = init_arg(forward<Arg>(arg));
-
-            if constexpr (sizeof...(Args) > 0)
-                init_store<Idx + 1, Args...>(sys::forward<Args>(args)...);
-        }
+        constexpr auto type = imp::fmt_arg_type_of<Context, T>();
+        if constexpr (type == fmt_arg_type::boolean)
+            v.b = val;
+        else if constexpr (type == fmt_arg_type::u128)
+            v.u128 = &val;
+        else if constexpr (type == fmt_arg_type::s128)
+            v.s128 = &val;
+        else if constexpr ((type >= fmt_arg_type::u8) && (type <= fmt_arg_type::u64))
+            v.u = static_cast<uint64_t>(val);
+        else if constexpr ((type >= fmt_arg_type::s8) && (type <= fmt_arg_type::s64))
+            v.s = static_cast<sint64_t>(val);
+        else if constexpr (type == fmt_arg_type::f32)
+            v.f = static_cast<float>(val);
+        else if constexpr (type == fmt_arg_type::f64)
+            v.d = static_cast<double>(val);
+        else if constexpr (type == fmt_arg_type::sv)
+            v.sv = &val;
+        else if constexpr (type == fmt_arg_type::str)
+            v.str = &val;
+        else if constexpr (type == fmt_arg_type::cstr)
+            v.cs = static_cast<const char*>(val);
+        else if constexpr (type == fmt_arg_type::ptr)
+            v.p = static_cast<const void*>(val);
+        else if constexpr (type == fmt_arg_type::custom)
+            v.p = static_cast<const void*>(&val);
+        else
+            static_assert(is_same_v<Ts, nullptr_t>);
     }
 
-    using arg_store = sys::array<basic_format_arg<Context>, sizeof...(FmtArgs)>;
-
-    arg_store   _args{};
+    sys::array<imp::fmt_arg_value, arg_count>   _values{};
 };
 
 // Deduction guide
 template <class Context, class... FmtArgs>
 format_args_store(FmtArgs...) -> format_args_store<Context, FmtArgs...>;
 
+/**
+ * @brief Non-owning view of a set of format arguments
+ *
+ * Refers to the tables of a format_args_store. Fetching an argument is a
+ * direct index into them.
+ */
 template <class Context>
 class basic_format_args
 {
 public:
-    constexpr virtual ~basic_format_args() = default;
-    constexpr virtual basic_format_arg<Context> get(sys::size_t idx) const noexcept = 0;
-    constexpr virtual size_t count() const noexcept = 0;
+
+    using format_func = typename handle<Context>::format_func;
+
+    constexpr basic_format_args() noexcept = default;
+
+    template <class... FmtArgs>
+    constexpr basic_format_args(const format_args_store<Context, FmtArgs...>& store) noexcept
+        : _types(store.types.data()), _values(store.values()),
+          _funcs(store.funcs.data()), _count(sizeof...(FmtArgs))
+    {}
+
+    constexpr basic_format_arg<Context> get(sys::size_t idx) const noexcept
+    {
+        if (idx < _count)
+            return basic_format_arg<Context>(_types[idx], _values[idx], _funcs[idx]);
+
+        return basic_format_arg<Context>{};
+    }
+
+    constexpr size_t count() const noexcept { return _count; }
+
+private:
+
+    const imp::fmt_arg_type*    _types{ nullptr };
+    const imp::fmt_arg_value*   _values{ nullptr };
+    const format_func*          _funcs{ nullptr };
+    size_t                      _count{ 0 };
 };
 
+/// Format arguments along with a view of them
 template <class Context, class... FmtArgs>
-class format_args_model final : public basic_format_args<Context>
+class format_args_model final
+    : private format_args_store<Context, FmtArgs...>, public basic_format_args<Context>
 {
+    using store_type = format_args_store<Context, FmtArgs...>;
+
 public:
 
+    // Note: store_type is the first base, so it is built before the view
     template <class... CxFmtArgs>
     constexpr format_args_model(CxFmtArgs&&... args)
-        : _store(sys::forward<CxFmtArgs>(args)...)
+        : store_type(sys::forward<CxFmtArgs>(args)...),
+          basic_format_args<Context>(static_cast<const store_type&>(*this))
     {}
 
-    constexpr ~format_args_model() = default;
-
-    constexpr basic_format_arg<Context> get(sys::size_t idx) const noexcept override
-        { return _store.get(idx); }
+    // The view refers into our own storage
+    format_args_model(const format_args_model&) = delete;
+    format_args_model& operator=(const format_args_model&) = delete;
 
-    constexpr size_t count() const noexcept
-        { return sizeof...(FmtArgs); }
-
-private:
-
-    format_args_store<Context, FmtArgs...>   _store;
+    using basic_format_args<Context>::get;
+    using basic_format_args<Context>::count;
 };
 
 // Deduction guide
@@ -267,7 +621,10 @@ public:
     constexpr format_arg get_arg(size_t idx) const noexcept
         { return _args.get(idx); }
 
-    constexpr [[nodiscard]] iterator out()
+    constexpr size_t get_arg_count() const noexcept
+        { return _args.count(); }
+
+    [[nodiscard]] constexpr iterator out()
         { return _it; }
 
     constexpr void advance_to(OutputIt it)
@@ -275,7 +632,7 @@ public:
 
 private:
 
-    const format_args&  _args;
+    format_args         _args;
     OutputIt            _it;
 };
 
@@ -345,6 +702,12 @@ public:
         return _arg_cur_idx;
     }
 
+    /// Set the index next_arg_index() will hand out next
+    constexpr void set_next_arg_index(size_t idx) noexcept
+    {
+        _arg_auto_idx = idx;
+    }
+
 private:
 
     enum class arg_index_mode_t { Initial, Auto, Manual };
@@ -367,18 +730,31 @@ constexpr auto make_format_args(FmtArgs&... args)
 
 namespace imp {
 
-template <size_t Idx, size_t Count, class Arg, class... Args>
+template <size_t Idx, size_t Count, class Arg, class... Args, class Plan>
     requires (Idx < Count)
-static constexpr void check_format_arg(parse_context& p_ctx)
+static constexpr void compile_format_arg(parse_context& p_ctx, Plan& plan, fmt_plan_field& fld)
 {
     if (p_ctx.get_current_arg_idx() == Idx) {
         using sys::formatter;
-        formatter<sys::remove_cvref_t<Arg>> f;
+        using fmt_type = formatter<sys::remove_cvref_t<Arg>>;
+        fmt_type f;
         p_ctx.advance_to(f.parse(p_ctx));
+
+        // Plans that can hold on to arbitrary formatters keep a copy of any
+        // for a user-defined type, since we can't know what state it has
+        constexpr bool is_custom =
+            fmt_arg_type_of<format_context, Arg>() == fmt_arg_type::custom;
+        if constexpr (is_custom && requires { plan.keep(f); })
+            plan.keep(f);
+        // The standard formatters' parsed state can be handed back later
+        else if constexpr (!is_custom && presettable_formatter<fmt_type>) {
+            fld.spec = static_cast<const fmt_type&>(f).get_format_spec();
+            fld.have_spec = true;
+        }
     }
     else {
         if constexpr (Idx + 1 < Count)
-            check_format_arg<Idx + 1, Count, Args...>(p_ctx);
+            compile_format_arg<Idx + 1, Count, Args...>(p_ctx, plan, fld);
         else
             throw error_format{ "Invalid argument" };     // Necessary?
     }
@@ -425,65 +801,117 @@ static constexpr void validate_rf_arg_idx(parse_context& p_ctx)
 template <class OutputIt>
 static constexpr bool find_next_rf(parse_context& p_ctx, basic_format_context<OutputIt>& f_ctx)
 {
-    auto it_in  = p_ctx.begin();
+    const auto fmt = p_ctx.get_fmt_str();
     auto it_out = f_ctx.out();
 
-    // Walk until we find the first solo '{'
-    for (char last_char{}; it_in != p_ctx.end(); ++it_in) {
-        if (last_char == '{') {
-
-            // Are we are at the start of a replacement field?
-            if (*it_in != '{')
-                break;
-
-            // We are at an escaped {
-            last_char = {};
-            *it_out++ = '{';
+    // Walk until we find the first solo '{', sending literal text out in
+    // runs rather than a char at a time. An escaped brace ({{ or }}) ends
+    // the current run; the second brace of the pair starts the next one.
+    size_t run_start = 0, pos = 0;
+    bool have_rf = false;
+    while (pos < fmt.length()) {
+        const auto c = fmt[pos];
+        if ((c != '{') && (c != '}')) {
+            ++pos;
             continue;
         }
 
-        if (last_char == '}') {
+        it_out = put_run(move(it_out), fmt.data() + run_start, pos - run_start);
 
-            //  Are we at an non-escaped (i.e., invalid) '}'?
-            if (*it_in != '}')
-                throw error_format("Unexpected '}'");
-
-            // We are at an escaped }
-            last_char = {};
-            *it_out++ = '}';
+        // Escaped brace?
+        if ((pos + 1 < fmt.length()) && (fmt[pos + 1] == c)) {
+            run_start = ++pos;
+            ++pos;
             continue;
         }
 
-        last_char = *it_in;
+        // Are we at an non-escaped (i.e., invalid) '}'?
+        if (c == '}')
+            throw error_format("Unexpected '}'");
 
-        if ((*it_in != '{') && (*it_in != '}'))
-            *it_out++ = *it_in;
+        // We are at the start of a replacement field
+        run_start = ++pos;
+        have_rf = true;
+        break;
     }
-    p_ctx.advance_to(it_in);
+    if (!have_rf)
+        it_out = put_run(move(it_out), fmt.data() + run_start, pos - run_start);
+
+    p_ctx.advance_by(pos);
     f_ctx.advance_to(it_out);
 
     // If we have a replacement field, then validate the argument index and
     // make it accessible for the concrete parser.
-    if (!p_ctx.is_empty())
+    if (have_rf)
         validate_rf_arg_idx(p_ctx);
 
-    return !p_ctx.is_empty();
+    return have_rf;
 }
 
-template <class... FmtArgs>
-static constexpr void check_format(sys::string_view fmt)
+/**
+ * @brief Validate a format string and compile it into plan
+ *
+ * Plan must provide add_segment() overloads like fmt_plan does. It may
+ * also provide keep(formatter), which is handed the parsed formatter of
+ * each field that formats a user-defined type.
+ */
+template <class... FmtArgs, class Plan>
+static constexpr void compile_format_into(Plan& plan, sys::string_view fmt)
 {
-    imp::fmt_buf buf;
-    auto no_args = make_format_args();
-    format_context f_ctx{no_args, back_insert_iterator(buf)};
-    parse_context  p_ctx{fmt, sizeof...(FmtArgs)};
+    constexpr size_t arg_count = sizeof...(FmtArgs);
 
-    while (find_next_rf(p_ctx, f_ctx)) {
-        if constexpr (sizeof...(FmtArgs))
-            check_format_arg<0, sizeof...(FmtArgs), FmtArgs...>(p_ctx);
+    parse_context p_ctx{fmt, arg_count};
+
+    // Offset of the parse context's position in the format string
+    auto p_pos = [&fmt, &p_ctx]() -> size_t {
+        return static_cast<size_t>(p_ctx.get_fmt_str().data() - fmt.data());
+    };
+
+    size_t run_start = 0, pos = 0;
+    while (pos < fmt.length()) {
+        const auto c = fmt[pos];
+        if ((c != '{') && (c != '}')) {
+            ++pos;
+            continue;
+        }
+
+        // Escaped brace? Current run ends with the first brace of the pair
+        if ((pos + 1 < fmt.length()) && (fmt[pos + 1] == c)) {
+            plan.add_segment(run_start, pos + 1 - run_start);
+            run_start = pos += 2;
+            continue;
+        }
+
+        // Are we at an non-escaped (i.e., invalid) '}'?
+        if (c == '}')
+            throw error_format("Unexpected '}'");
+
+        // We are at the start of a replacement field. Resolve the argument
+        // index and let the argument's formatter parse the format-spec.
+        p_ctx.advance_by(pos + 1 - p_pos());
+        validate_rf_arg_idx(p_ctx);
+
+        fmt_plan_field fld{};
+        fld.arg_idx  = p_ctx.get_current_arg_idx();
+        fld.spec_pos = p_pos();
+        if constexpr (arg_count > 0)
+            compile_format_arg<0, arg_count, FmtArgs...>(p_ctx, plan, fld);
         else
             throw error_format("Missing format argument");
+
+        plan.add_segment(run_start, pos - run_start, fld);
+        run_start = pos = p_pos();
     }
+    if (run_start < pos)
+        plan.add_segment(run_start, pos - run_start);
+}
+
+template <class... FmtArgs>
+static constexpr fmt_plan<sizeof...(FmtArgs) + 1> compile_format(sys::string_view fmt)
+{
+    fmt_plan<sizeof...(FmtArgs) + 1> plan{};
+    compile_format_into<FmtArgs...>(plan, fmt);
+    return plan;
 }
 
 template <class OutputIt>
@@ -508,6 +936,71 @@ static constexpr void do_format(parse_context& p_ctx,
     }
 }
 
+/// Format a single replacement field of a compiled plan
+template <class OutputIt>
+static constexpr void format_plan_field(const fmt_plan_field& fld, sys::string_view fmt,
+    basic_format_context<OutputIt>& f_ctx)
+{
+    // Formatters with state beyond a format_spec_t parse here
+    auto reparse_ctx = [&fld, &fmt, &f_ctx]() {
+        parse_context p_ctx{fmt.substr_view(fld.spec_pos), f_ctx.get_arg_count()};
+        p_ctx.set_current_arg_idx(fld.arg_idx);
+        // In auto mode, nested fields (e.g., {:{}}) follow the field's own
+        p_ctx.set_next_arg_index(fld.arg_idx + 1);
+        return p_ctx;
+    };
+
+    auto visitor = [&fld, &f_ctx, &reparse_ctx](auto a) {
+        using arg_type = decltype(a);
+        if constexpr (is_specialization_v<arg_type, handle>) {
+            auto p_ctx = reparse_ctx();
+            a.format(p_ctx, f_ctx);
+        }
+        else {
+            using sys::formatter;
+            using fmt_type = formatter<arg_type>;
+            fmt_type f;
+            if constexpr (presettable_formatter<fmt_type>) {
+                if (fld.have_spec)
+                    f.set_format_spec(fld.spec);
+            }
+            if (!presettable_formatter<fmt_type> || !fld.have_spec) {
+                auto p_ctx = reparse_ctx();
+                f.parse(p_ctx);
+            }
+            f_ctx.advance_to(f.format(a, f_ctx));
+        }
+    };
+
+    f_ctx.get_arg(fld.arg_idx).visit(visitor);
+}
+
+/// Format by executing a compiled plan
+template <class OutputIt, size_t MaxFields>
+static constexpr void do_format(const fmt_plan<MaxFields>& plan, sys::string_view fmt,
+    basic_format_context<OutputIt>& f_ctx)
+{
+    for (size_t i = 0; i < plan.seg_count; ++i) {
+        const auto& seg = plan.segs[i];
+        f_ctx.advance_to(put_run(f_ctx.out(), fmt.data() + seg.lit_pos, seg.lit_len));
+        if (seg.field != plan.no_field)
+            format_plan_field(plan.fields[seg.field], fmt, f_ctx);
+    }
+}
+
+/// Format using a checked format string; uses its plan if it has one
+template <class OutputIt, class... FmtArgs>
+static constexpr void do_format(const basic_format_string<FmtArgs...>& fmt,
+    basic_format_context<OutputIt>& f_ctx)
+{
+    if (fmt.get_plan().valid)
+        do_format(fmt.get_plan(), fmt.get_view(), f_ctx);
+    else {
+        parse_context p_ctx{fmt.get_view(), f_ctx.get_arg_count()};
+        do_format(p_ctx, f_ctx);
+    }
+}
+
 }   // end namespace imp {
 
 _SYS_END_NS
@@ -0,0 +1,120 @@
+/**
+ * @file    fmt_sink.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Declares sys::format_sink; formatted output flushed to a stream in chunks
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <_core_.h>
+#include <io_ostream_.h>
+#include <io_file_.h>
+#include <string_view_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// Hand a run of output to a stream
+inline bool fmt_sink_write(io::ostream& dst, const char* s, size_t count)
+{
+    return dst.write(s, count);
+}
+
+/// Hand a run of output to a file
+inline bool fmt_sink_write(io::file& dst, const char* s, size_t count)
+{
+    return dst.write_all(s, count) == count;
+}
+
+}   // end namespace imp
+
+/**
+ * @brief Formatting output that goes to a stream or file in chunks
+ *
+ * Collects output into a fixed-size local buffer and hands it off to the
+ * destination (an io::ostream or io::file) each time the buffer fills, so
+ * memory use is bounded no matter how much is formatted. Runs larger than
+ * the buffer go straight to the destination. Anything left is flushed on
+ * destruction.
+ *
+ * Use with back_insert_iterator:
+ *
+ *     format_sink sink(my_file);
+ *     format_to(back_insert_iterator(sink), "{}", big_vector);
+ */
+template <class Dest, size_t ChunkSize = 4096>
+class format_sink
+{
+public:
+
+    using value_type = char;
+
+    explicit format_sink(Dest& dest) noexcept
+        : _dest(dest)
+    {}
+
+    format_sink(const format_sink&) = delete;
+    format_sink& operator=(const format_sink&) = delete;
+
+    ~format_sink() { flush(); }
+
+    void push_back(char ch)
+    {
+        if (_len == ChunkSize)
+            flush();
+
+        _buf[_len++] = ch;
+    }
+
+    /// Append a contiguous run of chars
+    void append(const char* s, size_t count)
+    {
+        if (count > ChunkSize - _len) {
+            flush();
+            if (count >= ChunkSize) {
+                write(s, count);
+                return;
+            }
+        }
+
+        string_view::traits_t::copy(_buf + _len, s, count);
+        _len += count;
+    }
+
+    /// Hand any buffered output to the destination
+    bool flush()
+    {
+        if (_len) {
+            write(_buf, _len);
+            _len = 0;
+        }
+
+        return _good;
+    }
+
+    /// Returns the total number of chars output so far
+    size_t get_count() const noexcept { return _written + _len; }
+
+    /// Returns false if any write to the destination has failed
+    bool good() const noexcept { return _good; }
+
+private:
+
+    void write(const char* s, size_t count)
+    {
+        if (!imp::fmt_sink_write(_dest, s, count))
+            _good = false;
+        _written += count;
+    }
+
+    Dest&       _dest;
+    size_t      _len{0};
+    size_t      _written{0};
+    bool        _good{true};
+    char        _buf[ChunkSize];
+};
+
+_SYS_END_NS
@@ -192,6 +192,7 @@ protected:
         if (advance_and_check_done(p_ctx))
             throw error_format("Invalid precision specification");
 
+        it = p_ctx.begin();
         if (string_view::traits_t::is_digit_dec(*it)) {       // Explicit?
             auto [pos, ec] = from_chars(fs.precision, p_ctx.get_fmt_str());
             if (is_error(ec) || (fs.precision < 0))
@@ -281,11 +282,11 @@ protected:
     template <class FormatCtx>
     size_t get_width_from_arg(size_t arg_idx, FormatCtx& f_ctx)
     {
-        const auto varg = f_ctx.get_arg(arg_idx);
-        if (varg.template holds_alternative<unsigned>())
-            return varg.template get<unsigned>();
-        if (varg.template holds_alternative<int>()) {
-            int width = varg.template get<int>();
+        const auto arg = f_ctx.get_arg(arg_idx);
+        if (arg.type() == imp::fmt_arg_type::u32)
+            return static_cast<size_t>(arg.value().u);
+        if (arg.type() == imp::fmt_arg_type::s32) {
+            const auto width = arg.value().s;
             if (width < 0)
                 throw error_format("Invalid width argument value; must be non-negative");
             return static_cast<size_t>(width);
@@ -298,11 +299,11 @@ protected:
     template <class FormatCtx>
     static size_t get_precision_from_arg(size_t arg_idx, FormatCtx& f_ctx)
     {
-        auto varg = f_ctx.get_arg(arg_idx);
-        if (varg.template holds_alternative<unsigned>())
-            return varg.template get<unsigned>();
-        if (varg.template holds_alternative<int>()) {
-            int precision = varg.template get<int>();
+        const auto arg = f_ctx.get_arg(arg_idx);
+        if (arg.type() == imp::fmt_arg_type::u32)
+            return static_cast<size_t>(arg.value().u);
+        if (arg.type() == imp::fmt_arg_type::s32) {
+            const auto precision = arg.value().s;
             if (precision < 0)
                 throw error_format("Invalid precision argument value; must be non-negative");
             return static_cast<size_t>(precision);
@@ -311,46 +312,20 @@ protected:
         throw error_format("Invalid type for precision argument index; must be int or unsigned int");
     }
 
-    // [[fill]align][sign]["#"]["0"][width]["." precision]["L"][type]
-    // fill:  [^{}] == anything but { or }
-    // align: [<>^]
-    // sign:  [+- ]
-    // type:  [aAbBcdeEfFgGopsxX] depending on context
-
-    struct format_spec_t {
-
-        static constexpr string_view align_chars{"<>^"};
-        static constexpr string_view sign_chars{"-+ "};
-        static constexpr char_t      alt_form_char{'#'};
-        static constexpr char_t      zero_pad_char{'0'};
-        static constexpr char_t      use_locale_char{'L'};
-
-        // All defined type chars; subclass may whittle down
-        string_view type_chars{"aAbBcdeEfFgGopsxX"};
-
-        size_t      width{0};           // Minimum field width
-        size_t      precision{0};       // precision
-
-        char_t      fill{0};            // Fill char; anything but { or }
-        char_t      align{0};           // Alignment: < > ^
-        char_t      sign{'-'};          // Sign for numbers: + - ' '
-        char_t      type{0};            // How data shall be presented
-
-        bool        alt_form{false};    // #
-        bool        zero_pad{false};    // 0
-        bool        use_locale{false};  // L
-        bool        width_in_arg{false};
-        bool        prec_in_arg{false};
-        bool        have_precision{false};
-    };
-
-    constexpr const format_spec_t& get_format_spec() const noexcept { return _spec; }
     constexpr       format_spec_t& get_format_spec()       noexcept { return _spec; }
 
     constexpr formatter_std(const format_spec_t& spec) noexcept
         : _spec(spec)
     {}
 
+public:
+
+    /// Returns the format specification (as set by parse)
+    constexpr const format_spec_t& get_format_spec() const noexcept { return _spec; }
+
+    /// Adopt a format specification previously produced by parse
+    constexpr void set_format_spec(const format_spec_t& spec) noexcept { _spec = spec; }
+
 private:
 
     format_spec_t   _spec{};
@@ -0,0 +1,79 @@
+/**
+ * @file    fmt_std_bytes.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Standard formatter implementation for byte_view
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <charconv_.h>
+#include "fmt_std.h"
+
+_SYS_BEGIN_NS
+
+/**
+ * @brief Formatter for byte_view: the bytes as hex digits
+ *
+ * Format spec is [[fill]align][#][width][type] where type is x (the
+ * default) or X for uppercase digits. The # option adds a 0x prefix.
+ * Digits are encoded a block at a time straight to the output.
+ */
+template <>
+struct formatter<byte_view> : public formatter_std
+{
+    constexpr formatter()
+    {
+        get_format_spec().type_chars = "xX";
+        get_format_spec().type       = 'x';
+
+        supports_alt_form = true;
+    }
+
+    template <class ParseCtx>
+    constexpr auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        parse_std(p_ctx);
+        return p_ctx.begin();
+    }
+
+    template <class FormatCtx>
+    constexpr auto format(byte_view bytes, FormatCtx& fmt_ctx) -> FormatCtx::iterator
+    {
+        const auto& fs = get_format_spec();
+        const bool upper = (fs.type == 'X');
+        const string_view prefix = !fs.alt_form ? "" : upper ? "0X" : "0x";
+
+        size_t width = fs.width_in_arg
+            ? get_width_from_arg(fs.width, fmt_ctx) : fs.width;
+
+        // Figure out alignment and fill; default is left aligned
+        const size_t fld_len = prefix.length() + hex_length(bytes.size());
+        size_t pre_fill = 0, post_fill = 0;
+        if (width && (fld_len < width)) {
+            size_t fill = width - fld_len;
+            switch (fs.align) {
+                default : post_fill = fill; break;
+                case '^': pre_fill = fill >> 1; post_fill = fill - pre_fill; break;
+                case '>': pre_fill = fill;
+            }
+        }
+
+        const char fill_char = fs.fill ? fs.fill : ' ';
+        auto it_out = imp::put_fill(fmt_ctx.out(), fill_char, pre_fill);
+        it_out = imp::put_run(move(it_out), prefix);
+
+        constexpr size_t block_len = 128;
+        char block[hex_length(block_len)];
+        for (size_t at = 0; at < bytes.size(); at += block_len) {
+            const size_t n = (bytes.size() - at < block_len) ? bytes.size() - at : block_len;
+            imp::hex_encode(block, bytes.data() + at, n, upper);
+            it_out = imp::put_run(move(it_out), block, hex_length(n));
+        }
+
+        return imp::put_fill(move(it_out), fill_char, post_fill);
+    }
+};
+
+_SYS_END_NS
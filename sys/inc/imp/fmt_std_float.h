@@ -0,0 +1,144 @@
+/**
+ * @file    fmt_std_float.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Standard formatter implementation for floating-point types
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <charconv_.h>
+#include "fmt_std.h"
+
+_SYS_BEGIN_NS
+
+/// All floating-point types can use the standard formatter
+template <floating_point T>
+struct formatter<T> : public formatter_std
+{
+    constexpr formatter()
+    {
+        // Tweak defaults for floating-point types; no type means shortest
+        get_format_spec().type_chars = "aAeEfFgG";
+
+        supports_sign           = true;
+        supports_alt_form       = true;
+        supports_leading_zeroes = true;
+        supports_precision      = true;
+    }
+
+    constexpr formatter(const format_spec_t& spec) noexcept
+        : formatter_std(spec)
+    {}
+
+    template <class ParseCtx>
+    constexpr auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        parse_std(p_ctx);
+        return p_ctx.begin();
+    }
+
+    template <class FormatCtx>
+    constexpr auto format(T val, FormatCtx& fmt_ctx) -> FormatCtx::iterator
+    {
+        const auto& fs = get_format_spec();
+
+        // Resolve field width/precision arguments
+        size_t width = fs.width_in_arg
+            ? get_width_from_arg(fs.width, fmt_ctx) : fs.width;
+        size_t precision = fs.prec_in_arg
+            ? get_precision_from_arg(fs.precision, fmt_ctx) : fs.precision;
+
+        constexpr size_t max_precision = static_cast<size_t>(numeric_limits<int>::max);
+        int prec = fs.have_precision
+            ? static_cast<int>(precision < max_precision ? precision : max_precision) : -1;
+
+        // Figure out the style; e, f, and g default to a precision of 6
+        chars_format style{};
+        bool upper = false;
+        switch (fs.type) {
+        case 0:   if (fs.have_precision) style = chars_format::general; break;
+        case 'A': upper = true; [[fallthrough]];
+        case 'a': style = chars_format::hex; break;
+        case 'E': upper = true; [[fallthrough]];
+        case 'e': style = chars_format::scientific; if (prec < 0) prec = 6; break;
+        case 'F': upper = true; [[fallthrough]];
+        case 'f': style = chars_format::fixed;      if (prec < 0) prec = 6; break;
+        case 'G': upper = true; [[fallthrough]];
+        case 'g': style = chars_format::general;    if (prec < 0) prec = 6; break;
+        default: throw error_format("Bad format type");
+        }
+
+        imp::fp_repr repr;
+        repr.build(static_cast<imp::fp_conv_type<T>>(val), style, prec, fs.alt_form);
+        if (upper)
+            repr.to_upper();
+        // TODO : Not yet handled: fs.use_locale (L) (locale specific digit grouping)
+
+        char sign = 0;
+        if (repr.is_negative())
+            sign = '-';
+        else if ((fs.sign == ' ') || (fs.sign == '+'))
+            sign = fs.sign;
+
+        const bool is_finite = repr.special().is_empty();
+        const size_t fld_len = repr.length() + (sign ? 1 : 0);
+
+        auto it_out {fmt_ctx.out()};
+
+        // Handle zero padding: [sign] [0-pad] value. Not for inf or nan.
+        if (fs.zero_pad && !fs.align && is_finite) {
+            size_t zeros = (width && fld_len < width) ? (width - fld_len) : 0;
+
+            if (sign)
+                *it_out++ = sign;
+            it_out = imp::put_fill(move(it_out), '0', zeros);
+            it_out = put_value(move(it_out), repr);
+        }
+        // Handle align/fill: [pre-fill] [sign] value [post-fill]
+        else {
+            // Figure out alignment and fill
+            size_t pre_fill = 0, post_fill = 0;
+            if (width && (fld_len < width)) {
+                size_t fill = width - fld_len;
+                switch(fs.align) {
+                    case '<': post_fill = fill; break;
+                    case '^': pre_fill = fill >> 1; post_fill = fill - pre_fill; break;
+                    default : pre_fill = fill;
+                }
+            }
+
+            char fill_char = fs.fill ? fs.fill : ' ';
+
+            it_out = imp::put_fill(move(it_out), fill_char, pre_fill);
+            if (sign)
+                *it_out++ = sign;
+            it_out = put_value(move(it_out), repr);
+            it_out = imp::put_fill(move(it_out), fill_char, post_fill);
+        }
+
+        return it_out;
+    }
+
+private:
+
+    /// Write out the text of the value, less the sign
+    template <class OutputIt>
+    static constexpr OutputIt put_value(OutputIt it_out, const imp::fp_repr& repr)
+    {
+        if (!repr.special().is_empty())
+            return imp::put_run(move(it_out), repr.special());
+
+        it_out = imp::put_run(move(it_out), repr.int_digits());
+        it_out = imp::put_fill(move(it_out), '0', repr.int_zeros());
+        if (repr.has_point())
+            *it_out++ = '.';
+        it_out = imp::put_fill(move(it_out), '0', repr.frac_zeros());
+        it_out = imp::put_run(move(it_out), repr.frac_digits());
+        it_out = imp::put_fill(move(it_out), '0', repr.frac_trail());
+        return imp::put_run(move(it_out), repr.exponent());
+    }
+};
+
+_SYS_END_NS
@@ -117,18 +117,14 @@ struct formatter<T> : public formatter_std
             }
 
             // [base-prefix]
-            if (fs.alt_form && !base_prefix.is_empty()) {
-                for (auto c: base_prefix)
-                    *it_out++ = c;
-            }
+            if (fs.alt_form)
+                it_out = imp::put_run(move(it_out), base_prefix);
 
             // [0-pad]
-            while (zeros--)
-                *it_out++ = '0';
+            it_out = imp::put_fill(move(it_out), '0', zeros);
 
             // value
-            for (auto c : num_str)
-                *it_out++ = c;
+            it_out = imp::put_run(move(it_out), num_str);
         }
         // Handle align/fill: [pre-fill] [sign] [base-prefix] value [post-fill]
         else {
@@ -146,8 +142,7 @@ struct formatter<T> : public formatter_std
             char fill_char = fs.fill ? fs.fill : ' ';
 
             // [pre-fill]
-            while (pre_fill--)
-                *it_out++ = fill_char;
+            it_out = imp::put_fill(move(it_out), fill_char, pre_fill);
 
             // [sign]
             if (!no_sign) {
@@ -158,18 +153,14 @@ struct formatter<T> : public formatter_std
             }
 
             // [base-prefix]
-            if (fs.alt_form && !base_prefix.is_empty()) {
-                for (auto c : base_prefix)
-                    *it_out++ = c;
-            }
+            if (fs.alt_form)
+                it_out = imp::put_run(move(it_out), base_prefix);
 
             // value
-            for (auto c : num_str)
-                *it_out++ = c;
+            it_out = imp::put_run(move(it_out), num_str);
 
             // [post-fill]
-            while (post_fill--)
-                *it_out++ = fill_char;
+            it_out = imp::put_fill(move(it_out), fill_char, post_fill);
         }
 
         return it_out;
@@ -196,12 +187,8 @@ struct formatter<bool> : public formatter_std
     template <class FormatCtx>
     constexpr auto format(bool val, FormatCtx& fmt_ctx) -> FormatCtx::iterator
     {
-        if (get_format_spec().type == 's') {
-            auto it_out {fmt_ctx.out()};
-            for (auto c : string_view{val ? "true" : "false"})
-                *it_out++ = c;
-            return it_out;
-        }
+        if (get_format_spec().type == 's')
+            return imp::put_run(fmt_ctx.out(), val ? "true" : "false");
 
         formatter<unsigned char> f{get_format_spec()};
         return f.format(static_cast<unsigned char>(val), fmt_ctx);
@@ -0,0 +1,207 @@
+/**
+ * @file    fmt_std_range.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Standard formatter implementation for ranges, optional, and variant
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <optional_.h>
+#include <variant_.h>
+#include "fmt_std.h"
+#include "fmt_std_str.h"
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// A non-string type with a const iterable range of elements
+template <class R>
+concept fmt_range = !string_view_convertible<R> &&
+    requires (const R& r) { r.cbegin() != r.cend(); *r.cbegin(); };
+
+/// Element type of a fmt_range
+template <class R>
+using fmt_range_elem_t = remove_cvref_t<decltype(*sys::declval<const R&>().cbegin())>;
+
+/// Formatter used for elements of type T; strings are viewed, not copied
+template <class T>
+using fmt_elem_formatter = formatter<conditional_t<string_view_convertible<T>, string_view, T>>;
+
+/// Have f parse an empty format-spec, as though it were used as {}
+template <class Formatter, class ParseCtx>
+constexpr void fmt_parse_default(Formatter& f, const ParseCtx& p_ctx)
+{
+    parse_context empty_ctx{"}", p_ctx.get_arg_count()};
+    f.parse(empty_ctx);
+}
+
+}   // end namespace imp
+
+/**
+ * @brief Formatter for ranges: sys::vector, sys::array, etc.
+ *
+ * Format spec is [n][:element-spec]. Output is "[e0, e1, ...]" where each
+ * element is formatted per element-spec, which is parsed once for the
+ * whole range. Strings are quoted and escaped unless an element-spec is
+ * given. The n option omits the brackets. Output is written directly to
+ * the context's output iterator.
+ *
+ * The parsed state lives in the element formatter and the brackets, not
+ * in a format_spec_t, so formatter_std's spec accessors aren't exposed.
+ */
+template <imp::fmt_range R>
+struct formatter<R> : protected formatter_std
+{
+    using elem_type      = imp::fmt_range_elem_t<R>;
+    using elem_formatter = imp::fmt_elem_formatter<elem_type>;
+
+    constexpr formatter() = default;
+
+    /// Set the text that goes between elements
+    constexpr void set_separator(string_view sep) noexcept { _sep = sep; }
+
+    /// Set the text that goes before and after the elements
+    constexpr void set_brackets(string_view opening, string_view closing) noexcept
+    {
+        _open  = opening;
+        _close = closing;
+    }
+
+    /// Access the element formatter
+    constexpr       elem_formatter& underlying()       noexcept { return _elem; }
+    constexpr const elem_formatter& underlying() const noexcept { return _elem; }
+
+    template <class ParseCtx>
+    constexpr auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        if (p_ctx.is_empty())
+            throw error_format("Unterminated replacement field");
+
+        if (*p_ctx.begin() == 'n') {
+            set_brackets({}, {});
+            p_ctx.advance_by(1);
+            if (p_ctx.is_empty())
+                throw error_format("Unterminated replacement field");
+        }
+
+        if (*p_ctx.begin() == ':') {
+            p_ctx.advance_by(1);
+            p_ctx.advance_to(_elem.parse(p_ctx));
+            return p_ctx.begin();
+        }
+
+        if (!check_done(p_ctx))
+            throw error_format("Invalid range format specification");
+
+        imp::fmt_parse_default(_elem, p_ctx);
+        if constexpr (string_view_convertible<elem_type>) {
+            auto spec = static_cast<const elem_formatter&>(_elem).get_format_spec();
+            spec.type = '?';
+            _elem.set_format_spec(spec);
+        }
+
+        return p_ctx.begin();
+    }
+
+    template <class FormatCtx>
+    constexpr auto format(const R& r, FormatCtx& f_ctx) -> FormatCtx::iterator
+    {
+        f_ctx.advance_to(imp::put_run(f_ctx.out(), _open));
+
+        bool first = true;
+        for (auto it = r.cbegin(); it != r.cend(); ++it) {
+            if (!first)
+                f_ctx.advance_to(imp::put_run(f_ctx.out(), _sep));
+            first = false;
+
+            f_ctx.advance_to(_elem.format(*it, f_ctx));
+        }
+
+        return imp::put_run(f_ctx.out(), _close);
+    }
+
+private:
+
+    elem_formatter  _elem{};
+    string_view     _sep{", "};
+    string_view     _open{"["};
+    string_view     _close{"]"};
+};
+
+/**
+ * @brief Formatter for sys::optional
+ *
+ * An engaged optional is formatted as its value, using the format-spec;
+ * an empty one is output as "none".
+ */
+template <class T>
+struct formatter<optional<T>>
+{
+    using value_formatter = imp::fmt_elem_formatter<T>;
+
+    constexpr formatter() = default;
+
+    template <class ParseCtx>
+    constexpr auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        return _val.parse(p_ctx);
+    }
+
+    template <class FormatCtx>
+    constexpr auto format(const optional<T>& opt, FormatCtx& f_ctx) -> FormatCtx::iterator
+    {
+        if (!opt.has_value())
+            return imp::put_run(f_ctx.out(), "none");
+
+        return _val.format(*opt, f_ctx);
+    }
+
+private:
+
+    value_formatter _val{};
+};
+
+/**
+ * @brief Formatter for sys::variant
+ *
+ * The held alternative is formatted as though by {}; no format-spec is
+ * accepted since it would have to suit every alternative.
+ */
+template <class... Ts>
+struct formatter<variant<Ts...>> : protected formatter_std
+{
+    constexpr formatter() = default;
+
+    template <class ParseCtx>
+    constexpr auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        if (!check_done(p_ctx))
+            throw error_format("Format specification not supported for variant");
+        _arg_count = p_ctx.get_arg_count();
+        return p_ctx.begin();
+    }
+
+    template <class FormatCtx>
+    constexpr auto format(const variant<Ts...>& var, FormatCtx& f_ctx) -> FormatCtx::iterator
+    {
+        if (var.is_valueless())
+            return imp::put_run(f_ctx.out(), "valueless");
+
+        var.visit([this, &f_ctx](const auto& alt) {
+            imp::fmt_elem_formatter<remove_cvref_t<decltype(alt)>> f;
+            imp::fmt_parse_default(f, parse_context{"}", _arg_count});
+            f_ctx.advance_to(f.format(alt, f_ctx));
+        });
+
+        return f_ctx.out();
+    }
+
+private:
+
+    size_t  _arg_count{0};
+};
+
+_SYS_END_NS
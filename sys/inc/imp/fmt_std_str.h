@@ -37,10 +37,7 @@ struct formatter<T> : formatter_std
     template <class OutputIt>
     constexpr OutputIt sink_string(OutputIt it, string_view sv) const
     {
-        for (const auto c : sv)
-            *it++ = c;
-
-        return it;
+        return imp::put_run(move(it), sv);
     }
 
     template <class OutputIt>
@@ -50,17 +47,25 @@ struct formatter<T> : formatter_std
 
         *it_out++ = '"';
 
+        // Unescaped chars go out in runs between escape sequences
         // TEMP: For now. Assuming ASCII encoding here.
-        for (const auto c : sv) {
-            switch(c) {
-                case '\t': it = sink_string(move(it), "\\t");  break;
-                case '\n': it = sink_string(move(it), "\\n");  break;
-                case '\r': it = sink_string(move(it), "\\r");  break;
-                case '"' : it = sink_string(move(it), "\\\""); break;
-                case '\\': it = sink_string(move(it), "\\\\"); break;
-                default:   *it_out++ = c;                      break;
+        size_t run_start = 0;
+        for (size_t i = 0; i < sv.length(); ++i) {
+            string_view esc;
+            switch(sv[i]) {
+                case '\t': esc = "\\t";  break;
+                case '\n': esc = "\\n";  break;
+                case '\r': esc = "\\r";  break;
+                case '"' : esc = "\\\""; break;
+                case '\\': esc = "\\\\"; break;
+                default:   continue;
             }
+
+            it_out = imp::put_run(move(it_out), sv.data() + run_start, i - run_start);
+            it_out = imp::put_run(move(it_out), esc);
+            run_start = i + 1;
         }
+        it_out = imp::put_run(move(it_out), sv.data() + run_start, sv.length() - run_start);
 
         *it_out++ = '"';
 
@@ -136,8 +141,7 @@ struct formatter<T> : formatter_std
         char fill_char = fs.fill ? fs.fill : ' ';
 
         // [pre-fill]
-        while (pre_fill--)
-            *it_out++ = fill_char;
+        it_out = imp::put_fill(move(it_out), fill_char, pre_fill);
 
         // value
         if (escaped_output)
@@ -146,8 +150,7 @@ struct formatter<T> : formatter_std
             it_out = sink_string(move(it_out), val);
 
         // [post-fill]
-        while (post_fill--)
-            *it_out++ = fill_char;
+        it_out = imp::put_fill(move(it_out), fill_char, post_fill);
 
         return it_out;
     }
@@ -15,6 +15,27 @@
 _SYS_BEGIN_NS
 namespace imp {
 
+/**
+ * @brief Storage for string: a heap buffer, or the object itself for short strings
+ *
+ * The object is the size of three words (24 bytes on 64-bit targets):
+ *
+ *  - Long mode: pointer, capacity, and length. The MSB of length is set,
+ *    which puts it in the top bit of the object's last byte.
+ *  - Short mode: the chars themselves, with the last byte holding the
+ *    capacity that's left (sso_capacity() - length). That's 0 when the
+ *    buffer is full, so it doubles as the null terminator, and short
+ *    strings hold up to sizeof(string_buf) - 1 chars.
+ *
+ * So the mode is the top bit of the last byte, which is read through the
+ * short state whichever member is active. That's fine at run time, but
+ * constant evaluation needs the active member to be known, so there strings
+ * always use long mode: every access to the mode goes through
+ * is_constant_evaluated() first. An empty string made during constant
+ * evaluation has no buffer, so it can outlive it (constexpr string s;):
+ * its null pointer and zero capacity have the same bytes as an empty short
+ * string, which is what it then is at run time.
+ */
 class string_buf
 {
 public:
@@ -24,16 +45,21 @@ public:
     using traits_t       = char_traits<char_t>;
 
     /// Default constructor; constructs an empty string ("")
-    constexpr string_buf() noexcept = default;
+    constexpr string_buf() noexcept
+    {
+        set_empty();
+    }
 
     template <string_view_like T>
     constexpr string_buf(T svl)
+        : string_buf()
     {
         traits_t::copy(ensure_buf(svl.length()), svl.data(), svl.length());
     }
 
     /// Copy constructor
     constexpr string_buf(const string_buf& other)
+        : string_buf()
     {
         traits_t::copy(ensure_buf(other.capacity(), false), other.data(), other.length());
         internal_set_length(other.length());
@@ -42,28 +68,24 @@ public:
     /// Move constructor
     constexpr string_buf(string_buf&& other) noexcept
     {
-        // Do this first; it determines long/short mode
-        _state.len = other._state.len;
-
-        if (is_long_mode()) {
-            _state.ls = other._state.ls;
-
-            // Invalidate the other side only if it's in long mode
-            other._state.ls.dat = nullptr;
-            other._state.ls.cap = 0;
-            other._state.len    = 0;
-        }
-        else {
-            _state.ss = other._state.ss;
-        }
+        take(other);
     }
 
     [[nodiscard]] constexpr bool is_empty() const noexcept { return 0 == length(); }
 
     constexpr const char_t* data() const noexcept
-        { return is_long_mode() ? _state.ls.dat : _state.ss.dat; }
+    {
+        if (is_constant_evaluated() && !_state.ls.dat)
+            return empty_str;
+        return is_long_mode() ? _state.ls.dat : _state.ss.dat;
+    }
     constexpr       char_t* data()       noexcept
-        { return is_long_mode() ? _state.ls.dat : _state.ss.dat; }
+    {
+        // The empty string is never written to: a buffer is made first
+        if (is_constant_evaluated() && !_state.ls.dat)
+            return const_cast<char_t*>(empty_str);
+        return is_long_mode() ? _state.ls.dat : _state.ss.dat;
+    }
     constexpr size_type length()   const noexcept
         { return internal_get_length(); }
     constexpr size_type capacity() const noexcept
@@ -95,7 +117,7 @@ public:
         // as-is. This will be the case for things like construction or an
         // initial assignment. It'll require a single allocation of optimal
         // length.
-        if (0 == capacity())
+        if (0 == length())
             return cap_request;
 
         // If we're not empty, then we're growing the buffer. In this case,
@@ -120,16 +142,15 @@ public:
             size_type new_cap =
                 explicit_reserve ? count + 1 : calc_new_capacity(count + 1);
 
+            const size_type len = length();
             char_t* new_data = new char_t[new_cap];
-            if (data() && length())
-                traits_t::copy(new_data, data(), length());
+            traits_t::copy(new_data, data(), len + 1);
 
             // We'll need to free the old buffer if we're already in long mode
             auto buf_free = is_long_mode() ? _state.ls.dat : nullptr;
 
-            _state.ls.dat = new_data;
-            _state.ls.cap = count;
-            _state.len |= lm_bit;           // This enables long mode
+            // This enables long mode
+            _state.ls = long_state{ new_data, new_cap - 1, len | lm_bit };
 
             delete[] buf_free;
         }
@@ -140,27 +161,54 @@ public:
         return data();
     }
 
-    /// Clear string content (including reserve)
-    constexpr void clear() noexcept
+    /**
+     * @brief Like ensure_buf, for when the current contents are to be replaced
+     *
+     * A new buffer isn't seeded with the old contents. On return the length
+     * is count, and the chars are indeterminate if the buffer was replaced.
+     */
+    constexpr char_t* discard_buf(size_type count, bool explicit_reserve = false)
     {
-        if (is_long_mode()) {
-            delete[] _state.ls.dat;
-            _state.ls.dat = nullptr;
-            _state.ls.cap = 0;
+        if (count > capacity()) {
+
+            size_type new_cap =
+                explicit_reserve ? count + 1 : calc_new_capacity(count + 1);
+
+            char_t* new_data = new char_t[new_cap];
+            free_long();
+            _state.ls = long_state{ new_data, new_cap - 1, lm_bit };
         }
 
-        _state.len = 0;     // This disables long mode
+        internal_set_length(count);
+        return data();
+    }
+
+    /// Grows the length by count; returns the (indeterminate) new chars
+    constexpr char_t* append_uninitialized(size_type count)
+    {
+        const size_type len = length();
+        if (count > max_size() - len) [[unlikely]]
+            throw_error_length();
+
+        return ensure_buf(len + count) + len;
+    }
+
+    /// Clear string content (including reserve)
+    constexpr void clear() noexcept
+    {
+        free_long();
+        set_empty();
     }
 
     // -- Implementation
 
     /// Returns maximum capacity for short string optimized (sso) strings
     static constexpr size_type sso_capacity() noexcept
-        { return sso_capacity_chars - 1; }  // One byte for null terminator
+        { return sso_capacity_chars - 1; }  // Last byte: space left, or null terminator
 
     constexpr ~string_buf() noexcept
     {
-        clear();
+        free_long();
     }
 
     constexpr void swap(string_buf& other) noexcept
@@ -192,23 +240,8 @@ public:
         if (this == &other) [[unlikely]]
             return *this;
 
-        if (!is_empty())
-            clear();
-
-        // Do this first; it determines long/short mode
-        _state.len = other._state.len;
-
-        if (is_long_mode()) {
-            _state.ls = other._state.ls;
-
-            // Invalidate the other side only if it's in long mode
-            other._state.ls.dat = nullptr;
-            other._state.ls.cap = 0;
-            other._state.len    = 0;
-        }
-        else {
-            _state.ss = other._state.ss;
-        }
+        free_long();
+        take(other);
 
         return *this;
     }
@@ -216,10 +249,13 @@ public:
     /// Change the length of our string; sets NULL terminator
     constexpr void internal_set_length(size_type len)
     {
+        if (is_constant_evaluated() && !_state.ls.dat)
+            return;     // Still empty, with no buffer
+
         if (is_long_mode())
-            _state.len = len |  lm_bit;
+            _state.ls.len = len | lm_bit;
          else
-            _state.len = len & ~lm_bit;
+            _state.ss.dat[sso_capacity()] = static_cast<char_t>(sso_capacity() - len);
 
         data()[len] = char_t(0);
     }
@@ -229,56 +265,94 @@ private:
     /// Returns true if we're in long mode (heap-allocated data)
     constexpr bool is_long_mode() const noexcept
     {
-        return 0 != (_state.len & lm_bit);
+        if (is_constant_evaluated())
+            return true;
+        return 0 != (static_cast<uint8_t>(_state.ss.dat[sso_capacity()]) & lm_byte_bit);
     }
 
     constexpr size_type internal_get_length() const noexcept
     {
-        return _state.len & ~lm_bit;
+        if (is_constant_evaluated() && !_state.ls.dat)
+            return 0;
+        if (is_long_mode())
+            return _state.ls.len & ~lm_bit;
+        return sso_capacity() - static_cast<uint8_t>(_state.ss.dat[sso_capacity()]);
+    }
+
+    /// Makes this an empty string, without freeing anything
+    constexpr void set_empty() noexcept
+    {
+        if (is_constant_evaluated()) {
+            // Long mode without a buffer; see above
+            _state.ls = long_state{ nullptr, 0, empty_len };
+        }
+        else {
+            _state.ss = short_state{};
+            _state.ss.dat[sso_capacity()] = static_cast<char_t>(sso_capacity());
+        }
+    }
+
+    /// Frees the heap buffer, if we have one
+    constexpr void free_long() noexcept
+    {
+        if (is_long_mode())
+            delete[] _state.ls.dat;
+    }
+
+    /// Takes the state of other, leaving it empty; we must not own a buffer
+    constexpr void take(string_buf& other) noexcept
+    {
+        if (other.is_long_mode()) {
+            _state.ls = other._state.ls;
+            other.set_empty();
+        }
+        else {
+            _state.ss = other._state.ss;
+        }
     }
 
     /// State for "long mode": heap-allocated memory for data
     struct long_state {
         char_t*     dat{nullptr};   ///< String buffer
         size_type   cap{0};         ///< String capacity
+        size_type   len{0};         ///< String length; MSB flags long mode
     };
 
-    // Short string optimization: Rather than always using heap-allocated
-    // memory, we can use the string state itself as storage. I initially
-    // included length in the shared state which gives us 7 more bytes of
-    // storage, but this does not play well with constexpr code since we
-    // need somthing to tell us which union element is the active member.
-
-    // Short string capacity limit; one byte reserved for length
-    static constexpr size_t sso_capacity_chars =
-        (sizeof(long_state) / sizeof(char_t)) - 1;
+    // Short string capacity limit, including the last byte
+    static constexpr size_t sso_capacity_chars = sizeof(long_state) / sizeof(char_t);
 
     /// State for "short mode": local-storage of data for short strings
     struct short_state {
         char_t          dat[sso_capacity_chars]{};
     };
 
-    /// MSB of long_state/short_state::len is set for long mode
+    /// MSB of long_state::len is set for long mode
     static constexpr size_type lm_bit = sys::msb<size_type>();
+    /// ... which is this bit of the last byte
+    static constexpr uint8_t lm_byte_bit = 0x80;
+
+    /// long_state::len of an empty string from constant evaluation: an empty short string's last byte
+    static constexpr size_type empty_len = size_type{sso_capacity_chars - 1} << (8 * (sizeof(size_type) - 1));
 
-    struct string_state {
+    /// data() of an empty string from constant evaluation
+    static constexpr char_t empty_str[1] = {};
+
+    static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+        "string_buf expects the MSB of long_state::len in its last byte");
+    static_assert(sso_capacity_chars - 1 < lm_byte_bit);
+
+    union string_state {
 
         // Default to short mode
         constexpr string_state() noexcept : ss() {}
 
-        union {
-            long_state  ls;     ///< Long state  (heap-allocated buffer)
-            short_state ss;     ///< Short state (local buffer)
-        };
-
-        /// Length of our string; MSB flags long mode (heap-alloc data)
-        size_type       len{0};
+        long_state  ls;     ///< Long state  (heap-allocated buffer)
+        short_state ss;     ///< Short state (local buffer)
     };
 
     string_state    _state;
 };
 
-
 }
 _SYS_END_NS
 
@@ -0,0 +1,167 @@
+/**
+ * @file    string_concat.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Pieces of a string concatenation; see sys::concat
+ *
+ * a + b + "lit" + sv doesn't build a string at each +. It builds a
+ * concat_expr: a list of the pieces, as views, which is turned into a
+ * string when it's assigned to (or appended to) one. The total length is
+ * known by then, so that takes a single allocation.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef sys_imp_string_concat__included
+#define sys_imp_string_concat__included
+
+#include <_core_.h>
+#include <type_traits_.h>
+#include <string_view_.h>
+
+_SYS_BEGIN_NS
+
+/// Specifies a type that can be a piece of a concatenation
+template <class T>
+concept concat_arg =
+    sys::string_view_like<T> ||
+    sys::is_convertible_v<const T&, const char*> ||
+    sys::is_same_v<T, char>;
+
+namespace imp {
+
+/// One piece of a concatenation: a run of chars, or a single char
+class concat_piece
+{
+public:
+
+    constexpr concat_piece() noexcept = default;
+
+    constexpr concat_piece(string_view sv) noexcept
+        : _p(sv.data()), _n(sv.length())
+    {}
+
+    constexpr concat_piece(char ch) noexcept
+        : _n(1), _ch(ch), _is_char(true)
+    {}
+
+    /// Makes the piece for any concat_arg
+    template <concat_arg T>
+    static constexpr concat_piece of(const T& arg) noexcept
+    {
+        if constexpr (is_same_v<T, char>)
+            return concat_piece(arg);
+        else if constexpr (string_view_like<T>)
+            return concat_piece(string_view(arg));
+        else
+            return concat_piece(string_view(static_cast<const char*>(arg)));
+    }
+
+    constexpr size_t length() const noexcept { return _n; }
+
+    /// Copies the piece to out; returns the end of it
+    constexpr char* write(char* out) const noexcept
+    {
+        if (_is_char)
+            *out = _ch;
+        else
+            char_traits<char>::copy(out, _p, _n);
+        return out + _n;
+    }
+
+private:
+
+    const char* _p{nullptr};
+    size_t      _n{0};
+    char        _ch{0};
+    bool        _is_char{false};
+};
+
+/// Returns the total length of pieces[0, count)
+constexpr size_t concat_length(const concat_piece* pieces, size_t count) noexcept
+{
+    size_t len = 0;
+    for (size_t i = 0; i < count; ++i)
+        len += pieces[i].length();
+    return len;
+}
+
+/// Copies pieces[0, count) to out; returns the end of them
+constexpr char* concat_write(char* out, const concat_piece* pieces, size_t count) noexcept
+{
+    for (size_t i = 0; i < count; ++i)
+        out = pieces[i].write(out);
+    return out;
+}
+
+/**
+ * @brief A pending concatenation of N pieces
+ *
+ * The pieces are views, so this is meant to be turned into a string
+ * within the expression that made it. Note that auto s = a + b; makes
+ * s one of these, not a string.
+ */
+template <size_t N>
+class concat_expr
+{
+public:
+
+    /// Number of pieces
+    static constexpr size_t piece_count = N;
+
+    /// Returns the expression with piece appended
+    constexpr concat_expr<N + 1> then(concat_piece piece) const noexcept
+    {
+        concat_expr<N + 1> ret;
+        for (size_t i = 0; i < N; ++i)
+            ret.pieces[i] = pieces[i];
+        ret.pieces[N] = piece;
+        return ret;
+    }
+
+    /// Returns the expression with piece prepended
+    constexpr concat_expr<N + 1> after(concat_piece piece) const noexcept
+    {
+        concat_expr<N + 1> ret;
+        ret.pieces[0] = piece;
+        for (size_t i = 0; i < N; ++i)
+            ret.pieces[i + 1] = pieces[i];
+        return ret;
+    }
+
+    /// Returns the length of the concatenated string
+    constexpr size_t length() const noexcept
+        { return concat_length(pieces, N); }
+
+    /// Copies the concatenated string to out; returns the end of it
+    constexpr char* write(char* out) const noexcept
+        { return concat_write(out, pieces, N); }
+
+    // Hidden friends, so a + b + "lit" finds them by ADL from outside sys
+
+    template <concat_arg T>
+    friend constexpr concat_expr<N + 1> operator+(const concat_expr& lhs, const T& rhs) noexcept
+        { return lhs.then(concat_piece::of(rhs)); }
+
+    template <concat_arg T>
+    friend constexpr concat_expr<N + 1> operator+(const T& lhs, const concat_expr& rhs) noexcept
+        { return rhs.after(concat_piece::of(lhs)); }
+
+    template <size_t M>
+    friend constexpr concat_expr<N + M> operator+(const concat_expr& lhs, const concat_expr<M>& rhs) noexcept
+    {
+        concat_expr<N + M> ret;
+        for (size_t i = 0; i < N; ++i)
+            ret.pieces[i] = lhs.pieces[i];
+        for (size_t i = 0; i < M; ++i)
+            ret.pieces[N + i] = rhs.pieces[i];
+        return ret;
+    }
+
+    concat_piece pieces[N];
+};
+
+}   // end namespace imp
+
+_SYS_END_NS
+
+#endif // ifndef sys_imp_string_concat__included
@@ -0,0 +1,198 @@
+/**
+ * @file    string_search.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Substring search internals for string_view
+ *
+ * The guarantee comes from the Two-Way algorithm (Crochemore and Perrin,
+ * 1991): linear time in the worst case, constant space, and usable at
+ * compile time. Searching backwards is the same algorithm run over the
+ * reversed haystack and needle.
+ *
+ * At run time the kernels in char_traits.cpp get first crack. They filter
+ * a block of candidate positions at a time on the first and last chars of
+ * the needle and check the survivors in full. That's very fast on real
+ * text but quadratic on the wrong input (think "aaa...ab" in "aaa...a"),
+ * so the kernels keep count of the chars they've compared and hand off to
+ * Two-Way once that's out of proportion to the ground they've covered.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+
+#include <_core_.h>
+#include <type_traits_.h>
+#include <char_traits_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+// -- Run-time kernels (char_traits.cpp)
+//
+// Both take a needle of at least 2 chars that's no longer than the
+// haystack and return the position of the match, or n if there is none.
+// If a kernel gives up before it's done, it also returns n, and updates
+// its last argument to mark what's left to search.
+
+/// Searches h[at, n) for the first nd[0, m); on giving up, at is the first position not ruled out
+size_t find_str_kernel(const char* h, size_t n, const char* nd, size_t m, size_t& at) noexcept;
+/// Searches h[0, len) for the last nd[0, m); on giving up, a match can only be in h[0, len)
+size_t rfind_str_kernel(const char* h, size_t n, const char* nd, size_t m, size_t& len) noexcept;
+
+/// Sequence of chars as unsigned values, optionally reversed
+template <bool Reverse>
+struct search_seq
+{
+    const char* p;
+    size_t      n;
+
+    constexpr uint8_t operator[](size_t i) const noexcept
+        { return static_cast<uint8_t>(Reverse ? p[n - 1 - i] : p[i]); }
+};
+
+/**
+ * @brief Maximal suffix of x[0, m) under < (or > if flip is set)
+ *
+ * Returns the position the suffix starts at; its period is written to
+ * period.
+ */
+template <bool Reverse>
+constexpr size_t two_way_max_suffix(search_seq<Reverse> x, size_t m, bool flip, size_t& period) noexcept
+{
+    // This is the usual formulation, except that ms is one past the
+    // position it's normally kept as, so it never has to be -1.
+    size_t ms = 0, j = 0, k = 1, p = 1;
+    while (j + k < m) {
+        const uint8_t a = x[j + k];
+        const uint8_t b = x[ms + k - 1];
+        if (flip ? (a > b) : (a < b)) {
+            j += k;
+            k = 1;
+            p = j + 1 - ms;
+        }
+        else if (a == b) {
+            if (k != p)
+                ++k;
+            else {
+                j += p;
+                k = 1;
+            }
+        }
+        else {
+            ms = j + 1;
+            j  = ms;
+            k  = p = 1;
+        }
+    }
+
+    period = p;
+    return ms;
+}
+
+/**
+ * @brief Two-Way search for the first x[0, m) in y[0, n)
+ *
+ * Requires 0 < m <= n. Returns the position of the match, or n.
+ */
+template <bool Reverse>
+constexpr size_t two_way_search(search_seq<Reverse> y, size_t n, search_seq<Reverse> x, size_t m) noexcept
+{
+    // Critical factorization: x = x[0, ell) x[ell, m)
+    size_t p1 = 0, p2 = 0;
+    const size_t ms1 = two_way_max_suffix(x, m, false, p1);
+    const size_t ms2 = two_way_max_suffix(x, m, true,  p2);
+    const size_t ell = (ms1 > ms2) ? ms1 : ms2;
+    size_t per = (ms1 > ms2) ? p1 : p2;
+
+    bool periodic = true;
+    for (size_t i = 0; periodic && (i < ell); ++i)
+        periodic = (x[i] == x[i + per]);
+
+    if (periodic) {
+        // Positions below memory are known to match from the last attempt
+        size_t memory = 0;
+        for (size_t j = 0; j <= n - m; ) {
+            size_t i = (ell > memory) ? ell : memory;
+            while ((i < m) && (x[i] == y[i + j]))
+                ++i;
+            if (i < m) {
+                j += i + 1 - ell;
+                memory = 0;
+                continue;
+            }
+
+            i = ell;
+            while ((i > memory) && (x[i - 1] == y[i - 1 + j]))
+                --i;
+            if (i <= memory)
+                return j;
+            j += per;
+            memory = m - per;
+        }
+    }
+    else {
+        per = ((ell > m - ell) ? ell : m - ell) + 1;
+        for (size_t j = 0; j <= n - m; ) {
+            size_t i = ell;
+            while ((i < m) && (x[i] == y[i + j]))
+                ++i;
+            if (i < m) {
+                j += i + 1 - ell;
+                continue;
+            }
+
+            i = ell;
+            while (i && (x[i - 1] == y[i - 1 + j]))
+                --i;
+            if (!i)
+                return j;
+            j += per;
+        }
+    }
+
+    return n;
+}
+
+/// Returns the position of the first nd[0, m) in h[0, n), or n; requires 0 < m <= n
+constexpr size_t str_find_first(const char* h, size_t n, const char* nd, size_t m) noexcept
+{
+    if (m == 1) {
+        const char* p = char_traits<char>::find(h, n, nd[0]);
+        return p ? static_cast<size_t>(p - h) : n;
+    }
+
+    size_t at = 0;
+    if (!is_constant_evaluated()) {
+        const size_t i = find_str_kernel(h, n, nd, m, at);
+        if ((i < n) || (n - at < m))
+            return i;
+    }
+
+    const size_t i = two_way_search(search_seq<false>{h + at, n - at}, n - at,
+        search_seq<false>{nd, m}, m);
+    return (i < n - at) ? at + i : n;
+}
+
+/// Returns the position of the last nd[0, m) in h[0, n), or n; requires 0 < m <= n
+constexpr size_t str_find_last(const char* h, size_t n, const char* nd, size_t m) noexcept
+{
+    if (m == 1) {
+        const char* p = char_traits<char>::find_last(h, n, nd[0]);
+        return p ? static_cast<size_t>(p - h) : n;
+    }
+
+    size_t len = n;
+    if (!is_constant_evaluated()) {
+        const size_t i = rfind_str_kernel(h, n, nd, m, len);
+        if ((i < n) || (len < m))
+            return i;
+    }
+
+    const size_t i = two_way_search(search_seq<true>{h, len}, len, search_seq<true>{nd, m}, m);
+    return (i < len) ? len - m - i : n;
+}
+
+}   // end namespace imp
+
+_SYS_END_NS
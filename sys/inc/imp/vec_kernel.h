@@ -0,0 +1,126 @@
+/**
+ * @file    vec_kernel.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Helpers for the vectorized kernels in the runtime library
+ *
+ * Kernels are written once with the compiler's generic vector types for a
+ * block width of W bytes, then built for each target we care about (see
+ * charconv_bytes.cpp). This is for the library's .cpp files only; nothing
+ * here should show up in a public header.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef sys_imp_vec_kernel_included
+#define sys_imp_vec_kernel_included
+
+#include <_core_.h>
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#   define SYS_KERNEL_X86
+#endif
+
+/// Kernel building blocks are always inlined so they take on the target of the caller
+#define SYS_KERNEL inline __attribute__((always_inline))
+
+_SYS_BEGIN_NS
+namespace imp {
+
+/// Instruction sets we build kernels for
+enum class kernel_isa { base, ssse3, avx2 };
+
+/// Returns the best instruction set the CPU supports
+inline kernel_isa detect_kernel_isa() noexcept
+{
+#ifdef SYS_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return kernel_isa::avx2;
+    if (__builtin_cpu_supports("ssse3"))
+        return kernel_isa::ssse3;
+#endif
+    return kernel_isa::base;
+}
+
+template <class T, size_t W>
+struct vec_of
+{
+    typedef T type __attribute__((vector_size(W)));
+};
+
+/// A vector of W bytes of T
+template <class T, size_t W>
+using vec = typename vec_of<T, W>::type;
+
+template <class V>
+SYS_KERNEL void load(V& v, const void* p) noexcept
+{
+    __builtin_memcpy(&v, p, sizeof(v));
+}
+
+template <class V>
+SYS_KERNEL void store(void* p, const V& v) noexcept
+{
+    __builtin_memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * @brief Byte table lookup: out[i] = tbl[idx[i]]
+ *
+ * Each index must be below 16; a table wider than 16 bytes repeats itself
+ * in each 16-byte lane. This wants SSSE3 (pshufb) or better.
+ */
+template <class V>
+SYS_KERNEL void lookup16(V& out, const V& tbl, const V& idx) noexcept
+{
+    out = __builtin_shuffle(tbl, idx);
+}
+
+/// True if every lane of mask m is set
+template <class V>
+SYS_KERNEL bool all_set(const V& m) noexcept
+{
+    const auto w = reinterpret_cast<vec<uint64_t, sizeof(V)>>(m);
+    uint64_t all = ~uint64_t{0};
+    for (size_t i = 0; i < sizeof(V) / 8; ++i)
+        all &= w[i];
+    return all == ~uint64_t{0};
+}
+
+/// True if any lane of mask m is set
+template <class V>
+SYS_KERNEL bool any_set(const V& m) noexcept
+{
+    const auto w = reinterpret_cast<vec<uint64_t, sizeof(V)>>(m);
+    uint64_t any = 0;
+    for (size_t i = 0; i < sizeof(V) / 8; ++i)
+        any |= w[i];
+    return any != 0;
+}
+
+/// Index of the first set byte lane of mask m, which must have one
+template <class V>
+SYS_KERNEL size_t first_set(const V& m) noexcept
+{
+    const auto w = reinterpret_cast<vec<uint64_t, sizeof(V)>>(m);
+    size_t i = 0;
+    while (!w[i])
+        ++i;
+    return i * 8 + (static_cast<size_t>(__builtin_ctzll(w[i])) >> 3);
+}
+
+/// Index of the last set byte lane of mask m, which must have one
+template <class V>
+SYS_KERNEL size_t last_set(const V& m) noexcept
+{
+    const auto w = reinterpret_cast<vec<uint64_t, sizeof(V)>>(m);
+    size_t i = sizeof(V) / 8 - 1;
+    while (!w[i])
+        --i;
+    return i * 8 + 7 - (static_cast<size_t>(__builtin_clzll(w[i])) >> 3);
+}
+
+} // end namespace imp
+_SYS_END_NS
+
+#endif // ifndef sys_imp_vec_kernel_included
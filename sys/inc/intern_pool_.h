@@ -0,0 +1,283 @@
+/**
+ * @file    intern_pool_.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   sys::intern_pool: one shared copy of each string, named by a symbol
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef sys_intern_pool__included
+#define sys_intern_pool__included
+
+#include <_core_.h>
+#include <types_.h>
+#include <atomic_.h>
+#include <mutex_.h>
+#include <compare_.h>
+#include <string_view_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+/// Returns a 64-bit hash of p[0, len) (intern_pool.cpp)
+uint64_t hash_bytes(const char* p, size_t len) noexcept;
+
+/// An interned string, as it's kept in a pool's arena; the chars follow it
+struct symbol_entry
+{
+    uint64_t    hash;
+    uint32_t    id;
+    uint32_t    length;
+
+    const char* text() const noexcept
+        { return reinterpret_cast<const char*>(this + 1); }
+};
+
+/**
+ * @brief The storage and lookup behind intern_pool and sharded_intern_pool
+ *
+ * Entries are bump-allocated from an arena and never move or go away until
+ * the table does. They're found through an open-addressed hash table of
+ * entry pointers, and by id through a list of segments that double in
+ * size.
+ *
+ * find() and from_local_id() only read, and are safe to call while
+ * another thread is in insert(); inserts have to be serialized by the
+ * caller. A slot is filled in after the entry it points at, and the hash
+ * table is replaced rather than grown in place, with the old one kept
+ * around for any reader still probing it.
+ */
+class intern_table
+{
+public:
+
+    /// Largest string that can be interned
+    static constexpr size_t max_length = uint32_t(-1);
+
+    intern_table() noexcept = default;
+    ~intern_table() noexcept;
+
+    intern_table(const intern_table&) = delete;
+    intern_table& operator=(const intern_table&) = delete;
+
+    /// Returns the entry for sv (whose hash is h), or nullptr
+    const symbol_entry* find(string_view sv, uint64_t h) const noexcept;
+
+    /// Adds sv, which mustn't be here already, with id (local id << id_shift) | id_tag
+    const symbol_entry* insert(string_view sv, uint64_t h, unsigned id_shift = 0, uint32_t id_tag = 0);
+
+    /// Returns the entry with the given local id, or nullptr
+    const symbol_entry* from_local_id(uint32_t local_id) const noexcept;
+
+    /// Returns the number of entries
+    size_t size() const noexcept
+        { return _count.load(memory_order::acquire); }
+
+    /// Returns the number of bytes of arena in use
+    size_t arena_used() const noexcept
+        { return _arena_used; }
+
+private:
+
+    struct slots;
+    struct block;
+
+    /// Returns room for an entry of len chars
+    symbol_entry* arena_alloc(size_t len);
+    /// Moves everything into a hash table twice the size
+    void grow();
+    /// Records e under its local id
+    void add_id(const symbol_entry* e, uint32_t local_id);
+
+    /// Segment s of the id list holds (1 << seg_base_shift) << s entries
+    static constexpr unsigned seg_base_shift = 6;
+    static constexpr unsigned seg_count = 32 - seg_base_shift;
+
+    atomic<slots*>          _slots{nullptr};    ///< Older tables hang off prev
+    block*                  _blocks{nullptr};   ///< The arena
+    size_t                  _arena_used{0};
+    const symbol_entry**    _ids[seg_count]{};  ///< Read only below _count
+    atomic<uint32_t>        _count{0};
+};
+
+}   // end namespace imp
+
+/**
+ * @brief A handle to an interned string
+ *
+ * A symbol is a single pointer into the pool that made it. Two symbols from
+ * the same pool are equal exactly when their strings are, so comparing
+ * them is a pointer compare, and the string's hash is kept with it. The
+ * default symbol is the null symbol: id 0, and an empty view.
+ *
+ * A symbol is valid for as long as its pool is. Symbols from different
+ * pools are never equal.
+ */
+class symbol
+{
+public:
+
+    /// Constructs the null symbol
+    constexpr symbol() noexcept = default;
+
+    /// Returns the id: small, dense within a pool, and never 0 for a real symbol
+    constexpr uint32_t id() const noexcept
+        { return _e ? _e->id : 0; }
+
+    /// Returns the hash of the string (0 for the null symbol)
+    constexpr uint64_t hash() const noexcept
+        { return _e ? _e->hash : 0; }
+
+    constexpr size_t length() const noexcept
+        { return _e ? _e->length : 0; }
+
+    /// Returns the string; the view is good for as long as the pool is
+    string_view view() const noexcept
+        { return _e ? string_view(_e->text(), _e->length) : string_view(); }
+
+    /// Returns the string, null terminated
+    const char* c_str() const noexcept
+        { return _e ? _e->text() : ""; }
+
+    operator string_view() const noexcept
+        { return view(); }
+
+    /// Returns true if this isn't the null symbol
+    constexpr explicit operator bool() const noexcept
+        { return nullptr != _e; }
+
+    friend constexpr bool operator==(symbol lhs, symbol rhs) noexcept
+        { return lhs._e == rhs._e; }
+
+    /**
+     * @brief Orders by id, then by pool
+     *
+     * An intern_pool's ids go up in the order its symbols were made. A
+     * sharded_intern_pool's only do within a shard, since the shard is in
+     * the low bits. Ids are only unique within a pool, so symbols from
+     * different pools with the same id are ordered by where they live,
+     * which keeps the ordering consistent with ==.
+     */
+    friend strong_ordering operator<=>(symbol lhs, symbol rhs) noexcept
+    {
+        if (const auto cmp = lhs.id() <=> rhs.id(); cmp != 0)
+            return cmp;
+        return reinterpret_cast<uintptr_t>(lhs._e) <=> reinterpret_cast<uintptr_t>(rhs._e);
+    }
+
+private:
+
+    friend class intern_pool;
+    friend class sharded_intern_pool;
+
+    constexpr explicit symbol(const imp::symbol_entry* e) noexcept : _e(e) {}
+
+    const imp::symbol_entry* _e{nullptr};
+};
+
+/**
+ * @brief A pool of interned strings
+ *
+ * Interning a string returns the pool's symbol for it, adding a copy the
+ * first time it's seen. The copies live in an arena that's freed with the
+ * pool.
+ *
+ * Not for use by more than one thread at a time; see sharded_intern_pool.
+ */
+class intern_pool
+{
+public:
+
+    intern_pool() noexcept = default;
+
+    intern_pool(const intern_pool&) = delete;
+    intern_pool& operator=(const intern_pool&) = delete;
+
+    /// Returns the symbol for sv, adding it if it's new
+    symbol intern(string_view sv)
+    {
+        const auto h = imp::hash_bytes(sv.data(), sv.length());
+        auto e = _table.find(sv, h);
+        return symbol(e ? e : _table.insert(sv, h));
+    }
+
+    /// Returns the symbol for sv, or the null symbol if it's not in the pool
+    symbol find(string_view sv) const noexcept
+        { return symbol(_table.find(sv, imp::hash_bytes(sv.data(), sv.length()))); }
+
+    /// Returns the symbol with the given id, or the null symbol
+    symbol from_id(uint32_t id) const noexcept
+        { return symbol(_table.from_local_id(id)); }
+
+    /// Returns the number of symbols in the pool
+    size_t size() const noexcept
+        { return _table.size(); }
+
+private:
+
+    imp::intern_table _table;
+};
+
+/**
+ * @brief A pool of interned strings that any number of threads can use
+ *
+ * The strings are spread over shard_count pools by hash, each with its own
+ * lock, so threads adding different strings rarely wait on each other.
+ * Looking up a string that's already in the pool takes no lock at all,
+ * which is the common case once a program's names have been seen.
+ *
+ * An id's low shard_bits are its shard, so ids are unique across the pool
+ * but only dense within each shard.
+ */
+class sharded_intern_pool
+{
+public:
+
+    static constexpr unsigned shard_bits  = 4;
+    static constexpr size_t   shard_count = size_t(1) << shard_bits;
+
+    sharded_intern_pool() noexcept = default;
+
+    sharded_intern_pool(const sharded_intern_pool&) = delete;
+    sharded_intern_pool& operator=(const sharded_intern_pool&) = delete;
+
+    /// Returns the symbol for sv, adding it if it's new
+    symbol intern(string_view sv);
+
+    /// Returns the symbol for sv, or the null symbol if it's not in the pool
+    symbol find(string_view sv) const noexcept
+    {
+        const auto h = imp::hash_bytes(sv.data(), sv.length());
+        return symbol(shard_of(h).table.find(sv, h));
+    }
+
+    /// Returns the symbol with the given id, or the null symbol
+    symbol from_id(uint32_t id) const noexcept
+    {
+        return symbol(_shards[id & (shard_count - 1)].table.from_local_id(id >> shard_bits));
+    }
+
+    /// Returns the number of symbols in the pool
+    size_t size() const noexcept;
+
+private:
+
+    struct shard
+    {
+        imp::intern_table   table;
+        mutex               lock;
+    };
+
+    // The low bits of the hash pick the hash table slot, so use the top ones
+    shard& shard_of(uint64_t h) noexcept
+        { return _shards[h >> (64 - shard_bits)]; }
+    const shard& shard_of(uint64_t h) const noexcept
+        { return _shards[h >> (64 - shard_bits)]; }
+
+    shard _shards[shard_count];
+};
+
+_SYS_END_NS
+
+#endif // ifndef sys_intern_pool__included
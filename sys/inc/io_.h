@@ -34,6 +34,18 @@ namespace open_mode {
     inline constexpr int create_new     = 0x40;
 }
 
+/// Output buffering policy for buffered streams
+enum class buffer_mode {
+    /// Pick line or full buffering based on the underlying device
+    automatic,
+    /// No buffering; every output operation goes straight to the device
+    none,
+    /// Buffer output until a newline is written or the buffer fills
+    line,
+    /// Buffer output until the buffer fills or the stream is flushed
+    full
+};
+
 class ostream;
 
 //unique_ptr<ostream>  stin;
@@ -38,6 +38,9 @@ public:
     /// Returns file open mode flags (sys::io::open_mode::*)
     int get_open_mode() const noexcept;
 
+    /// Returns true if the file refers to a terminal device
+    bool is_terminal() const noexcept;
+
     ssize_t read(void* dst, size_t count);
     ssize_t write(const void* src, size_t count);
 
@@ -69,6 +72,22 @@ public:
         return size_t(p - reinterpret_cast<uint8_t*>(dst));
     }
 
+    /**
+     * @brief   Read up to count bytes onto the end of dst
+     *
+     * The data is read straight into the string's storage, as read_all()
+     * does, and dst is then trimmed to what was actually read.
+     *
+     * @return Returns the number of bytes appended to dst
+     */
+    size_t read_append(sys::string& dst, size_t count)
+    {
+        const auto len = dst.length();
+        const auto got = read_all(dst.append_uninitialized(count), count);
+        dst.resize(len + got);
+        return got;
+    }
+
     size_t write_all(const void* src, size_t count)
     {
         auto p = reinterpret_cast<const uint8_t*>(src);
@@ -85,6 +104,17 @@ public:
         return size_t(p - reinterpret_cast<const uint8_t*>(src));
     }
 
+    /**
+     * @brief   Write all of parts[0, count), in order, with vectored writes
+     *
+     * Saves gathering scattered data (e.g., the chunks of a rope) into one
+     * buffer first.
+     *
+     * @return Returns total number of bytes written, which will be the sum
+     *  of the lengths of the parts if there were no errors.
+     */
+    size_t writev_all(const sys::string_view* parts, size_t count);
+
     enum class seek_mode_t : int {
         set,    // Seek to absolute file position
         cur,    // Seek relative to current file position
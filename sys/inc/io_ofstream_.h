@@ -17,42 +17,178 @@ namespace sys { class string; class string_view; };
 
 _SYS_IO_BEGIN_NS
 
+/**
+ * @brief Buffered output stream to a file
+ *
+ * Output is collected into a local buffer and handed to the file in bulk
+ * so that we're not making a system call for every character. How long
+ * output may linger in the buffer is determined by the buffer_mode:
+ *  - none: Output goes straight to the file
+ *  - line: Buffer is committed whenever a newline is written
+ *  - full: Buffer is committed only when full or explicitly flushed
+ *  - automatic: line for terminals, full for everything else (files, pipes)
+ *
+ * The buffer is committed when the stream is destroyed.
+ */
 class ofstream : public ostream
 {
     static constexpr int _fmode = sys::io::open_mode::read;
 
 public:
 
+    /// Default size of the output buffer, in chars
+    static constexpr size_t default_buffer_size = 4096;
+
     // MOOMOO temp:
-    constexpr explicit ofstream(native_file_type fd) : _file(fd) {}
+    explicit ofstream(native_file_type fd,
+        buffer_mode mode = buffer_mode::automatic,
+        size_t buf_size = default_buffer_size)
+        : _file(fd)
+    {
+        set_buffer_mode(mode, buf_size);
+    }
 
     /// Default construction
     constexpr ofstream() { }
     /// Construct from destination file pathname
-    explicit ofstream(const sys::string& dst) : _file(dst, _fmode) {}
+    explicit ofstream(const sys::string& dst,
+        buffer_mode mode = buffer_mode::automatic,
+        size_t buf_size = default_buffer_size)
+        : _file(dst, _fmode)
+    {
+        set_buffer_mode(mode, buf_size);
+    }
     /// Construct from destination file pathname
     template <string_view_like T>
-    constexpr explicit ofstream(const T& svl) : _file(svl, _fmode) {}
+    explicit ofstream(const T& svl,
+        buffer_mode mode = buffer_mode::automatic,
+        size_t buf_size = default_buffer_size)
+        : _file(svl, _fmode)
+    {
+        set_buffer_mode(mode, buf_size);
+    }
+
+    // -- Attributes
+
+    /// Returns the effective buffering mode (never automatic)
+    constexpr buffer_mode get_buffer_mode() const noexcept { return _mode; }
+
+    /// Returns the capacity of the output buffer; 0 if unbuffered
+    constexpr size_t get_buffer_size() const noexcept { return _buf_cap; }
+
+    /**
+     * @brief Change the buffering policy
+     *
+     * Any output buffered under the previous policy is committed first.
+     *
+     * @param mode      The new buffering mode
+     * @param buf_size  Size of the buffer in chars; ignored for
+     *  buffer_mode::none. A zero size disables buffering.
+     *
+     * @return Returns false if the previously buffered output could not
+     *  be written
+     */
+    bool set_buffer_mode(buffer_mode mode, size_t buf_size = default_buffer_size)
+    {
+        const bool flushed = sync();
+
+        if (mode == buffer_mode::automatic)
+            mode = _file.is_terminal() ? buffer_mode::line : buffer_mode::full;
+        if (0 == buf_size)
+            mode = buffer_mode::none;
+
+        if (mode == buffer_mode::none)
+            buf_size = 0;
+        if (buf_size != _buf_cap) {
+            _buf.reset(buf_size ? new char_t[buf_size] : nullptr);
+            _buf_cap = buf_size;
+        }
+
+        _mode = mode;
+        return flushed;
+    }
 
     // -- Implementation
 
-    ~ofstream() override {}
+    ~ofstream() override { sync(); }
     // No copying
     ofstream(const ofstream&) = delete;
     ofstream& operator=(const ofstream&) = delete;
     // Moving okay
-    ofstream(ofstream&&) noexcept = default;
-    ofstream& operator=(ofstream&&) noexcept = default;
+    ofstream(ofstream&& other) noexcept
+        : _file(sys::move(other._file)),
+          _buf(sys::move(other._buf)),
+          _buf_cap(sys::exchange(other._buf_cap, 0)),
+          _buf_len(sys::exchange(other._buf_len, 0)),
+          _mode(sys::exchange(other._mode, buffer_mode::none))
+    {}
+    ofstream& operator=(ofstream&& other) noexcept
+    {
+        if (this != &other) {
+            // Don't lose anything we have pending
+            sync();
+
+            _file    = sys::move(other._file);
+            _buf     = sys::move(other._buf);
+            _buf_cap = sys::exchange(other._buf_cap, 0);
+            _buf_len = sys::exchange(other._buf_len, 0);
+            _mode    = sys::exchange(other._mode, buffer_mode::none);
+        }
+        return *this;
+    }
 
 protected:
 
     /// Output given buffer to sink
     bool sink(const char_t* data, size_t length) override
-        { return _file.write_all(data, length) == length; }
+    {
+        if (_mode == buffer_mode::none)
+            return write_through(data, length);
+
+        // If this won't fit in what's left of the buffer, commit what we
+        // have. If it's too large for even an empty buffer then there's no
+        // point in copying it through; send it straight to the file.
+        if (length > _buf_cap - _buf_len) {
+            if (!sync())
+                return false;
+            if (length >= _buf_cap)
+                return write_through(data, length);
+        }
+
+        traits_t::copy(_buf.get() + _buf_len, data, length);
+        _buf_len += length;
+
+        if ((_mode == buffer_mode::line) &&
+            (string_view(data, length).find_last('\n') != string_view::npos))
+            return sync();
+
+        return true;
+    }
+
+    /// Commit buffered output to the file
+    bool sync() override
+    {
+        if (0 == _buf_len)
+            return true;
+
+        const size_t length = sys::exchange(_buf_len, 0);
+        return write_through(_buf.get(), length);
+    }
 
 private:
 
+    using traits_t = char_traits<char_t>;
+
+    /// Write given data directly to the file, bypassing the buffer
+    bool write_through(const char_t* data, size_t length)
+        { return _file.write_all(data, length) == length; }
+
     sys::io::file       _file;
+
+    unique_ptr<char_t[]> _buf;                      ///< Output buffer
+    size_t              _buf_cap{0};                ///< Buffer capacity
+    size_t              _buf_len{0};                ///< Buffered char count
+    buffer_mode         _mode{buffer_mode::none};   ///< Effective mode
 };
 
 _SYS_IO_END_NS
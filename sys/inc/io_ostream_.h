@@ -40,6 +40,18 @@ public:
         return *this;
     }
 
+    /// Output a run of chars; returns false if the device failed to take them
+    inline bool write(const char_t* data, size_t length)
+    {
+        return sink(data, length);
+    }
+
+    /// Commit any buffered output to the underlying device
+    inline bool flush()
+    {
+        return sync();
+    }
+
     // -- Implementation
 
     virtual ~ostream() {}
@@ -50,6 +62,9 @@ protected:
 
     /// Output given buffer to sink
     virtual bool sink(const char_t* data, size_t length) = 0;   // MDTODO : span
+
+    /// Commit any buffered output; unbuffered streams needn't bother
+    virtual bool sync() { return true; }
 };
 
 /// Output iterator that appends elements into a stream
@@ -70,6 +85,10 @@ struct ostream_iterator
     constexpr ostream_iterator& operator=(const value_type& value)
         { _stream.get().out(value); return *this; }
 
+    /// Append a contiguous run of chars in one shot
+    constexpr ostream_iterator& append(const value_type* src, size_t count)
+        { _stream.get().out(sys::string_view(src, count)); return *this; }
+
     constexpr ostream_iterator& operator*() noexcept
         { return *this; }
     constexpr ostream_iterator& operator++() noexcept
@@ -122,6 +122,18 @@ struct back_insert_iterator
     constexpr back_insert_iterator& operator=(typename T::value_type&& value)
         { _cont.get().push_back(sys::move(value)); return *this; }
 
+    /// Append a contiguous run of elements in one shot
+    constexpr back_insert_iterator& append(const typename T::value_type* src, size_t count)
+    {
+        if constexpr (requires (T& c) { c.append(src, count); })
+            _cont.get().append(src, count);
+        else {
+            while (count--)
+                _cont.get().push_back(*src++);
+        }
+        return *this;
+    }
+
     constexpr back_insert_iterator& operator*() noexcept
         { return *this; }
     constexpr back_insert_iterator& operator++() noexcept
@@ -149,6 +161,7 @@ struct null_insert_iterator
 
     constexpr null_insert_iterator& operator=(const T&) noexcept { return *this; }
     constexpr null_insert_iterator& operator=(T&&)      noexcept { return *this; }
+    constexpr null_insert_iterator& append(const T*, size_t) noexcept { return *this; }
     constexpr null_insert_iterator& operator*()         noexcept { return *this; }
     constexpr null_insert_iterator& operator++()        noexcept { return *this; }
     constexpr null_insert_iterator  operator++(int)     noexcept { return *this; }
@@ -169,6 +182,8 @@ struct count_insert_iterator
 
     constexpr count_insert_iterator& operator=(const T&) noexcept { _count++; return *this; }
     constexpr count_insert_iterator& operator=(T&&)      noexcept { _count++; return *this; }
+    constexpr count_insert_iterator& append(const T*, size_t count) noexcept
+        { _count += count; return *this; }
     constexpr count_insert_iterator& operator*()         noexcept { return *this; }
     constexpr count_insert_iterator& operator++()        noexcept { return *this; }
     constexpr count_insert_iterator& operator++(int)     noexcept { return *this; }
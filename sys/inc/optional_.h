@@ -175,7 +175,7 @@ public:
             !is_same_v<remove_cvref_t<U>, in_place_t> &&
             !is_same_v<remove_cvref_t<U>, optional> &&
             (!is_same_v<remove_cvref_t<U>, bool> ||
-                is_specialization<remove_cvref_t<U>, optional>::value)
+                is_specialization_v<remove_cvref_t<U>, optional>)
         )
     constexpr explicit(!is_convertible_v<U&&, T>) optional(U&& u)
     {
@@ -579,7 +579,7 @@ constexpr bool operator==(const optional<T>& opt, const U& val)
 }
 
 template <class T, class U>
-    requires (!is_specialization<U, optional>::value) &&
+    requires (!is_specialization_v<U, optional>) &&
         three_way_comparable_with<T, U>
 constexpr compare_three_way_result_t<T, U>
     operator<=> (const optional<T>& opt, const U& val)
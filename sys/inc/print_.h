@@ -12,16 +12,25 @@
 #include <_core_.h>
 #include <format_.h>
 #include <io_ostream_.h>
+#include "imp/fmt_sink.h"
 #include <string_view_.h>
 
 _SYS_BEGIN_NS
 
+/// Print a formatted string to a stream or file; output goes out in chunks
+template <class Dest, class... FmtArgs>
+    requires (is_base_of_v<io::ostream, Dest> || is_same_v<Dest, io::file>)
+inline void print(Dest& dest, format_string<FmtArgs...> fmt, FmtArgs&&... args)
+{
+    format_sink sink(dest);
+    format_to(back_insert_iterator(sink), fmt, forward<FmtArgs>(args)...);
+}
+
 /// Print an formatted string to standard output
 template <class... FmtArgs>
 inline void print(format_string<FmtArgs...> fmt, FmtArgs&&... args)
 {
-    io::ostream_iterator osi(*io::stout.get());
-    format_to(osi, fmt, forward<FmtArgs>(args)...);
+    print(*io::stout.get(), fmt, forward<FmtArgs>(args)...);
 }
 
 /// Print a formatted string to standard output with trailing newline
@@ -0,0 +1,299 @@
+/**
+ * @file    rope_.h
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   sys::rope: a string for large text assembled from many pieces
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef sys_rope__included
+#define sys_rope__included
+
+#include <_core_.h>
+#include <atomic_.h>
+#include <string_view_.h>
+#include <string_.h>
+
+_SYS_BEGIN_NS
+
+namespace io { class file; }
+
+namespace imp {
+
+/// Shared storage for rope text; chars are never changed once they're used
+struct rope_chunk
+{
+    rope_chunk() noexcept = default;
+    rope_chunk(imp::string_buf&& sbuf) noexcept : sbuf(sys::move(sbuf)) {}
+
+    /// Add a reference and return this
+    rope_chunk* add_ref() noexcept
+    {
+        ref_count++;
+        return this;
+    }
+
+    /// Drop a reference, deleting when 0
+    void release() noexcept
+    {
+        if (0 == --ref_count)
+            delete this;
+    }
+
+    /// Returns true if we hold the only reference
+    bool is_unique() const noexcept { return 1 == ref_count.load(); }
+
+    atomic<unsigned>    ref_count{1};
+    imp::string_buf     sbuf{};
+};
+
+/**
+ * @brief A node of a rope's tree
+ *
+ * Leaves refer to a run of a chunk; other nodes join two subtrees. Nodes
+ * are shared between ropes, and are only changed in place by a rope that
+ * holds the only reference.
+ */
+struct rope_node
+{
+    /// Returns true if this is a leaf (a run of chars)
+    bool is_leaf() const noexcept { return chunk != nullptr; }
+
+    /// Returns a leaf's chars
+    string_view view() const noexcept
+        { return string_view(chunk->sbuf.data() + offset, length); }
+
+    /// Add a reference and return this
+    rope_node* add_ref() noexcept
+    {
+        ref_count++;
+        return this;
+    }
+
+    /// Drop a reference, deleting when 0 (rope.cpp)
+    void release() noexcept;
+
+    /// Returns true if we hold the only reference
+    bool is_unique() const noexcept { return 1 == ref_count.load(); }
+
+    rope_node*          left{nullptr};      ///< Non-leaves: the subtrees
+    rope_node*          right{nullptr};
+    rope_chunk*         chunk{nullptr};     ///< Leaves: the chunk and where in it
+    size_t              offset{0};
+    size_t              length{0};          ///< Length of the text under this node
+    uint8_t             height{1};          ///< Leaves are 1
+    atomic<unsigned>    ref_count{1};
+};
+
+}   // end namespace imp
+
+/**
+ * @brief A string made of shared, immutable chunks
+ *
+ * The chunks hang off a balanced (AVL) tree that's ordered by position, so
+ * inserting, erasing, and taking a substring are O(log n) no matter the
+ * length, and they copy none of the text: a substring is a new tree over
+ * the same chunks. Copying a rope just shares its tree.
+ *
+ * Appending a string&& adopts its buffer, and appending a rope shares its
+ * tree. Anything else is copied into a chunk of chunk_capacity chars that
+ * later appends fill up, so assembling a document from many small pieces
+ * doesn't make a chunk for each one.
+ *
+ * The text can be had a chunk at a time (for_each_chunk(), write_to()), or
+ * flattened into contiguous storage when that's what's needed.
+ */
+class rope
+{
+public:
+
+    using char_t         = char;
+    using size_type      = size_t;
+
+    /// Special value. The exact meaning depends on the context
+    static constexpr size_type npos = size_type(-1);
+
+    /// Capacity of the chunks that copied text goes into
+    static constexpr size_type chunk_capacity = 4096;
+
+    /// Strings this short are copied rather than adopted
+    static constexpr size_type adopt_min_len = 64;
+
+    // -- Construction
+
+    /// Default constructor; constructs an empty rope
+    rope() noexcept = default;
+
+    /// Construct with a copy of sv
+    explicit rope(string_view sv)
+        { append(sv); }
+
+    /// Construct with a copy of NULL-terminated string s
+    explicit rope(const char_t* s)
+        { append(string_view(s)); }
+
+    /// Construct from a string, taking its buffer
+    explicit rope(string&& s)
+        { append(sys::move(s)); }
+
+    /// Copy constructor; shares other's text
+    rope(const rope& other) noexcept
+        : _root(other._root ? other._root->add_ref() : nullptr)
+    {}
+
+    /// Move constructor
+    rope(rope&& other) noexcept
+        : _root(other._root)
+    {
+        other._root = nullptr;
+    }
+
+    ~rope() noexcept
+        { clear(); }
+
+    /// Copy assignment; shares other's text
+    rope& operator=(const rope& other) noexcept
+    {
+        if (this != &other) {
+            rope tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    /// Move assignment
+    rope& operator=(rope&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    constexpr void swap(rope& other) noexcept
+    {
+        auto tmp = _root;
+        _root = other._root;
+        other._root = tmp;
+    }
+
+    // -- Attributes
+
+    /// Returns the length of the rope in chars
+    size_type length() const noexcept
+        { return _root ? _root->length : 0; }
+
+    [[nodiscard]] bool is_empty() const noexcept
+        { return nullptr == _root; }
+
+    /// Returns the char at pos, in O(log n); throws error_bounds if out of range
+    char_t at(size_type pos) const;
+
+    /// Returns the number of chunks the text is in
+    size_type chunk_count() const noexcept;
+
+    // -- Modifiers
+
+    /// Append a copy of sv
+    rope& append(string_view sv);
+
+    /// Append a string, taking its buffer if it's worth it
+    rope& append(string&& s);
+
+    /// Append another rope, sharing its text
+    rope& append(const rope& r);
+
+    /// Append a copy of NULL-terminated string s
+    rope& append(const char_t* s)
+        { return append(string_view(s)); }
+
+    /// Append a char
+    rope& append(char_t ch)
+        { return append(string_view(&ch, 1)); }
+
+    rope& operator+=(string_view sv)  { return append(sv); }
+    rope& operator+=(string&& s)      { return append(sys::move(s)); }
+    rope& operator+=(const rope& r)   { return append(r); }
+    rope& operator+=(const char_t* s) { return append(s); }
+    rope& operator+=(char_t ch)       { return append(ch); }
+
+    /// Insert a copy of sv at pos; throws error_bounds if pos > length()
+    rope& insert(size_type pos, string_view sv);
+
+    /// Insert a copy of NULL-terminated string s at pos
+    rope& insert(size_type pos, const char_t* s)
+        { return insert(pos, string_view(s)); }
+
+    /// Insert a string at pos, taking its buffer if it's worth it
+    rope& insert(size_type pos, string&& s);
+
+    /// Insert another rope at pos, sharing its text
+    rope& insert(size_type pos, const rope& r);
+
+    /// Remove up to count chars starting at pos; throws error_bounds if pos > length()
+    rope& erase(size_type pos, size_type count = npos);
+
+    /// Remove everything
+    void clear() noexcept
+    {
+        if (_root) {
+            _root->release();
+            _root = nullptr;
+        }
+    }
+
+    // -- Substrings and access
+
+    /// Returns the rope of up to count chars starting at pos; shares our text
+    rope substr(size_type pos, size_type count = npos) const;
+
+    /**
+     * @brief Puts the text into a single chunk and returns it
+     *
+     * This copies the text, unless it's already in one piece. The view is
+     * good until the rope is next modified.
+     */
+    string_view flatten();
+
+    /// Returns a copy of the text as a string
+    string to_string() const;
+
+    /// Calls f(string_view) with each run of the text, in order
+    template <class F>
+    void for_each_chunk(F&& f) const
+    {
+        if (_root)
+            visit(_root, f);
+    }
+
+    /// Writes the text to f with vectored writes; returns the number of bytes written
+    size_t write_to(io::file& f) const;
+
+    /// Compare to a string_view (<0, 0, >0)
+    int compare(string_view sv) const noexcept;
+
+    friend bool operator==(const rope& lhs, string_view rhs) noexcept
+        { return (lhs.length() == rhs.length()) && (0 == lhs.compare(rhs)); }
+
+private:
+
+    explicit rope(imp::rope_node* root) noexcept : _root(root) {}
+
+    template <class F>
+    static void visit(const imp::rope_node* n, F& f)
+    {
+        for (; !n->is_leaf(); n = n->right)
+            visit(n->left, f);
+        f(n->view());
+    }
+
+    /// Copies sv into the last chunk if we own it and it has room
+    bool append_in_place(string_view sv) noexcept;
+
+    imp::rope_node* _root{nullptr};
+};
+
+_SYS_END_NS
+
+#endif // ifndef sys_rope__included
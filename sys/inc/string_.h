@@ -15,9 +15,12 @@
 #include <utility_.h>
 #include <error_.h>
 #include "imp/string_buf.h"
+#include "imp/string_concat.h"
 
 _SYS_BEGIN_NS
 
+class rope;
+
 class string
 {
 public:
@@ -40,10 +43,16 @@ public:
 
 private:
 
-    /// Construct with default initialized data
-    constexpr explicit string(size_type count)
+    /**
+     * @brief Construct with count default initialized chars
+     *
+     * The capacity is what from would grow to in order to hold them, so a
+     * string that's rebuilt this way each time it grows still grows
+     * geometrically.
+     */
+    constexpr string(size_type count, const imp::string_buf& from)
     {
-        ensure_buf(_sbuf.calc_new_capacity(count), false);
+        ensure_buf(from.calc_new_capacity(count + 1) - 1, false, true);
         _sbuf.internal_set_length(count);
     }
 
@@ -93,6 +102,13 @@ public:
         traits_t::copy(ensure_buf(svl.length()), svl.data(), svl.length());
     }
 
+    /// Construct from a concatenation (a + b + ...), in a single allocation
+    template <size_t N>
+    constexpr string(const imp::concat_expr<N>& expr)
+    {
+        expr.write(ensure_buf(expr.length()));
+    }
+
     /// Copy constructor
     constexpr string(const string& other)
         : _sbuf(other._sbuf)
@@ -112,20 +128,20 @@ public:
 
     constexpr string& assign(char_t ch, size_type count)
     {
-        traits_t::fill(ensure_buf(count), ch, count);
+        traits_t::fill(overwrite_buf(count), ch, count);
         return *this;
     }
 
     constexpr string& assign(const string& str)
     {
-        traits_t::copy(ensure_buf(str.length()), str.data(), str.length());
+        traits_t::copy(overwrite_buf(str.length()), str.data(), str.length());
         return *this;
     }
 
     constexpr string& assign(const string& str, size_type pos, size_type count = npos)
     {
         string_view sv(str.substr_view(pos, count));
-        traits_t::copy(ensure_buf(sv.length()), sv.data(), sv.length());
+        traits_t::copy(overwrite_buf(sv.length()), sv.data(), sv.length());
 
         return *this;
     }
@@ -138,7 +154,7 @@ public:
 
     constexpr string& assign(const char_t* s, size_type count) noexcept
     {
-        traits_t::copy(ensure_buf(count), s, count);
+        traits_t::copy(overwrite_buf(count), s, count);
         return *this;
     }
 
@@ -150,7 +166,7 @@ public:
     template <string_view_like T>
     constexpr string& assign(const T& svl)
     {
-        traits_t::copy(ensure_buf(svl.length()), svl.data(), svl.length());
+        traits_t::copy(overwrite_buf(svl.length()), svl.data(), svl.length());
         return *this;
     }
 
@@ -158,7 +174,7 @@ public:
     constexpr string& assign(const T& svl, size_type pos, size_type count = npos)
     {
         string_view sv(svl.substr_view(pos, count));
-        traits_t::copy(ensure_buf(sv.length()), sv.data(), sv.length());
+        traits_t::copy(overwrite_buf(sv.length()), sv.data(), sv.length());
         return *this;
     }
 
@@ -183,6 +199,62 @@ public:
         (void)ensure_buf(count, false, true);
     }
 
+    /**
+     * @brief Resizes to count chars and lets op write them in place
+     *
+     * op is called as op(data(), count) and returns the final length, which
+     * can't be more than count. The first min(length(), count) chars are the
+     * current contents and any after that are indeterminate, so op should
+     * write every char it keeps beyond those. Unlike resize(), nothing is
+     * written on op's behalf. If op returns more than count this throws
+     * error_length and the string is left count chars long; e.g.,
+     *
+     *      s.resize_and_overwrite(32, [](char* p, size_t n)
+     *          { return to_chars(p, p + n, 42).ptr - p; });
+     */
+    template <class Op>
+    constexpr void resize_and_overwrite(size_type count, Op op)
+    {
+        char_t* p = ensure_buf(count, false);
+        const auto new_len = static_cast<size_type>(sys::move(op)(p, count));
+        if (new_len > count) [[unlikely]] {
+            // op may have written over the old terminator
+            _sbuf.internal_set_length(count);
+            throw sys::error_length();
+        }
+        _sbuf.internal_set_length(new_len);
+    }
+
+    /**
+     * @brief Reserves storage for count chars, discarding the contents
+     *
+     * The string is left empty. The current contents aren't copied if the
+     * buffer has to grow, so this is reserve() for when everything's about
+     * to be replaced.
+     *
+     * @return Returns the buffer address
+     */
+    constexpr char_t* reserve_discard(size_type count)
+    {
+        char_t* p = _sbuf.discard_buf(count, true);
+        _sbuf.internal_set_length(0);
+        return p;
+    }
+
+    /**
+     * @brief Grows the string by count chars that the caller will write
+     *
+     * The new chars are indeterminate until they're written; the string is
+     * terminated after them. If the caller ends up writing fewer, resize()
+     * back down.
+     *
+     * @return Returns the address of the first new char
+     */
+    constexpr char_t* append_uninitialized(size_type count)
+    {
+        return _sbuf.append_uninitialized(count);
+    }
+
     // - Clearing and deleting pieces of string
 
     /// Clear string content (including reserve)
@@ -231,6 +303,10 @@ public:
     /// Trim leading and/or trailing whitespace from string
     constexpr string& trim(bool trim_left = true, bool trim_right = true,
         string_view ws = " \t\n\r\f\v")
+        { return trim(char_set(ws.data(), ws.length()), trim_left, trim_right); }
+
+    /// Trim leading and/or trailing chars in the given set from string
+    constexpr string& trim(const char_set& ws, bool trim_left = true, bool trim_right = true)
     {
         if (trim_left)
             erase(0, find_first_not_of(ws));
@@ -286,7 +362,7 @@ protected:
         }
 
         // Generate a new string and become it
-        string st(length() + count);
+        string st(length() + count, _sbuf);
         traits_t::copy(st.data(), data(), pos);
         traits_t::fill(st.data() + pos,  ch, count);
         if (!appending)
@@ -317,7 +393,7 @@ protected:
         }
 
         // Generate a new string and become it
-        string st(length() + count);
+        string st(length() + count, _sbuf);
         traits_t::copy(st.data(), data(), pos);
         traits_t::copy(st.data() + pos, s, count);
         if (!appending)
@@ -325,6 +401,27 @@ protected:
         return *this = sys::move(st);
     }
 
+    constexpr string& impl_append_pieces(const imp::concat_piece* pieces, size_type count)
+    {
+        const size_type total = imp::concat_length(pieces, count);
+        check_length(total);
+
+        // Does it fit into current capacity? The pieces may be views of
+        // us, but only of what's before the end, so they're left intact.
+        const size_type len = length();
+        if (len + total <= capacity()) {
+            imp::concat_write(data() + len, pieces, count);
+            _sbuf.internal_set_length(len + total);
+            return *this;
+        }
+
+        // Generate a new string and become it
+        string st(len + total, _sbuf);
+        traits_t::copy(st.data(), data(), len);
+        imp::concat_write(st.data() + len, pieces, count);
+        return *this = sys::move(st);
+    }
+
 public:
 
     // -- Inserting and appending
@@ -445,6 +542,31 @@ public:
         string_view sub(svl.substr_view(svl_pos, svl_count));
         return impl_insert(npos, sub.data(), sub.length());
     }
+    /// Append a concatenation (a + b + ...)
+    template <size_t N>
+    constexpr string& append(const imp::concat_expr<N>& expr)
+    {
+        return impl_append_pieces(expr.pieces, N);
+    }
+
+    /**
+     * @brief Append any number of strings, views, raw strings, and chars
+     *
+     * The total length is worked out first, so this grows the buffer at
+     * most once. For example,
+     *
+     *      path.append_many(root, '/', dir, '/', name, ".txt");
+     */
+    template <concat_arg... Args>
+    constexpr string& append_many(const Args&... args)
+    {
+        if constexpr (sizeof...(Args) == 0)
+            return *this;
+        else {
+            const imp::concat_piece pieces[] = { imp::concat_piece::of(args)... };
+            return impl_append_pieces(pieces, sizeof...(Args));
+        }
+    }
 
     // -- Element access
 
@@ -554,6 +676,9 @@ public:
         return sv_this.find_first(ch, pos);
     }
 
+    /// Finds the first char that is in the given set
+    constexpr size_type find_first_of(const char_set& set, size_type pos = 0) const noexcept
+        { return substr_view().find_first_of(set, pos); }
     /// Finds the first char equal to any of the chars in the given sequence
     constexpr size_type find_first_of(const string& s, size_type pos = 0) const noexcept
         { return substr_view().find_first_of(s, pos); }
@@ -571,6 +696,9 @@ public:
     constexpr size_type find_first_of(const T& svl, size_type pos = 0) const noexcept
         { return substr_view().find_first_of(static_cast<string_view>(svl), pos); }
 
+    /// Finds the first char that isn't in the given set
+    constexpr size_type find_first_not_of(const char_set& set, size_type pos = 0) const noexcept
+        { return substr_view().find_first_not_of(set, pos); }
     /// Finds the first char not equal to any of the chars in the given sequence
     constexpr size_type find_first_not_of(const string& s, size_type pos = 0) const noexcept
         { return substr_view().find_first_not_of(s, pos); }
@@ -609,6 +737,9 @@ public:
     constexpr size_type find_last(char_t ch, size_type pos = npos) const noexcept
         { return substr_view().find_last(ch, pos); }
 
+    /// Finds the last char, at or before pos, that is in the given set
+    constexpr size_type find_last_of(const char_set& set, size_type pos = npos) const noexcept
+        { return substr_view().find_last_of(set, pos); }
     /// Finds the last char equal to one of chars in the given sequence
     constexpr size_type find_last_of(const string& s, size_type pos = npos) const noexcept
         { return substr_view().find_last_of(s, pos); }
@@ -626,6 +757,9 @@ public:
     constexpr size_type find_last_of(const T& svl, size_type pos = npos)
         { return substr_view().find_last_of(svl, pos); }
 
+    /// Finds the last char, at or before pos, that isn't in the given set
+    constexpr size_type find_last_not_of(const char_set& set, size_type pos = npos) const noexcept
+        { return substr_view().find_last_not_of(set, pos); }
     /// Finds the last char not equal to one of chars in the given sequence
     constexpr size_type find_last_not_of(const string& s, size_type pos = npos) const noexcept
         { return substr_view().find_last_not_of(s, pos); }
@@ -731,7 +865,7 @@ protected:
         }
 
         // We need to allocate a new buffer. Build up from a new string.
-        string tmp(length() + sv.length() - count);
+        string tmp(length() + sv.length() - count, _sbuf);
         // Copy the possible "head" (aaaa)
         if (pos) traits_t::copy(tmp.data(), data(), pos);
         // Copy the inserted string
@@ -785,7 +919,7 @@ protected:
         }
 
         // We need to allocate a new buffer. Build up from a new string.
-        string tmp(length() + ch_count - count);
+        string tmp(length() + ch_count - count, _sbuf);
         // Copy the possible "head" (aaaa)
         if (pos) traits_t::copy(tmp.data(), data(), pos);
         // Copy the inserted string
@@ -931,7 +1065,7 @@ public:
     constexpr string& operator=(const char_t* s)
     {
         auto len = traits_t::length(s);
-        traits_t::copy(ensure_buf(len), s, len);
+        traits_t::copy(overwrite_buf(len), s, len);
 
         return *this;
     }
@@ -940,7 +1074,7 @@ public:
     template <string_view_like T>
     constexpr string& operator=(const T& svl)
     {
-        traits_t::copy(ensure_buf(svl.length()), svl.data(), svl.length());
+        traits_t::copy(overwrite_buf(svl.length()), svl.data(), svl.length());
         return *this;
     }
 
@@ -953,6 +1087,9 @@ public:
     template <string_view_like T>
     constexpr string& operator+=(const T& svl)
         { return append(svl); }
+    template <size_t N>
+    constexpr string& operator+=(const imp::concat_expr<N>& expr)
+        { return append(expr); }
 
     constexpr operator sys::string_view() const noexcept
     {
@@ -1023,6 +1160,12 @@ private:
         return _sbuf.ensure_buf(count, set_length, explicit_reserve);
     }
 
+    /// Like ensure_buf (setting the length), but the contents aren't kept
+    constexpr char_t* overwrite_buf(size_type count)
+    {
+        return _sbuf.discard_buf(count);
+    }
+
     /// Check that iterator is valid for this string
     constexpr void check_it(const_iterator it) const
     {
@@ -1052,10 +1195,37 @@ private:
     }
 
     friend exception::exception(string&&);
+    friend class rope;                  // Adopts our buffer
 
     imp::string_buf _sbuf;          ///< The string buffer
 };
 
+// -- Concatenation
+//
+// These build an imp::concat_expr, which becomes a string once the whole
+// expression is known; the operators that extend one are its friends. See
+// imp/string_concat.h.
+
+template <concat_arg T>
+constexpr imp::concat_expr<2> operator+(const string& lhs, const T& rhs) noexcept
+    { return imp::concat_expr<1>{ string_view(lhs) }.then(imp::concat_piece::of(rhs)); }
+
+template <concat_arg T> requires (!is_same_v<T, string>)
+constexpr imp::concat_expr<2> operator+(const T& lhs, const string& rhs) noexcept
+    { return imp::concat_expr<1>{ string_view(rhs) }.after(imp::concat_piece::of(lhs)); }
+
+/**
+ * @brief Returns the concatenation of any number of strings, views, raw
+ *  strings, and chars, made with a single allocation
+ */
+template <concat_arg... Args>
+constexpr string concat(const Args&... args)
+{
+    string ret;
+    ret.append_many(args...);
+    return ret;
+}
+
 _SYS_END_NS
 
 #endif // ifndef sys_String__included
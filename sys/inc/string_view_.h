@@ -14,7 +14,9 @@
 #include <memory_.h>
 #include <iterator_.h>
 #include <char_traits_.h>
+#include <char_set_.h>
 #include "imp/string_helper.h"
+#include "imp/string_search.h"
 
 _SYS_BEGIN_NS
 
@@ -155,6 +157,10 @@ public:
     /// Trim leading and/or trailing whitespace from string_view
     constexpr string_view& trim(bool trim_left = true, bool trim_right = true,
         string_view ws = " \t\n\r\f\v")
+        { return trim(char_set(ws.data(), ws.length()), trim_left, trim_right); }
+
+    /// Trim leading and/or trailing chars in the given set from string_view
+    constexpr string_view& trim(const char_set& ws, bool trim_left = true, bool trim_right = true)
     {
         if (trim_left) {
             auto p = find_first_not_of(ws);
@@ -209,7 +215,11 @@ public:
 
     // -- Search
 
-    /// Finds the first substring equal to the given character sequence
+    /**
+     * @brief Finds the first substring equal to the given character sequence
+     *
+     * Linear time in the worst case; see imp/string_search.h
+     */
     constexpr size_type find_first(string_view str, size_type pos = 0) const noexcept
     {
         if (is_empty() || (pos >= length())) [[unlikely]]
@@ -217,14 +227,12 @@ public:
         if (str.is_empty()) [[unlikely]]
             return pos;
 
-        if (length() >= str.length()) {
-            for (; pos < length() - str.length() + 1; ++pos) {
-                if (0 == traits_t::compare(&at(pos), str.data(), str.length()))
-                    return pos;
-            }
-        }
+        const size_type len = length() - pos;
+        if (len < str.length())
+            return npos;
 
-        return npos;
+        const size_type i = imp::str_find_first(data() + pos, len, str.data(), str.length());
+        return (i < len) ? pos + i : npos;
     }
     /// Finds the first substring equal to the given character sequence
     constexpr size_type find_first(const char_t* s, size_type pos = 0) const noexcept
@@ -238,15 +246,15 @@ public:
         if (is_empty() || (pos >= length())) [[unlikely]]
             return npos;
 
-        for (auto p = data() + pos; p<data() + length(); ++p) {
-            if (*p == ch)
-                return p - data();
-        }
-
-        return npos;
+        const auto p = traits_t::find(data() + pos, length() - pos, ch);
+        return p ? size_type(p - data()) : npos;
     }
 
-    /// Find the last occurrence of a substring
+    /**
+     * @brief Find the last occurrence of a substring
+     *
+     * Linear time in the worst case; see imp/string_search.h
+     */
     constexpr size_type find_last(string_view s, size_type pos = npos) const noexcept
     {
         // If we are empty then we can't find anything
@@ -261,23 +269,16 @@ public:
         if (s.is_empty()) [[unlikely]]
              return pos;
 
-        // Depending on the length of the search string, we may be able to
-        // jump over positions that can't possibly match. For example, if
-        // searching for "banana" then it doesn't make any sense to consider
-        // the last 5 positions of the string since we need 6 chars to
-        // match. If we happen to jump before the start of the string (i.e.,
-        // the search string is longer than the source string) then the loop
-        // below won't run and we return npos.
+        if (length() < s.length())
+            return npos;
+
+        // A match starts no later than pos, so it ends inside the first len chars
         if (pos > length() - s.length())
             pos = length() - s.length();
-        auto p = data() + pos;
-
-        for (; p >= data(); --p) {
-            if (0 == traits_t::compare(p, s.data(), s.length()))
-                return p - data();
-        }
+        const size_type len = pos + s.length();
 
-        return npos;
+        const size_type i = imp::str_find_last(data(), len, s.data(), s.length());
+        return (i < len) ? i : npos;
     }
     /// Find the last occurrence of a substring
     constexpr size_type find_last(const char_t* s, size_type pos = npos) const noexcept
@@ -292,24 +293,30 @@ public:
         if (is_empty()) [[unlikely]]
             return npos;
 
-        auto p = (pos < length()) ? (data() + pos) : (data() + length() - 1);
-        for (; p >= data() && (*p != ch); --p);
-        return (p < data()) ? npos : size_type(p - data());
+        const size_type count = (pos < length()) ? pos + 1 : length();
+        const auto p = traits_t::find_last(data(), count, ch);
+        return p ? size_type(p - data()) : npos;
     }
 
+    /// Finds the first char that is in the given set
+    constexpr size_type find_first_of(const char_set& set, size_type pos = 0) const noexcept
+    {
+        if (pos >= length())
+            return npos;
+
+        const size_type i = set.find_first(data() + pos, length() - pos);
+        return (i < length() - pos) ? pos + i : npos;
+    }
     /// Finds the first char equal to any of the chars in the given sequence
     constexpr size_type find_first_of(string_view sv, size_type pos = 0) const noexcept
     {
-        for (; pos < length(); ++pos) {
-            if (npos != sv.find_first(data()[pos]))
-                return pos;
-        }
-
-        return npos;
+        if (sv.length() == 1)
+            return find_first(sv.front(), pos);
+        return find_first_of(char_set(sv.data(), sv.length()), pos);
     }
     /// Finds the first occurence of char in string
     constexpr size_type find_first_of(char_t ch, size_type pos = 0) const noexcept
-        { return find_first_of(&ch, 1, pos); }
+        { return find_first(ch, pos); }
     /// Finds the first char equal to any of the chars in the given sequence
     constexpr size_type find_first_of(const char_t* s, size_type count, size_type pos) const noexcept
         { return find_first_of(string_view(s, count), pos); }
@@ -317,20 +324,18 @@ public:
     constexpr size_type find_first_of(const char_t* s, size_type pos = 0) const noexcept
         { return find_first_of(string_view(s), pos); }
 
-    /// Finds first char equal to none of the chars in the given sequence
-    constexpr size_type find_first_not_of(string_view sv, size_type pos = 0) const noexcept
+    /// Finds the first char that isn't in the given set
+    constexpr size_type find_first_not_of(const char_set& set, size_type pos = 0) const noexcept
     {
-        // If we are empty then we can't find anything
-        if (is_empty()) [[unlikely]]
+        if (pos >= length())
             return npos;
 
-        for (; pos < length(); ++pos) {
-            if (npos == sv.find_first(data()[pos]))
-                return pos;
-        }
-
-        return npos;
+        const size_type i = set.find_first(data() + pos, length() - pos, false);
+        return (i < length() - pos) ? pos + i : npos;
     }
+    /// Finds first char equal to none of the chars in the given sequence
+    constexpr size_type find_first_not_of(string_view sv, size_type pos = 0) const noexcept
+        { return find_first_not_of(char_set(sv.data(), sv.length()), pos); }
     constexpr size_type find_first_not_of(char_t ch, size_type pos = 0) const noexcept
         { return find_first_not_of(string_view(&ch, 1), pos); }
     constexpr size_type find_first_not_of(const char_t* s, size_type count, size_type pos) const noexcept
@@ -338,40 +343,36 @@ public:
     constexpr size_type find_first_not_of(const char_t* s, size_type pos = 0) const noexcept
         { return find_first_not_of(string_view(s), pos); }
 
+    /// Finds the last char, at or before pos, that is in the given set
+    constexpr size_type find_last_of(const char_set& set, size_type pos = npos) const noexcept
+    {
+        const size_type count = (pos < length()) ? pos + 1 : length();
+        const size_type i = set.find_last(data(), count);
+        return (i < count) ? i : npos;
+    }
     /// Finds the last char equal to one of chars in the given sequence
     constexpr size_type find_last_of(string_view sv, size_type pos = npos) const noexcept
     {
-        // If we are empty then we can't find anything
-        if (is_empty()) [[unlikely]]
-            return npos;
-
-        auto p = (pos < length()) ? (data() + pos) : (data() + length() - 1);
-        for (; p > data(); --p) {
-            if (sv.find_first(*p) != npos)
-                return size_type(p - data());
-        }
-        return npos;
+        if (sv.length() == 1)
+            return find_last(sv.front(), pos);
+        return find_last_of(char_set(sv.data(), sv.length()), pos);
     }
     constexpr size_type find_last_of(char_t ch, size_type pos = npos) const noexcept
-        { return find_last_of(string_view(&ch, 1), pos); }
+        { return find_last(ch, pos); }
     constexpr size_type find_last_of(const char_t* s, size_type count, size_type pos) const noexcept
         { return find_last_of(string_view(s, count), pos); }
     constexpr size_type find_last_of(const char_t* s, size_type pos = npos) const noexcept
         { return find_last_of(string_view(s), pos); }
 
-    constexpr size_type find_last_not_of(string_view sv, size_type pos = npos) const noexcept
+    /// Finds the last char, at or before pos, that isn't in the given set
+    constexpr size_type find_last_not_of(const char_set& set, size_type pos = npos) const noexcept
     {
-        // If we are empty then we can't find anything
-        if (is_empty()) [[unlikely]]
-            return npos;
-
-        auto p = (pos < length()) ? (data() + pos) : (data() + length() - 1);
-        for (; p > data(); --p) {
-            if (sv.find_first(*p) == npos)
-                return size_type(p - data());
-        }
-        return npos;
+        const size_type count = (pos < length()) ? pos + 1 : length();
+        const size_type i = set.find_last(data(), count, false);
+        return (i < count) ? i : npos;
     }
+    constexpr size_type find_last_not_of(string_view sv, size_type pos = npos) const noexcept
+        { return find_last_not_of(char_set(sv.data(), sv.length()), pos); }
     constexpr size_type find_last_not_of(char_t ch, size_type pos = npos) const noexcept
         { return find_last_not_of(string_view(&ch, 1), pos); }
     constexpr size_type find_last_not_of(const char_t* s, size_type count, size_type pos) const noexcept
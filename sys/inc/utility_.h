@@ -51,6 +51,16 @@ constexpr void swap<void*> (void*& a, void*& b) noexcept
     b          = sys::move(temp);
 }
 
+/// Replaces the value of obj with new_value and returns the old value
+template <class T, class U = T>
+constexpr T exchange(T& obj, U&& new_value)
+    noexcept(is_nothrow_move_constructible_v<T> && is_nothrow_assignable_v<T&, U>)
+{
+    T old_value = sys::move(obj);
+    obj = sys::forward<U>(new_value);
+    return old_value;
+}
+
 /// Returns the minimum of two values
 template <arithmetic T>     // Probably need to loosen this
 constexpr const T& min(const T& a, const T& b)
@@ -345,12 +345,30 @@ public:
             throw error_variant_access{};
     }
 
+    template <size_t Idx = 0, class Visitor>
+    constexpr decltype(auto) impl_visit(Visitor&& vis) const
+    {
+        if (get_index() == Idx)
+            return sys::invoke(forward<Visitor>(vis), *get_if<Idx>());
+
+        else if constexpr (Idx + 1 < tl::size<my_types>)
+            return impl_visit<Idx + 1, Visitor>(forward<Visitor>(vis));
+        else
+            throw error_variant_access{};
+    }
+
     template <class Visitor>
     constexpr decltype(auto) visit(Visitor&& vis)
     {
         return impl_visit(forward<Visitor>(vis));
     }
 
+    template <class Visitor>
+    constexpr decltype(auto) visit(Visitor&& vis) const
+    {
+        return impl_visit(forward<Visitor>(vis));
+    }
+
     // -- Assignment
 
     /// Copy assignment from another variant
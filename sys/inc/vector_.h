@@ -266,8 +266,11 @@ public:
         return il == cend();
     }
 
-    constexpr compare_three_way_result_t<T> operator<=>(const vector<T>& rhs) const
-        requires three_way_comparable<T>
+    // Note: U defers forming the result type until use, so vector<T> is
+    //       still usable when T has no <=>
+    template <class U = T>
+        requires three_way_comparable<U>
+    constexpr compare_three_way_result_t<U> operator<=>(const vector<T>& rhs) const
     {
         // First check size
         auto sc = size() <=> rhs.size();
@@ -0,0 +1,247 @@
+/**
+ * @file    intern_pool.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements sys::intern_pool and sys::sharded_intern_pool
+ *
+ * Nothing a reader can see is ever changed or freed while the table is
+ * alive. An entry is written in full before the slot that points at it is
+ * stored (release), and readers load slots with acquire, so a reader that
+ * finds an entry sees all of it. The hash table is never resized in place:
+ * grow() builds a bigger one, publishes it, and keeps the old one until the
+ * end, since a reader may still be probing it. A reader that's looking at
+ * an old table may miss an entry that was just added, which is fine; the
+ * interning paths look again under their lock before inserting.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <intern_pool_.h>
+#include <new_.h>
+#include <imp/string_helper.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+namespace {
+
+constexpr uint64_t hash_k0 = 0x9e3779b97f4a7c15ull;
+constexpr uint64_t hash_k1 = 0xbf58476d1ce4e5b9ull;
+constexpr uint64_t hash_k2 = 0x94d049bb133111ebull;
+
+constexpr uint64_t rotl(uint64_t v, unsigned n) noexcept
+    { return (v << n) | (v >> (64 - n)); }
+
+/// Arena blocks are at least this big
+constexpr size_t arena_block_size = 16 * 1024;
+
+/// Hash tables start with this many slots; they're kept at most half full
+constexpr size_t initial_slots = 64;
+
+}   // end anonymous namespace
+
+uint64_t hash_bytes(const char* p, size_t len) noexcept
+{
+    // Eight bytes at a time, then whatever's left, then a final mix
+    // (splitmix64's) so the top bits are as good as the bottom ones
+    uint64_t h = hash_k0 ^ (len * hash_k1);
+    uint64_t w;
+    for (; len >= 8; p += 8, len -= 8) {
+        __builtin_memcpy(&w, p, 8);
+        h = rotl((h ^ w) * hash_k1, 29);
+    }
+    if (len) {
+        w = 0;
+        __builtin_memcpy(&w, p, len);
+        h = rotl((h ^ w) * hash_k1, 29);
+    }
+
+    h ^= h >> 30;
+    h *= hash_k1;
+    h ^= h >> 27;
+    h *= hash_k2;
+    return h ^ (h >> 31);
+}
+
+/// An open-addressed hash table of entries, linked to the ones it replaced
+struct intern_table::slots
+{
+    explicit slots(size_t count)
+        : mask(count - 1), slot(new atomic<const symbol_entry*>[count])
+    {}
+
+    ~slots() noexcept { delete[] slot; }
+
+    size_t                          mask;
+    slots*                          prev{nullptr};
+    atomic<const symbol_entry*>*    slot;
+};
+
+/// A block of arena; the storage follows it
+struct intern_table::block
+{
+    block*  next;
+    size_t  capacity;
+    size_t  used;
+
+    char* data() noexcept { return reinterpret_cast<char*>(this + 1); }
+};
+
+intern_table::~intern_table() noexcept
+{
+    for (auto s = _slots.load(memory_order::relaxed); s; ) {
+        auto prev = s->prev;
+        delete s;
+        s = prev;
+    }
+
+    for (auto& seg : _ids)
+        delete[] seg;
+
+    for (auto b = _blocks; b; ) {
+        auto next = b->next;
+        ::operator delete(b);
+        b = next;
+    }
+}
+
+const symbol_entry* intern_table::find(string_view sv, uint64_t h) const noexcept
+{
+    const auto s = _slots.load(memory_order::acquire);
+    if (nullptr == s)
+        return nullptr;
+
+    for (size_t i = h & s->mask; ; i = (i + 1) & s->mask) {
+        const auto e = s->slot[i].load(memory_order::acquire);
+        if (nullptr == e)
+            return nullptr;
+        if ((e->hash == h) && (string_view(e->text(), e->length) == sv))
+            return e;
+    }
+}
+
+const symbol_entry* intern_table::insert(string_view sv, uint64_t h, unsigned id_shift, uint32_t id_tag)
+{
+    const auto len = sv.length();
+    if (len > max_length)
+        throw_error_length();
+
+    // Local ids start at 1; they go up to where the id or the id list runs out
+    const uint32_t local_id = _count.load(memory_order::relaxed) + 1;
+    if (local_id > (uint32_t(-1) >> id_shift) - (uint32_t(1) << seg_base_shift))
+        throw_error_length();
+
+    auto s = _slots.load(memory_order::relaxed);
+    if ((nullptr == s) || (2 * size_t(local_id) > s->mask + 1)) {
+        grow();
+        s = _slots.load(memory_order::relaxed);
+    }
+
+    auto e = arena_alloc(len);
+    e->hash   = h;
+    e->id     = (local_id << id_shift) | id_tag;
+    e->length = static_cast<uint32_t>(len);
+    auto text = reinterpret_cast<char*>(e + 1);
+    if (len)
+        __builtin_memcpy(text, sv.data(), len);
+    text[len] = 0;
+
+    add_id(e, local_id);
+
+    size_t i = h & s->mask;
+    while (s->slot[i].load(memory_order::relaxed))
+        i = (i + 1) & s->mask;
+    s->slot[i].store(e, memory_order::release);
+
+    return e;
+}
+
+const symbol_entry* intern_table::from_local_id(uint32_t local_id) const noexcept
+{
+    if ((0 == local_id) || (local_id > _count.load(memory_order::acquire)))
+        return nullptr;
+
+    const uint32_t idx = local_id + (uint32_t(1) << seg_base_shift);
+    const auto seg = static_cast<unsigned>(31 - __builtin_clz(idx)) - seg_base_shift;
+    return _ids[seg][idx - (uint32_t(1) << (seg + seg_base_shift))];
+}
+
+symbol_entry* intern_table::arena_alloc(size_t len)
+{
+    constexpr size_t align = alignof(symbol_entry);
+    const size_t need = (sizeof(symbol_entry) + len + 1 + align - 1) & ~(align - 1);
+
+    auto b = _blocks;
+    if ((nullptr == b) || (b->capacity - b->used < need)) {
+        const size_t cap = need > arena_block_size ? need : arena_block_size;
+        b = new (::operator new(sizeof(block) + cap)) block{_blocks, cap, 0};
+        _blocks = b;
+    }
+
+    auto p = b->data() + b->used;
+    b->used += need;
+    _arena_used += need;
+    return new (p) symbol_entry;
+}
+
+void intern_table::grow()
+{
+    const auto old = _slots.load(memory_order::relaxed);
+    auto s = new slots(old ? 2 * (old->mask + 1) : initial_slots);
+
+    if (old) {
+        for (size_t j = 0; j <= old->mask; ++j) {
+            const auto e = old->slot[j].load(memory_order::relaxed);
+            if (nullptr == e)
+                continue;
+
+            size_t i = e->hash & s->mask;
+            while (s->slot[i].load(memory_order::relaxed))
+                i = (i + 1) & s->mask;
+            s->slot[i].store(e, memory_order::relaxed);
+        }
+    }
+
+    // Nobody can see s until it's published, so the stores above can be relaxed
+    s->prev = old;
+    _slots.store(s, memory_order::release);
+}
+
+void intern_table::add_id(const symbol_entry* e, uint32_t local_id)
+{
+    const uint32_t idx = local_id + (uint32_t(1) << seg_base_shift);
+    const auto seg = static_cast<unsigned>(31 - __builtin_clz(idx)) - seg_base_shift;
+    if (nullptr == _ids[seg])
+        _ids[seg] = new const symbol_entry*[size_t(1) << (seg + seg_base_shift)];
+
+    _ids[seg][idx - (uint32_t(1) << (seg + seg_base_shift))] = e;
+    _count.store(local_id, memory_order::release);
+}
+
+}   // end namespace imp
+
+symbol sharded_intern_pool::intern(string_view sv)
+{
+    const auto h = imp::hash_bytes(sv.data(), sv.length());
+    auto& sh = shard_of(h);
+
+    if (auto e = sh.table.find(sv, h))
+        return symbol(e);
+
+    // Somebody may have added it since we looked
+    lock_guard<mutex> lock(sh.lock);
+    auto e = sh.table.find(sv, h);
+    if (nullptr == e)
+        e = sh.table.insert(sv, h, shard_bits, static_cast<uint32_t>(&sh - _shards));
+    return symbol(e);
+}
+
+size_t sharded_intern_pool::size() const noexcept
+{
+    size_t n = 0;
+    for (const auto& sh : _shards)
+        n += sh.table.size();
+    return n;
+}
+
+_SYS_END_NS
@@ -12,6 +12,7 @@
 #define _LARGEFILE64_SOURCE     1 // enables lseek64
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 
  using namespace sys::io;
 
@@ -105,6 +106,12 @@ int file::get_open_mode() const noexcept
     return open_mode;
 }
 
+/// Returns true if the file refers to a terminal device
+bool file::is_terminal() const noexcept
+{
+    return valid() && (1 == ::isatty(fd()));
+}
+
 ssize_t file::read(void* dst, size_t count)
 {
     return ::read(fd(), dst, count);
@@ -115,6 +122,49 @@ ssize_t file::write(const void* src, size_t count)
     return ::write(fd(), src, count);
 }
 
+size_t file::writev_all(const sys::string_view* parts, size_t count)
+{
+    // Parts go out a batch at a time; each batch is retried from wherever
+    // a short write left off.
+    constexpr size_t batch_max = 64;
+    ::iovec iov[batch_max];
+    size_t total = 0;
+
+    while (count) {
+        const size_t n = (count < batch_max) ? count : batch_max;
+        for (size_t i = 0; i < n; ++i) {
+            iov[i].iov_base = const_cast<char*>(parts[i].data());
+            iov[i].iov_len  = parts[i].length();
+        }
+
+        size_t first = 0;
+        for (;;) {
+            while ((first < n) && (0 == iov[first].iov_len))
+                ++first;
+            if (first == n)
+                break;
+
+            const ssize_t wrote = ::writev(fd(), iov + first, static_cast<int>(n - first));
+            if (wrote <= 0)
+                return total;
+            total += static_cast<size_t>(wrote);
+
+            auto left = static_cast<size_t>(wrote);
+            for (; left && (left >= iov[first].iov_len); ++first)
+                left -= iov[first].iov_len;
+            if (left) {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + left;
+                iov[first].iov_len -= left;
+            }
+        }
+
+        parts += n;
+        count -= n;
+    }
+
+    return total;
+}
+
 ssize_t file::seek(ssize_t offset, seek_mode_t whence)
 {
     return ::lseek64(fd(), offset, static_cast<int>(whence));
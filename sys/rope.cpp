@@ -0,0 +1,485 @@
+/**
+ * @file    rope.cpp
+ * @author  Mike DeKoker (dekoker.mike@gmail.com)
+ * @brief   Implements sys::rope
+ *
+ * Everything is built from two operations on the tree: concat(), which
+ * joins two trees, and split(), which cuts one in two at a position. Both
+ * are O(log n) and copy only the nodes on the path they take, so the trees
+ * they're given are left intact for anyone else that's sharing them.
+ *
+ * concat() is AVL concatenation: the shorter tree goes down the near side
+ * of the taller one until the heights are within one, and the nodes on
+ * the way back up are rebalanced with the usual rotations.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <rope_.h>
+#include <io_file_.h>
+#include <error_.h>
+
+_SYS_BEGIN_NS
+
+namespace imp {
+
+void rope_node::release() noexcept
+{
+    if (0 == --ref_count) {
+        if (is_leaf())
+            chunk->release();
+        else {
+            left->release();
+            right->release();
+        }
+        delete this;
+    }
+}
+
+}   // end namespace imp
+
+namespace {
+
+using imp::rope_node;
+using imp::rope_chunk;
+
+/// Leaves this short are merged into one when they're joined
+constexpr size_t leaf_merge_max = 32;
+static_assert(leaf_merge_max < rope::adopt_min_len, "Adopted strings are never copied");
+
+/// An owning reference to a node
+class node_ref
+{
+public:
+
+    node_ref() noexcept = default;
+
+    /// Adopts a reference to n
+    explicit node_ref(rope_node* n) noexcept : _n(n) {}
+
+    node_ref(const node_ref& other) noexcept
+        : _n(other._n ? other._n->add_ref() : nullptr)
+    {}
+
+    node_ref(node_ref&& other) noexcept
+        : _n(other._n)
+    {
+        other._n = nullptr;
+    }
+
+    node_ref& operator=(node_ref other) noexcept
+    {
+        auto tmp = _n;
+        _n = other._n;
+        other._n = tmp;
+        return *this;
+    }
+
+    ~node_ref() noexcept
+    {
+        if (_n)
+            _n->release();
+    }
+
+    /// Returns a new reference to n
+    static node_ref share(rope_node* n) noexcept
+        { return node_ref(n ? n->add_ref() : nullptr); }
+
+    rope_node* get() const noexcept { return _n; }
+    rope_node* operator->() const noexcept { return _n; }
+    explicit operator bool() const noexcept { return nullptr != _n; }
+
+    /// Gives up our reference without dropping it
+    rope_node* detach() noexcept
+    {
+        auto n = _n;
+        _n = nullptr;
+        return n;
+    }
+
+private:
+
+    rope_node* _n{nullptr};
+};
+
+int height(const node_ref& n) noexcept
+    { return n ? n->height : 0; }
+
+/// Makes a leaf for chunk[offset, offset + length); adopts the chunk reference
+node_ref make_leaf(rope_chunk* chunk, size_t offset, size_t length)
+{
+    auto n = new rope_node;
+    n->chunk  = chunk;
+    n->offset = offset;
+    n->length = length;
+    return node_ref(n);
+}
+
+/// Makes a leaf for a new chunk holding a copy of sv, with room for cap chars
+node_ref make_copy_leaf(string_view sv, size_t cap)
+{
+    auto chunk = new rope_chunk;
+    chunk->sbuf.ensure_buf(cap, false, true);
+    string_view::traits_t::copy(chunk->sbuf.append_uninitialized(sv.length()),
+        sv.data(), sv.length());
+    return make_leaf(chunk, 0, sv.length());
+}
+
+/// Makes a node joining l and r, whose heights are within one
+node_ref make_node(node_ref l, node_ref r)
+{
+    auto n = new rope_node;
+    n->length = l->length + r->length;
+    n->height = static_cast<uint8_t>(1 + max(height(l), height(r)));
+    n->left   = l.detach();
+    n->right  = r.detach();
+    return node_ref(n);
+}
+
+/// Joins l and r, whose heights are within two, rotating if need be
+node_ref balance(node_ref l, node_ref r)
+{
+    if (height(l) > height(r) + 1) {
+        auto ll = node_ref::share(l->left);
+        auto lr = node_ref::share(l->right);
+        if (height(ll) >= height(lr))
+            return make_node(sys::move(ll), make_node(sys::move(lr), sys::move(r)));
+
+        auto lrl = node_ref::share(lr->left);
+        auto lrr = node_ref::share(lr->right);
+        return make_node(make_node(sys::move(ll), sys::move(lrl)),
+            make_node(sys::move(lrr), sys::move(r)));
+    }
+
+    if (height(r) > height(l) + 1) {
+        auto rl = node_ref::share(r->left);
+        auto rr = node_ref::share(r->right);
+        if (height(rr) >= height(rl))
+            return make_node(make_node(sys::move(l), sys::move(rl)), sys::move(rr));
+
+        auto rll = node_ref::share(rl->left);
+        auto rlr = node_ref::share(rl->right);
+        return make_node(make_node(sys::move(l), sys::move(rll)),
+            make_node(sys::move(rlr), sys::move(rr)));
+    }
+
+    return make_node(sys::move(l), sys::move(r));
+}
+
+/// Returns the tree of l's text followed by r's
+node_ref concat(node_ref l, node_ref r)
+{
+    if (!l)
+        return r;
+    if (!r)
+        return l;
+
+    if (l->is_leaf() && r->is_leaf()) {
+        // Neighbours in the same chunk (e.g., after an erase) are one leaf again
+        if ((l->chunk == r->chunk) && (l->offset + l->length == r->offset))
+            return make_leaf(l->chunk->add_ref(), l->offset, l->length + r->length);
+
+        // Don't let small edits splinter the text
+        if (l->length + r->length <= leaf_merge_max) {
+            auto n = make_copy_leaf(l->view(), l->length + r->length);
+            auto& sbuf = n->chunk->sbuf;
+            const auto rv = r->view();
+            string_view::traits_t::copy(sbuf.append_uninitialized(rv.length()), rv.data(), rv.length());
+            n->length += rv.length();
+            return n;
+        }
+    }
+
+    if (height(l) > height(r) + 1) {
+        auto ll = node_ref::share(l->left);
+        return balance(sys::move(ll), concat(node_ref::share(l->right), sys::move(r)));
+    }
+    if (height(r) > height(l) + 1) {
+        auto rr = node_ref::share(r->right);
+        return balance(concat(sys::move(l), node_ref::share(r->left)), sys::move(rr));
+    }
+
+    return make_node(sys::move(l), sys::move(r));
+}
+
+/// Splits n's text at pos into l and r
+void split(rope_node* n, size_t pos, node_ref& l, node_ref& r)
+{
+    if (0 == pos) {
+        l = node_ref();
+        r = node_ref::share(n);
+        return;
+    }
+    if (pos >= n->length) {
+        l = node_ref::share(n);
+        r = node_ref();
+        return;
+    }
+
+    if (n->is_leaf()) {
+        l = make_leaf(n->chunk->add_ref(), n->offset, pos);
+        r = make_leaf(n->chunk->add_ref(), n->offset + pos, n->length - pos);
+        return;
+    }
+
+    const size_t left_len = n->left->length;
+    if (pos <= left_len) {
+        node_ref lr;
+        split(n->left, pos, l, lr);
+        r = concat(sys::move(lr), node_ref::share(n->right));
+    }
+    else {
+        node_ref rl;
+        split(n->right, pos - left_len, rl, r);
+        l = concat(node_ref::share(n->left), sys::move(rl));
+    }
+}
+
+/// Makes the tree for a copy of sv
+node_ref make_text(string_view sv)
+{
+    return sv.is_empty() ? node_ref() : make_copy_leaf(sv, sv.length());
+}
+
+/// Makes the tree for the text in sbuf, adopting the buffer if it's worth it
+node_ref make_text(imp::string_buf&& sbuf)
+{
+    const auto len = sbuf.length();
+    if (len < rope::adopt_min_len)
+        return make_text(string_view(sbuf.data(), len));
+
+    return make_leaf(new rope_chunk(sys::move(sbuf)), 0, len);
+}
+
+size_t count_leaves(const rope_node* n) noexcept
+{
+    size_t count = 1;
+    for (; !n->is_leaf(); n = n->right)
+        count += count_leaves(n->left);
+    return count;
+}
+
+}   // end anonymous namespace
+
+rope::char_t rope::at(size_type pos) const
+{
+    if (pos >= length())
+        throw_error_bounds(pos, length());
+
+    const imp::rope_node* n = _root;
+    while (!n->is_leaf()) {
+        if (pos < n->left->length)
+            n = n->left;
+        else {
+            pos -= n->left->length;
+            n = n->right;
+        }
+    }
+
+    return n->view()[pos];
+}
+
+rope::size_type rope::chunk_count() const noexcept
+{
+    return _root ? count_leaves(_root) : 0;
+}
+
+bool rope::append_in_place(string_view sv) noexcept
+{
+    // We need the only reference to every node down to the last leaf
+    imp::rope_node* n = _root;
+    if (!n)
+        return false;
+    for (; !n->is_leaf(); n = n->right) {
+        if (!n->is_unique())
+            return false;
+    }
+    if (!n->is_unique() || !n->chunk->is_unique())
+        return false;
+
+    // ...and the leaf has to run to the end of its chunk, with room to spare
+    auto& sbuf = n->chunk->sbuf;
+    if ((n->offset + n->length != sbuf.length()) ||
+        (sbuf.capacity() - sbuf.length() < sv.length()))
+    {
+        return false;
+    }
+
+    string_view::traits_t::copy(sbuf.append_uninitialized(sv.length()), sv.data(), sv.length());
+    for (n = _root; ; n = n->right) {
+        n->length += sv.length();
+        if (n->is_leaf())
+            break;
+    }
+
+    return true;
+}
+
+rope& rope::append(string_view sv)
+{
+    if (sv.is_empty() || append_in_place(sv))
+        return *this;
+
+    auto leaf = make_copy_leaf(sv, max(sv.length(), chunk_capacity));
+    _root = concat(node_ref(_root), sys::move(leaf)).detach();
+    return *this;
+}
+
+rope& rope::append(string&& s)
+{
+    if (s.length() < adopt_min_len)
+        return append(string_view(s));
+
+    _root = concat(node_ref(_root), make_text(sys::move(s._sbuf))).detach();
+    return *this;
+}
+
+rope& rope::append(const rope& r)
+{
+    _root = concat(node_ref(_root), node_ref::share(r._root)).detach();
+    return *this;
+}
+
+rope& rope::insert(size_type pos, string_view sv)
+{
+    if (pos == length())
+        return append(sv);
+
+    return insert(pos, rope(make_text(sv).detach()));
+}
+
+rope& rope::insert(size_type pos, string&& s)
+{
+    if (pos == length())
+        return append(sys::move(s));
+
+    return insert(pos, rope(make_text(sys::move(s._sbuf)).detach()));
+}
+
+rope& rope::insert(size_type pos, const rope& r)
+{
+    if (pos > length())
+        throw_error_bounds(pos, length());
+    if (!_root)
+        return *this = r;
+
+    node_ref old(_root), l, rest;
+    split(old.get(), pos, l, rest);
+    _root = concat(concat(sys::move(l), node_ref::share(r._root)), sys::move(rest)).detach();
+    return *this;
+}
+
+rope& rope::erase(size_type pos, size_type count)
+{
+    if (pos > length())
+        throw_error_bounds(pos, length());
+    if ((count == npos) || (count > length() - pos))
+        count = length() - pos;
+    if (!count)
+        return *this;
+
+    node_ref old(_root), l, rest, mid, r;
+    split(old.get(), pos, l, rest);
+    split(rest.get(), count, mid, r);
+    _root = concat(sys::move(l), sys::move(r)).detach();
+    return *this;
+}
+
+rope rope::substr(size_type pos, size_type count) const
+{
+    if (pos > length())
+        throw_error_bounds(pos, length());
+    if ((count == npos) || (count > length() - pos))
+        count = length() - pos;
+    if (!count)
+        return rope();
+
+    node_ref l, rest, mid, r;
+    split(_root, pos, l, rest);
+    split(rest.get(), count, mid, r);
+    return rope(mid.detach());
+}
+
+string_view rope::flatten()
+{
+    if (!_root)
+        return string_view();
+    if (!_root->is_leaf()) {
+        auto leaf = make_copy_leaf(string_view(), length());
+        auto& sbuf = leaf->chunk->sbuf;
+        for_each_chunk([&sbuf](string_view sv) {
+            string_view::traits_t::copy(sbuf.append_uninitialized(sv.length()), sv.data(), sv.length());
+        });
+        leaf->length = sbuf.length();
+
+        clear();
+        _root = leaf.detach();
+    }
+
+    return _root->view();
+}
+
+string rope::to_string() const
+{
+    string s;
+    s.resize_and_overwrite(length(), [this](char_t* p, size_type n) {
+        for_each_chunk([&p](string_view sv) {
+            string_view::traits_t::copy(p, sv.data(), sv.length());
+            p += sv.length();
+        });
+        return n;
+    });
+    return s;
+}
+
+size_t rope::write_to(io::file& f) const
+{
+    // Chunks go out in batches, one writev each, until a write comes up short
+    constexpr size_t batch_max = 64;
+    string_view batch[batch_max];
+    size_t count = 0, batch_len = 0, written = 0;
+    bool ok = true;
+
+    auto flush = [&] {
+        const size_t wrote = f.writev_all(batch, count);
+        written += wrote;
+        ok = (wrote == batch_len);
+        count = batch_len = 0;
+    };
+
+    for_each_chunk([&](string_view sv) {
+        if (!ok)
+            return;
+        batch[count++] = sv;
+        batch_len += sv.length();
+        if (count == batch_max)
+            flush();
+    });
+    if (ok && count)
+        flush();
+
+    return written;
+}
+
+int rope::compare(string_view sv) const noexcept
+{
+    size_t at = 0;
+    int ret = 0;
+    for_each_chunk([&](string_view chunk) {
+        if (ret)
+            return;
+
+        const size_t left = sv.length() - at;
+        const size_t n = min(chunk.length(), left);
+        ret = string_view::traits_t::compare(chunk.data(), sv.data() + at, n);
+        if (!ret && (chunk.length() > left))
+            ret = 1;                // We're longer
+        at += n;
+    });
+
+    if (!ret && (at < sv.length()))
+        ret = -1;                   // We're shorter
+    return (ret > 0) - (ret < 0);
+}
+
+_SYS_END_NS
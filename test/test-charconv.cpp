@@ -1,5 +1,6 @@
 #include "test_app.h"
 #include <charconv_.h>
+#include <string_.h>
 
 using namespace sys;
 
@@ -56,6 +57,490 @@ public:
         }
     }
 
+    /// Convert given integer to a string and compare
+    template <integral I>
+    constexpr static bool int_chars(I val, string_view expect, unsigned radix = 10)
+    {
+        char cbuf[140] = {0};
+        auto&& [ptr, ec] = to_chars(cbuf, cbuf + sizeof(cbuf), val, radix);
+        return !is_error(ec) && (string_view(cbuf, static_cast<sys::size_t>(ptr - cbuf)) == expect);
+    }
+
+    void TestIntegerToChars()
+    {
+        // Digit count boundaries
+        static_assert(int_chars(0,                          "0"));
+        static_assert(int_chars(9u,                         "9"));
+        static_assert(int_chars(10u,                        "10"));
+        static_assert(int_chars(99999999u,                  "99999999"));
+        static_assert(int_chars(100000000u,                 "100000000"));
+        static_assert(int_chars(9999999999999999999ull,     "9999999999999999999"));
+        static_assert(int_chars(10000000000000000000ull,    "10000000000000000000"));
+        static_assert(int_chars(-1234567890123ll,           "-1234567890123"));
+        static_assert(int_chars(numeric_limits<long long>::min, "-9223372036854775808"));
+        static_assert(int_chars(static_cast<signed char>(-128), "-128"));
+
+        // Power-of-two and other radices
+        static_assert(int_chars(0u,                         "0",        2));
+        static_assert(int_chars(5u,                         "101",      2));
+        static_assert(int_chars(0xDEADBEEFu,                "DEADBEEF", 16));
+        static_assert(int_chars(-255,                       "-377",     8));
+        static_assert(int_chars(numeric_limits<uint64_t>::max, "FVVVVVVVVVVVV", 32));
+        static_assert(int_chars(35u,                        "Z",        36));
+        static_assert(int_chars(-100,                       "-10201",   3));
+
+        // Buffer must hold the sign and every digit
+        char small[3];
+        Verify(to_chars(small, small + sizeof(small), 999).ec == error_code{}, "to_chars fits");
+        Verify(to_chars(small, small + sizeof(small), 1000).ec == error_code::value_too_large, "to_chars dec overflow");
+        Verify(to_chars(small, small + sizeof(small), -100).ec == error_code::value_too_large, "to_chars sign overflow");
+        Verify(to_chars(small, small + sizeof(small), 0x1000, 16).ec == error_code::value_too_large, "to_chars hex overflow");
+        Verify(to_chars(small, small + sizeof(small), 1, 37).ec == error_code::bad_parameter, "to_chars bad radix");
+    }
+
+    /// Parse given text to an integer and compare
+    template <integral I>
+    constexpr static bool int_from(string_view text, I expect, size_t pos, unsigned radix = 10)
+    {
+        I val{};
+        auto&& [pos_stop, ec] = from_chars(val, text, radix);
+        return !is_error(ec) && (pos_stop == pos) && (val == expect);
+    }
+
+    /// Parse given text to an integer, expecting an error
+    template <integral I>
+    constexpr static bool int_from_fails(string_view text, error_code expect, size_t pos, unsigned radix = 10)
+    {
+        I val{42};
+        auto&& [pos_stop, ec] = from_chars(val, text, radix);
+        return (ec == expect) && (pos_stop == pos) && (val == I{42});
+    }
+
+    /// Run-time parsing; decimal and hex take the eight-at-a-time path here
+    void TestIntegerFromChars()
+    {
+        Verify(int_from("1", 1u, 1), "from_chars short decimal");
+        Verify(int_from("12345678", 12345678u, 8), "from_chars 8 digits");
+        Verify(int_from("123456789x", 123456789u, 9), "from_chars 9 digits");
+        Verify(int_from("  -00000000000000000000000042 ", -42, 29), "from_chars leading zeroes");
+        Verify(int_from("18446744073709551615", numeric_limits<uint64_t>::max, 20), "from_chars u64 max");
+        Verify(int_from("-9223372036854775808", numeric_limits<sint64_t>::min, 20), "from_chars s64 min");
+        Verify(int_from("65535", uint16_t{65535}, 5), "from_chars u16 max");
+        Verify(int_from("-128", static_cast<signed char>(-128), 4), "from_chars s8 min");
+        Verify(int_from("340282366920938463463374607431768211455", numeric_limits<uint128_t>::max, 39), "from_chars u128 max");
+
+        Verify(int_from("fF", 255u, 2, 16), "from_chars short hex");
+        Verify(int_from("0x1234abcdEF", 0x1234abcdefull, 12, 16), "from_chars hex prefix");
+        Verify(int_from("FFFFFFFFFFFFFFFFg", numeric_limits<uint64_t>::max, 16, 16), "from_chars hex u64 max");
+        Verify(int_from("-80000000", numeric_limits<sint32_t>::min, 9, 16), "from_chars hex s32 min");
+        Verify(int_from("0X1F", 31, 4, 0), "from_chars auto-radix hex");
+        Verify(int_from("0b101", 5, 5, 0), "from_chars auto-radix binary");
+        Verify(int_from("017", 15, 3, 0), "from_chars auto-radix octal");
+
+        Verify(int_from_fails<uint64_t>("18446744073709551616", error_code::out_of_range, 19), "from_chars u64 overflow");
+        Verify(int_from_fails<uint64_t>("184467440737095516150", error_code::out_of_range, 20), "from_chars u64 long overflow");
+        Verify(int_from_fails<sint32_t>("-2147483649", error_code::out_of_range, 10), "from_chars s32 overflow");
+        Verify(int_from_fails<uint16_t>("65536", error_code::out_of_range, 4), "from_chars u16 overflow");
+        Verify(int_from_fails<uint64_t>("1FFFFFFFFFFFFFFFF", error_code::out_of_range, 16, 16), "from_chars hex overflow");
+        Verify(int_from_fails<uint32_t>("+", error_code::bad_parameter, 0, 16), "from_chars lone sign");
+        Verify(int_from_fails<uint32_t>("0x", error_code::bad_parameter, 0, 16), "from_chars bare prefix");
+        Verify(int_from_fails<uint32_t>("z", error_code::bad_parameter, 0), "from_chars no digits");
+    }
+
+    void Test128Bit()
+    {
+        constexpr uint128_t e19 = 10000000000000000000ull;
+        constexpr uint128_t u_max = numeric_limits<uint128_t>::max;
+        constexpr sint128_t s_max = numeric_limits<sint128_t>::max;
+        constexpr sint128_t s_min = numeric_limits<sint128_t>::min;
+
+        // Formatting across the 64-bit chunk boundaries
+        static_assert(int_chars(uint128_t{1} << 64,         "18446744073709551616"));
+        static_assert(int_chars(e19,                        "10000000000000000000"));
+        static_assert(int_chars(e19 * e19 - 1,              "99999999999999999999999999999999999999"));
+        static_assert(int_chars(e19 * e19,                  "100000000000000000000000000000000000000"));
+        static_assert(int_chars(e19 * e19 + 1,              "100000000000000000000000000000000000001"));
+        static_assert(int_chars(u_max,                      "340282366920938463463374607431768211455"));
+        static_assert(int_chars(s_min,                      "-170141183460469231731687303715884105728"));
+        static_assert(int_chars(u_max,                      "FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", 16));
+
+        // Parsing
+        static_assert(int_from("18446744073709551616",      uint128_t{1} << 64, 20));
+        static_assert(int_from("  -0000000000000000000000000000000000000000042x", sint128_t{-42}, 46));
+        static_assert(int_from("340282366920938463463374607431768211455", u_max, 39));
+        static_assert(int_from("170141183460469231731687303715884105727", s_max, 39));
+        static_assert(int_from("-170141183460469231731687303715884105728", s_min, 40));
+        static_assert(int_from("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF", u_max, 32, 16));
+
+        // Overflow stops at the digit that overflows
+        static_assert(int_from_fails<uint128_t>("340282366920938463463374607431768211456", error_code::out_of_range, 38));
+        static_assert(int_from_fails<uint128_t>("3402823669209384634633746074317682114550", error_code::out_of_range, 39));
+        static_assert(int_from_fails<sint128_t>("170141183460469231731687303715884105728", error_code::out_of_range, 38));
+        static_assert(int_from_fails<sint128_t>("-170141183460469231731687303715884105729", error_code::out_of_range, 39));
+        static_assert(int_from_fails<uint128_t>("-1",       error_code::out_of_range, 0));
+        static_assert(int_from_fails<sint128_t>("+",        error_code::bad_parameter, 0));
+    }
+
+    /// Convert given floating-point value to a string and compare
+    template <floating_point F>
+    constexpr static bool fp_chars(F val, string_view expect, chars_format fmt = chars_format{}, int precision = -1)
+    {
+        char cbuf[400] = {0};
+        auto&& [ptr, ec] = (precision < 0)
+            ? ((fmt == chars_format{}) ? to_chars(cbuf, cbuf + sizeof(cbuf), val)
+                                       : to_chars(cbuf, cbuf + sizeof(cbuf), val, fmt))
+            : to_chars(cbuf, cbuf + sizeof(cbuf), val, fmt, precision);
+        return !is_error(ec) && (string_view(cbuf, static_cast<sys::size_t>(ptr - cbuf)) == expect);
+    }
+
+    void TestFloatingPoint()
+    {
+        using cf = chars_format;
+
+        // Shortest round-trip
+        static_assert(fp_chars(0.0,                     "0"));
+        static_assert(fp_chars(-0.0,                    "-0"));
+        static_assert(fp_chars(0.1,                     "0.1"));
+        static_assert(fp_chars(0.3,                     "0.3"));
+        static_assert(fp_chars(0.1 + 0.2,               "0.30000000000000004"));
+        static_assert(fp_chars(1.0 / 3.0,               "0.3333333333333333"));
+        static_assert(fp_chars(100.0,                   "100"));
+        static_assert(fp_chars(1e21,                    "1e+21"));
+        static_assert(fp_chars(5e-324,                  "5e-324"));
+        static_assert(fp_chars(1.7976931348623157e308,  "1.7976931348623157e+308"));
+        static_assert(fp_chars(0.1f,                    "0.1"));
+        static_assert(fp_chars(16777216.0f,             "16777216"));
+        static_assert(fp_chars(3.4028235e38f,           "3.4028235e+38"));
+        static_assert(fp_chars(1e-45f,                  "1e-45"));
+
+        // Shortest, in a given style
+        static_assert(fp_chars(1234.5,  "1.2345e+03",   cf::scientific));
+        static_assert(fp_chars(1e21,    "1000000000000000000000", cf::fixed));
+        static_assert(fp_chars(100.0,   "1e+02",        cf::general));
+        static_assert(fp_chars(0.0001,  "0.0001",       cf::general));
+        static_assert(fp_chars(1.0,     "1p+0",         cf::hex));
+        static_assert(fp_chars(-0.1,    "-1.999999999999ap-4", cf::hex));
+        static_assert(fp_chars(5e-324,  "0.0000000000001p-1022", cf::hex));
+        static_assert(fp_chars(0.1f,    "1.99999ap-4",  cf::hex));
+
+        // Given precision; exact and rounded half to even
+        static_assert(fp_chars(0.125,   "0.12",         cf::fixed, 2));
+        static_assert(fp_chars(0.375,   "0.38",         cf::fixed, 2));
+        static_assert(fp_chars(2.675,   "2.67",         cf::fixed, 2));
+        static_assert(fp_chars(0.5,     "0",            cf::fixed, 0));
+        static_assert(fp_chars(1.5,     "2",            cf::fixed, 0));
+        static_assert(fp_chars(0.1,     "0.1000000000000000055511151231257827", cf::fixed, 34));
+        static_assert(fp_chars(1e23,    "99999999999999991611392.0", cf::fixed, 1));
+        static_assert(fp_chars(9.9999,  "1.000e+01",    cf::scientific, 3));
+        static_assert(fp_chars(1e-310,  "1.000000e-310", cf::scientific, 6));
+        static_assert(fp_chars(123456.0, "1.23e+05",    cf::general, 3));
+        static_assert(fp_chars(0.0001,  "0.0001",       cf::general, 6));
+        static_assert(fp_chars(0.00001, "1e-05",        cf::general, 6));
+        static_assert(fp_chars(1.0,     "1.000p+0",     cf::hex, 3));
+        static_assert(fp_chars(1.96875, "2p+0",         cf::hex, 0));
+
+        // Too small a buffer
+        char small[4];
+        auto [ptr, ec] = to_chars(small, small + sizeof(small), 1234.5);
+        Verify(ec == error_code::value_too_large, "to_chars overflow");
+        Verify(ptr == small + sizeof(small), "to_chars overflow pointer");
+
+        // inf and nan
+        constexpr double inf = __builtin_inf();
+        static_assert(fp_chars(inf,     "inf"));
+        static_assert(fp_chars(-inf,    "-inf", cf::fixed, 2));
+        Verify(fp_chars(__builtin_nan(""), "nan"), "nan");
+    }
+
+    /// Parse given text to a floating-point value and compare, bit for bit
+    template <floating_point F>
+    constexpr static bool fp_from(string_view text, F expect, size_t pos,
+        chars_format fmt = chars_format::general)
+    {
+        using bits_type = typename imp::fp_traits<F>::uint_type;
+
+        F val{};
+        auto&& [pos_stop, ec] = from_chars(val, text, fmt);
+        return !is_error(ec) && (pos_stop == pos) &&
+            (bit_cast<bits_type>(val) == bit_cast<bits_type>(expect));
+    }
+
+    /// Parse given text to a floating-point value, expecting an error
+    template <floating_point F>
+    constexpr static bool fp_from_fails(string_view text, error_code expect, size_t pos,
+        chars_format fmt = chars_format::general)
+    {
+        F val{42};
+        auto&& [pos_stop, ec] = from_chars(val, text, fmt);
+        return (ec == expect) && (pos_stop == pos) && (val == F{42});
+    }
+
+    void TestFloatingPointParse()
+    {
+        using cf = chars_format;
+
+        // Fast paths and round trips
+        static_assert(fp_from("0",                          0.0,        1));
+        static_assert(fp_from("-0.0",                       -0.0,       4));
+        static_assert(fp_from("  +1.5",                     1.5,        6));
+        static_assert(fp_from(".5",                         0.5,        2));
+        static_assert(fp_from("5.",                         5.0,        2));
+        static_assert(fp_from("0.1",                        0.1,        3));
+        static_assert(fp_from("1e23",                       1e23,       4));
+        static_assert(fp_from("123456789e-5",               1234.56789, 12));
+        static_assert(fp_from("0.30000000000000004",        0.1 + 0.2,  19));
+        static_assert(fp_from("1.7976931348623157e308",     1.7976931348623157e308, 22));
+        static_assert(fp_from("4.9406564584124654e-324",    5e-324,     23));
+        static_assert(fp_from("2.2250738585072011e-308",    2.2250738585072009e-308, 23));
+        static_assert(fp_from("0.1",                        0.1f,       3));
+        static_assert(fp_from("3.4028235e38",               3.4028235e38f, 12));
+        static_assert(fp_from("1e-45",                      1e-45f,     5));
+
+        // Correct rounding: ties to even, and digits well past 19
+        static_assert(fp_from("9007199254740993",           9007199254740992.0, 16));
+        static_assert(fp_from("9007199254740995",           9007199254740996.0, 16));
+        static_assert(fp_from("9007199254740993.0000000000000000000001", 9007199254740994.0, 39));
+        static_assert(fp_from("2.4703282292062328e-324",    5e-324,     23));
+        static_assert(fp_from("16777217",                   16777216.0f, 8));
+        static_assert(fp_from("1.00000005960464477539062500000000000000000000001", 1.00000012f, 49));
+        static_assert(fp_from("0.000000000000000000000000000000000000000000001e45", 1.0, 50));
+
+        // Formats
+        static_assert(fp_from("1e5",                        1.0,        1,  cf::fixed));
+        static_assert(fp_from("1e5",                        1e5,        3,  cf::scientific));
+        static_assert(fp_from("1e",                         1.0,        1));
+        static_assert(fp_from("1e+x",                       1.0,        1));
+        static_assert(fp_from("1.8p1",                      3.0,        5,  cf::hex));
+        static_assert(fp_from("0x1.8p1",                    3.0,        7,  cf::hex));
+        static_assert(fp_from("-0x.1",                      -0.0625,    5));
+        static_assert(fp_from("0x1p-1074",                  5e-324,     9));
+        static_assert(fp_from("0xg",                        0.0,        1));
+
+        // Specials
+        constexpr double inf = __builtin_inf();
+        static_assert(fp_from("inf",                        inf,        3));
+        static_assert(fp_from("-Infinity",                  -inf,       9));
+        static_assert(fp_from("INFINITE",                   inf,        3));
+        double nan{};
+        Verify(!is_error(from_chars(nan, "nan(123)").ec) && (nan != nan), "parse nan");
+        Verify(from_chars(nan, "NaN(x").pos_stop == 3, "parse nan stop");
+
+        // Failures
+        static_assert(fp_from_fails<double>("",             error_code::bad_parameter, 0));
+        static_assert(fp_from_fails<double>("  ",           error_code::bad_parameter, 0));
+        static_assert(fp_from_fails<double>("-",            error_code::bad_parameter, 0));
+        static_assert(fp_from_fails<double>(".e5",          error_code::bad_parameter, 0));
+        static_assert(fp_from_fails<double>("1",            error_code::bad_parameter, 0, cf::scientific));
+        static_assert(fp_from_fails<double>("1e309",        error_code::out_of_range,  5));
+        static_assert(fp_from_fails<double>("1.7976931348623159e308", error_code::out_of_range, 22));
+        static_assert(fp_from_fails<double>("2.4703282292062327e-324", error_code::out_of_range, 23));
+        static_assert(fp_from_fails<double>("0x1p1024",     error_code::out_of_range,  8));
+        static_assert(fp_from_fails<double>("0x1.fffffffffffff8p1023", error_code::out_of_range, 23));
+        static_assert(fp_from_fails<float>("3.5e38",        error_code::out_of_range,  6));
+        static_assert(fp_from_fails<float>("-7e-46",        error_code::out_of_range,  6));
+    }
+
+    /// Encode bytes with to_hex or to_base64 and compare with the expected text
+    template <size_t N>
+    constexpr static bool bytes_to(const char (&src)[N], string_view expect, bool base64,
+        base64_alphabet alpha = base64_alphabet::standard, bool pad = true)
+    {
+        uint8_t bytes[N]{};
+        for (size_t i = 0; i + 1 < N; ++i)
+            bytes[i] = static_cast<uint8_t>(src[i]);
+        const byte_view bv(bytes, N - 1);
+
+        char cbuf[4 * N + 4]{};
+        auto [ptr, ec] = base64
+            ? to_base64(cbuf, cbuf + sizeof(cbuf), bv, alpha, pad)
+            : to_hex(cbuf, cbuf + sizeof(cbuf), bv);
+        if (is_error(ec) || (string_view(cbuf, static_cast<size_t>(ptr - cbuf)) != expect))
+            return false;
+
+        // Output must fit exactly
+        const size_t len = base64 ? base64_length(N - 1, pad) : hex_length(N - 1);
+        return (len == expect.length()) && (base64
+            ? to_base64(cbuf, cbuf + len - (len ? 1 : 0), bv, alpha, pad)
+            : to_hex(cbuf, cbuf + len - (len ? 1 : 0), bv)).ec == (len ? error_code::value_too_large : error_code::no_error);
+    }
+
+    /// Decode text with from_hex or from_base64 and compare with the expected bytes
+    constexpr static bool bytes_from(string_view s, string_view expect, bool base64,
+        base64_alphabet alpha = base64_alphabet::standard)
+    {
+        uint8_t bytes[64]{};
+        size_t size = sizeof(bytes);
+        auto [pos, ec] = base64 ? from_base64(bytes, size, s, alpha) : from_hex(bytes, size, s);
+        if (is_error(ec) || (pos != s.length()) || (size != expect.length()))
+            return false;
+
+        for (size_t i = 0; i < size; ++i)
+            if (bytes[i] != static_cast<uint8_t>(expect[i]))
+                return false;
+        return true;
+    }
+
+    /// Decode text with from_hex or from_base64, expecting failure
+    constexpr static bool bytes_from_fails(string_view s, error_code expect_ec,
+        size_t expect_pos, bool base64, size_t capacity = 64)
+    {
+        uint8_t bytes[64]{};
+        size_t size = capacity;
+        auto [pos, ec] = base64 ? from_base64(bytes, size, s) : from_hex(bytes, size, s);
+        return (ec == expect_ec) && (pos == expect_pos);
+    }
+
+    void TestBytes()
+    {
+        // RFC 4648 test vectors
+        static_assert(bytes_to("",              "",         false));
+        static_assert(bytes_to("foobar",        "666f6f626172", false));
+        static_assert(bytes_to("",              "",         true));
+        static_assert(bytes_to("f",             "Zg==",     true));
+        static_assert(bytes_to("fo",            "Zm8=",     true));
+        static_assert(bytes_to("foo",           "Zm9v",     true));
+        static_assert(bytes_to("foob",          "Zm9vYg==", true));
+        static_assert(bytes_to("fooba",         "Zm9vYmE=", true));
+        static_assert(bytes_to("foobar",        "Zm9vYmFy", true));
+        static_assert(bytes_to("fo",            "Zm8",      true, base64_alphabet::standard, false));
+        static_assert(bytes_to("\xfb\xff",      "-_8",      true, base64_alphabet::url, false));
+        static_assert(bytes_to("\xfb\xff",      "+/8=",     true));
+
+        static_assert(bytes_from("666F6f626172", "foobar",  false));
+        static_assert(bytes_from("",            "",         false));
+        static_assert(bytes_from("Zm9vYmE=",    "fooba",    true));
+        static_assert(bytes_from("Zm9vYmE",     "fooba",    true));
+        static_assert(bytes_from("Zg==",        "f",        true));
+        static_assert(bytes_from("-_8",         "\xfb\xff", true, base64_alphabet::url));
+
+        static_assert(bytes_from_fails("abc",   error_code::bad_parameter,  3, false));
+        static_assert(bytes_from_fails("a0g0",  error_code::bad_parameter,  2, false));
+        static_assert(bytes_from_fails("a0a0",  error_code::value_too_large, 0, false, 1));
+        static_assert(bytes_from_fails("Zm9vY", error_code::bad_parameter,  5, true));
+        static_assert(bytes_from_fails("Zg=",   error_code::bad_parameter,  2, true));
+        static_assert(bytes_from_fails("Zm=v",  error_code::bad_parameter,  2, true));
+        static_assert(bytes_from_fails("-_8=",  error_code::bad_parameter,  0, true));
+        static_assert(bytes_from_fails("Zm9v",  error_code::value_too_large, 0, true, 2));
+
+        // Long enough for the bulk kernels, with leftovers for the scalar tail
+        constexpr size_t count = 1000;
+        uint8_t bytes[count];
+        for (size_t i = 0; i < count; ++i)
+            bytes[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+
+        constexpr char hex_digits[] = "0123456789ABCDEF";
+        char hex[hex_length(count)];
+        auto [hex_end, hex_ec] = to_hex(hex, hex + sizeof(hex), byte_view(bytes, count), true);
+        Verify(!is_error(hex_ec) && (hex_end == hex + sizeof(hex)), "to_hex bulk");
+        for (size_t i = 0; i < count; ++i)
+            Verify((hex[2 * i] == hex_digits[bytes[i] >> 4]) && (hex[2 * i + 1] == hex_digits[bytes[i] & 0xF]), "to_hex bulk digits");
+
+        uint8_t back[count];
+        size_t size = count;
+        auto [hex_pos, hex_from_ec] = from_hex(back, size, string_view(hex, sizeof(hex)));
+        Verify(!is_error(hex_from_ec) && (hex_pos == sizeof(hex)) && (size == count), "from_hex bulk");
+        for (size_t i = 0; i < count; ++i)
+            Verify(back[i] == bytes[i], "from_hex bulk bytes");
+
+        constexpr char b64_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+        char b64[base64_length(count)];
+        auto [b64_end, b64_ec] = to_base64(b64, b64 + sizeof(b64), byte_view(bytes, count), base64_alphabet::url);
+        Verify(!is_error(b64_ec) && (b64_end == b64 + sizeof(b64)), "to_base64 bulk");
+        for (size_t i = 0; i + 3 <= count; i += 3) {
+            const uint32_t w = (uint32_t{bytes[i]} << 16) | (uint32_t{bytes[i + 1]} << 8) | bytes[i + 2];
+            for (size_t j = 0; j < 4; ++j)
+                Verify(b64[i / 3 * 4 + j] == b64_digits[(w >> (18 - 6 * j)) & 63], "to_base64 bulk digits");
+        }
+
+        size = count;
+        auto [b64_pos, b64_from_ec] = from_base64(back, size, string_view(b64, sizeof(b64)), base64_alphabet::url);
+        Verify(!is_error(b64_from_ec) && (b64_pos == sizeof(b64)) && (size == count), "from_base64 bulk");
+        for (size_t i = 0; i < count; ++i)
+            Verify(back[i] == bytes[i], "from_base64 bulk bytes");
+
+        // An invalid char well into the input is still found exactly
+        hex[777] = 'g';
+        size = count;
+        auto [bad_pos, bad_ec] = from_hex(back, size, string_view(hex, sizeof(hex)));
+        Verify((bad_ec == error_code::bad_parameter) && (bad_pos == 777) && (size == 388), "from_hex bulk invalid");
+
+        b64[901] = '+';
+        size = count;
+        auto [bad64_pos, bad64_ec] = from_base64(back, size, string_view(b64, sizeof(b64)), base64_alphabet::url);
+        Verify((bad64_ec == error_code::bad_parameter) && (bad64_pos == 901) && (size == 675), "from_base64 bulk invalid");
+    }
+
+    /// Check a failed parse_numbers
+    template <class T>
+    bool numbers_fail(string_view text, error_code ec, size_t pos, size_t line, size_t field,
+        size_t parsed, char delim = ',')
+    {
+        vector<T> v;
+        auto res = parse_numbers(v, text, delim);
+        return (res.ec == ec) && (res.pos_stop == pos) && (res.line == line) &&
+            (res.field == field) && (v.size() == parsed);
+    }
+
+    void TestParseNumbers()
+    {
+        vector<sint32_t> v;
+        auto res = parse_numbers(v, "1,-2,+3\n40,50,60\r\n\n-2147483648,2147483647,0\n");
+        Verify(!is_error(res.ec) && (res.pos_stop == 44) && (res.line == 4), "parse_numbers ints");
+        const sint32_t expect[] = { 1, -2, 3, 40, 50, 60, numeric_limits<sint32_t>::min, numeric_limits<sint32_t>::max, 0 };
+        Verify(v.size() == 9, "parse_numbers int count");
+        for (size_t i = 0; i < v.size(); ++i)
+            Verify(v[i] == expect[i], "parse_numbers int values");
+
+        vector<double> d;
+        res = parse_numbers(d, "1.5\t-2e3\tinf\n0.1", '\t');
+        Verify(!is_error(res.ec) && (d.size() == 4) && (d[1] == -2e3) && (d[3] == 0.1), "parse_numbers doubles");
+
+        vector<uint64_t> u;
+        res = parse_numbers(u, "18446744073709551615;00000000000000000000000000042;12345678;1234567", ';');
+        Verify(!is_error(res.ec) && (u.size() == 4) && (u[0] == numeric_limits<uint64_t>::max) &&
+            (u[1] == 42) && (u[2] == 12345678) && (u[3] == 1234567), "parse_numbers u64");
+
+        Verify(parse_numbers(v, "").pos_stop == 0, "parse_numbers empty");
+
+        Verify(numbers_fail<sint32_t>("1,2\n3,x,5",           error_code::bad_parameter, 6, 1, 1, 3), "parse_numbers bad field");
+        Verify(numbers_fail<sint32_t>("1,2\n3,4x",            error_code::bad_parameter, 6, 1, 1, 3), "parse_numbers trailing junk");
+        Verify(numbers_fail<sint32_t>("1,,2",                  error_code::bad_parameter, 2, 0, 1, 1), "parse_numbers empty field");
+        Verify(numbers_fail<sint32_t>("1, 2",                  error_code::bad_parameter, 2, 0, 1, 1), "parse_numbers leading space");
+        Verify(numbers_fail<sint32_t>("1,2,\n3",               error_code::bad_parameter, 4, 0, 2, 2), "parse_numbers trailing delimiter");
+        Verify(numbers_fail<sint32_t>("1\n2147483648",          error_code::out_of_range,  2, 1, 0, 1), "parse_numbers s32 overflow");
+        Verify(numbers_fail<uint8_t>("255,256",                error_code::out_of_range,  4, 0, 1, 1), "parse_numbers u8 overflow");
+        Verify(numbers_fail<uint32_t>("-1",                    error_code::out_of_range,  0, 0, 0, 0), "parse_numbers unsigned negative");
+        Verify(numbers_fail<uint64_t>("18446744073709551616",  error_code::out_of_range,  0, 0, 0, 0), "parse_numbers u64 overflow");
+        Verify(numbers_fail<double>("1.5,1e999",               error_code::out_of_range,  4, 0, 1, 1), "parse_numbers double overflow");
+        Verify(numbers_fail<sint32_t>("1\t\t2",                error_code::bad_parameter, 2, 0, 1, 1, '\t'), "parse_numbers empty tsv field");
+
+        // A big column set, checked against from_chars field by field
+        string text;
+        char buf[32];
+        uint64_t x = 88172645463325252ull;
+        for (size_t i = 0; i < 5000; ++i) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            const auto val = static_cast<sint64_t>(x) >> (x % 63);
+            auto [ptr, ec] = to_chars(buf, buf + sizeof(buf), val);
+            text.append(buf, static_cast<size_t>(ptr - buf));
+            text += ((i % 7 == 6) || (i == 4999)) ? '\n' : ',';
+        }
+
+        vector<sint64_t> big;
+        res = parse_numbers(big, string_view(text.data(), text.length()));
+        Verify(!is_error(res.ec) && (big.size() == 5000), "parse_numbers big");
+        size_t at = 0;
+        for (size_t i = 0; i < big.size(); ++i) {
+            size_t stop = at;
+            while ((text[stop] != ',') && (text[stop] != '\n'))
+                ++stop;
+            sint64_t val = 0;
+            from_chars(val, string_view(text.data() + at, stop - at));
+            Verify(big[i] == val, "parse_numbers big values");
+            at = stop + 1;
+        }
+    }
+
     bool RunTests() override
     {
         // Note: All tests are constexpr here, so if it compiles, then it
@@ -73,6 +558,14 @@ public:
 
         // TODO : Probably want to verify some failures here, too.
 
+        TestIntegerToChars();
+        TestIntegerFromChars();
+        Test128Bit();
+        TestFloatingPoint();
+        TestFloatingPointParse();
+        TestBytes();
+        TestParseNumbers();
+
         return true;
     }
 };
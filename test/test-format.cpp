@@ -53,6 +53,77 @@ public:
     }
 };
 
+/// Formatted as an int, but parsed at run time like any user-defined type
+struct Degrees
+{
+    int v{0};
+};
+
+template<> struct sys::formatter<Degrees> : public sys::formatter<int>
+{
+    template <class FormatCtx>
+    constexpr auto format(Degrees d, FormatCtx& f_ctx) -> FormatCtx::iterator
+    {
+        return formatter<int>::format(d.v, f_ctx);
+    }
+};
+
+/// A length; formatted like an int with a unit
+struct Meters
+{
+    int v{0};
+};
+
+/// Has formatter<int>'s spec accessors, plus state of its own (the unit)
+template<> struct sys::formatter<Meters> : public sys::formatter<int>
+{
+    static inline size_t parse_count = 0;
+
+    string_view _unit{"m"};
+
+    template <class ParseCtx>
+    auto parse(ParseCtx& p_ctx) -> ParseCtx::iterator
+    {
+        ++parse_count;
+        if (!p_ctx.is_empty() && (*p_ctx.begin() == 'k')) {
+            _unit = "km";
+            p_ctx.advance_by(1);
+        }
+        return formatter<int>::parse(p_ctx);
+    }
+
+    template <class FormatCtx>
+    auto format(Meters m, FormatCtx& f_ctx) -> FormatCtx::iterator
+    {
+        f_ctx.advance_to(formatter<int>::format(m.v, f_ctx));
+        return imp::put_run(f_ctx.out(), _unit);
+    }
+};
+
+/// Output stream that records what it is handed
+class RecordingStream : public io::ostream
+{
+public:
+
+    string  text;
+    size_t  sinks{0};
+    size_t  largest{0};
+    bool    broken{false};  ///< Refuse everything
+
+protected:
+
+    bool sink(const char_t* data, size_t length) override
+    {
+        if (broken)
+            return false;
+        text.append(data, length);
+        ++sinks;
+        if (length > largest)
+            largest = length;
+        return true;
+    }
+};
+
 class TestFormat : public TestApp
 {
 public:
@@ -149,6 +220,13 @@ public:
         print_str(format(" sintmax_t:              {}\n", static_cast<sintmax_t>(42)));
         print_str(format(" time_t:                 {}\n", static_cast<time_t>(42)));
 
+        // -- Floating-point things ----------------------------------------
+
+        print_str("Floating-point types\n");
+        print_str(format(" float:                  {}\n", 4.2f));
+        print_str(format(" double:                 {}\n", 4.2));
+        print_str(format(" long double:            {}\n", 4.2L));
+
         // -- Boolean things -----------------------------------------------
 
         constexpr bool bool_val = true;
@@ -199,11 +277,360 @@ public:
         VerifyThrow(sys::formatted_size("cat{:10}", 0)   == 13);
     }
 
+    void TestBulkOutput()
+    {
+        sys::println_str("-- Literal runs, fills, and escapes");
+
+        VerifyThrow(format("cat")                   == "cat");
+        VerifyThrow(format("{{cat}}")               == "{cat}");
+        VerifyThrow(format("a{{b}}c{}d", 1)         == "a{b}c1d");
+        VerifyThrow(format("{:>6}|{:<4}|", 42, 7)   == "    42|7   |");
+        VerifyThrow(format("{:*^9}", "dog")         == "***dog***");
+        VerifyThrow(format("{:#010X}", 255)         == "0X000000FF");
+        VerifyThrow(format("{:?}", "a\tb\"c")       == "\"a\\tb\\\"c\"");
+        VerifyThrow(format("{:>50}", 1).length()    == 50);
+
+        // Long output spills past the format buffer's local storage
+        string big(format("{:>2000}{}", "x", "yz"));
+        VerifyThrow(big.length() == 2002);
+        VerifyThrow(big.ends_with("xyz"));
+
+        // Back inserters take the bulk path, and plain pointers, which
+        // can't, get their output a char at a time
+        string s;
+        format_to(back_insert_iterator(s), "{}-{:03}", "moo", 7);
+        VerifyThrow(s == "moo-007");
+        static_assert(bulk_output_iterator<back_insert_iterator<string>>);
+        static_assert(!bulk_output_iterator<char*>);
+        char out[16];
+        char* out_end = format_to(out, "{}-{:>4}{:*<3}", "moo", 7, "x");
+        VerifyThrow(string_view(out, static_cast<size_t>(out_end - out)) == "moo-   7x**");
+
+        // Output goes to the thread's scratch buffer, which is kept for
+        // reuse unless it grew too large
+        auto& scratch = imp::fmt_thread_scratch();
+        VerifyThrow(format("{:>1000}", 1).length() == 1000);
+        VerifyThrow(!scratch.in_use && (scratch.capacity >= 1000));
+        VerifyThrow(format("{:>100000}", 1).length() == 100000);
+        VerifyThrow(!scratch.in_use && (scratch.capacity == 0));
+
+        // A buffer created while the scratch buffer is busy has its own
+        {
+            imp::fmt_buf<> outer;
+            outer.append("ab", 2);
+            {
+                imp::fmt_buf<> inner;
+                inner.push_back('c');
+                VerifyThrow(inner.release_string() == "c");
+            }
+            {
+                // ...which starts out local and moves to the heap if need be
+                imp::fmt_buf<4> inner;
+                inner.append("cde", 3);
+                inner.append("fghij", 5);
+                inner.push_back('k');
+                VerifyThrow(inner.release_string() == "cdefghijk");
+            }
+            VerifyThrow(format("{:>600}", 1).length() == 600);
+            VerifyThrow(scratch.in_use && (outer.release_string() == "ab"));
+        }
+
+        bool threw = false;
+        const string_view oops("oops}");
+        try { (void)vformat(oops, make_format_args()); } catch (const error_format&) { threw = true; }
+        VerifyThrow(threw);
+    }
+
+    void TestBoundedOutput()
+    {
+        sys::println_str("-- Bounded output: format_to_n and format_into");
+
+        char buf[8];
+        auto res = format_to_n(buf, sizeof(buf), "{}-{}", 12, "ab");
+        VerifyThrow((res.size == 5) && !res.truncated);
+        VerifyThrow(string_view(buf, static_cast<size_t>(res.out - buf)) == "12-ab");
+
+        res = format_to_n(buf, 4, "{:>2000}{}", "x", 42);
+        VerifyThrow((res.size == 2002) && res.truncated);
+        VerifyThrow(res.out == buf + 4);
+        VerifyThrow(string_view(buf, 4) == "    ");
+
+        res = format_to_n(buf, 0, "{}", 1.5);
+        VerifyThrow((res.out == buf) && (res.size == 3) && res.truncated);
+
+        char small[6];
+        res = format_into(small, "{}", -1234567);
+        VerifyThrow((res.size == 8) && res.truncated);
+        VerifyThrow((res.out == small + 5) && (string_view(small, 6) == string_view("-1234", 6)));
+
+        res = format_into(small, "{}", 'a' == 'a');
+        VerifyThrow(!res.truncated && (res.out == small + 4) && (small[4] == '\0'));
+    }
+
+    void TestFloatingPoint()
+    {
+        sys::println_str("-- Floating-point formatting");
+
+        VerifyThrow(format("{}", 0.1 + 0.2)         == "0.30000000000000004");
+        VerifyThrow(format("{}", 1e21)              == "1e+21");
+        VerifyThrow(format("{}", 2.5f)              == "2.5");
+        VerifyThrow(format("{:.2f}", 3.14159)       == "3.14");
+        VerifyThrow(format("{:.2f}", 2.675)         == "2.67");
+        VerifyThrow(format("{:f}", 1.5)             == "1.500000");
+        VerifyThrow(format("{:e}", 1234.5)          == "1.234500e+03");
+        VerifyThrow(format("{:.3E}", 1234.5)        == "1.234E+03");
+        VerifyThrow(format("{:g}", 1234567.0)       == "1.23457e+06");
+        VerifyThrow(format("{:G}", 1e-10)           == "1E-10");
+        VerifyThrow(format("{:.3}", 3.14159)        == "3.14");
+        VerifyThrow(format("{:a}", 1.0)             == "1p+0");
+        VerifyThrow(format("{:.2A}", 1.0)           == "1.00P+0");
+        VerifyThrow(format("{:#}", 1.0)             == "1.");
+        VerifyThrow(format("{:#g}", 1.0)            == "1.00000");
+        VerifyThrow(format("{:+.1f}", 2.25)         == "+2.2");
+        VerifyThrow(format("{: }", 1.0)             == " 1");
+        VerifyThrow(format("{:08.2f}", -3.14159)    == "-0003.14");
+        VerifyThrow(format("{:*^9.1f}", 2.5)        == "***2.5***");
+        VerifyThrow(format("{:<6}|", 0.5)           == "0.5   |");
+        VerifyThrow(format("{:.{}f}", 1.0, 3)       == "1.000");
+        VerifyThrow(format("{:{}.{}f}", 1.0, 6, 1)  == "   1.0");
+        VerifyThrow(format("{}", -0.0)              == "-0");
+
+        constexpr double inf = __builtin_inf();
+        VerifyThrow(format("{}", -inf)              == "-inf");
+        VerifyThrow(format("{:06F}", inf)           == "   INF");
+        VerifyThrow(format("{}", __builtin_nan("")) == "nan");
+
+        // Precision larger than any buffer we'd want on the stack
+        VerifyThrow(format("{:.1000f}", 1.0).length() == 1002);
+    }
+
+    void TestFormatPlan()
+    {
+        sys::println_str("-- Compiled format strings");
+
+        // Format strings are broken into segments at compile time
+        constexpr format_string<int, int> fs{"a{0}b{1:>3}c"};
+        static_assert(fs.get_plan().valid);
+        static_assert(fs.get_plan().seg_count == 3);
+        static_assert(fs.get_plan().field_count == 2);
+        static_assert(fs.get_plan().fields[1].arg_idx == 1);
+        static_assert(fs.get_plan().fields[1].have_spec);
+        static_assert(fs.get_plan().fields[1].spec.width == 3);
+
+        VerifyThrow(format("a{0}b{1:>3}c", 4, 2)     == "a4b  2c");
+        VerifyThrow(format("{1}{0}{1}", "x", "y")   == "yxy");
+        VerifyThrow(format("{:>{}}|", 7, 4)         == "   7|");
+        VerifyThrow(format("{:{}}|", "ab", 4)       == "ab  |");
+
+        // Parsed again at run time; a nested field still takes the next argument
+        VerifyThrow(format("{}|{:>{}}|", 1, Degrees{7}, 4) == "1|   7|");
+
+        // Too elaborate to plan; falls back to runtime parsing
+        constexpr format_string<> busy{"{{{{{{{{{{{{"};
+        static_assert(!busy.get_plan().valid);
+        VerifyThrow(format("{{{{{{{{{{{{") == "{{{{{{");
+        VerifyThrow(format("{0}{0}{0}{0}", 1) == "1111");
+    }
+
+    void TestCompiledFormat()
+    {
+        sys::println_str("-- Format strings compiled at run time");
+
+        // Pretend this came from a config file
+        string fmt_text("{2:>4}|{0}|{1:!}|{1}|{{{2:+}}}");
+        const compiled_format<string, MyClass, int> cf(fmt_text);
+        fmt_text.clear();
+        VerifyThrow(cf.get_field_count() == 5);
+
+        const MyClass mc(7);
+        for (int i = 0; i < 3; ++i)
+            VerifyThrow(format(cf, "ab", mc, i + 10) == format("{2:>4}|{0}|{1:!}|{1}|{{{2:+}}}", "ab", mc, i + 10));
+
+        string s;
+        format_to(back_insert_iterator(s), cf, string("x"), MyClass(1), 255);
+        VerifyThrow(s == " 255|x|!1|1|{+255}");
+
+        // Width from an argument and many more fields than arguments
+        const compiled_format<int, int> wide("{0:{1}}{0}{0}{0}{0}{0}{0}{0}{0}{0}{0}{0}");
+        VerifyThrow(format(wide, 1, 3) == "  111111111111");
+
+        // A user-defined type's formatter is kept, not parsed again, even
+        // if it looks like a standard one
+        static_assert(presettable_formatter<formatter<Meters>>);
+        formatter<Meters>::parse_count = 0;
+        const compiled_format<Meters, int> cm("{0:k>5}|{1:>3}|{0}");
+        for (int i = 0; i < 5; ++i)
+            VerifyThrow(format(cm, Meters{i}, i) == format("{:>5}km|{:>3}|{}m", i, i, i));
+        VerifyThrow(formatter<Meters>::parse_count == 2);
+
+        bool threw = false;
+        try { compiled_format<int> bad("{1}"); } catch (const error_format&) { threw = true; }
+        VerifyThrow(threw);
+    }
+
+    void TestRanges()
+    {
+        sys::println_str("-- Ranges, optional, and variant");
+
+        vector<int> v;
+        for (int i = 1; i <= 4; ++i)
+            v.push_back(i * 5);
+        const array<unsigned, 3> a{1, 2, 3};
+        vector<string> vs;
+        vs.push_back(string("a\tb"));
+        vs.push_back(string("c"));
+
+        VerifyThrow(format("{}", v)             == "[5, 10, 15, 20]");
+        VerifyThrow(format("{:n}", v)           == "5, 10, 15, 20");
+        VerifyThrow(format("{::03}", v)         == "[005, 010, 015, 020]");
+        VerifyThrow(format("{:n:>{}}", a, 2)    == " 1,  2,  3");
+        VerifyThrow(format("{}", vs)            == "[\"a\\tb\", \"c\"]");
+        VerifyThrow(format("{::s}", vs)         == "[a\tb, c]");
+        VerifyThrow(format("{}", vector<int>{}) == "[]");
+
+        vector<MyClass> vm;
+        vm.push_back(MyClass(1));
+        vm.push_back(MyClass(2));
+        VerifyThrow(format("{::!}", vm)         == "[!1, !2]");
+
+        formatter<vector<int>> f;
+        f.set_separator("|");
+        f.set_brackets("<", ">");
+        string s;
+        const auto f_args = make_format_args<basic_format_context<back_insert_iterator<string>>>(v);
+        basic_format_context f_ctx(f_args, back_insert_iterator(s));
+        parse_context p_ctx("}", 1);
+        f.parse(p_ctx);
+        f.format(v, f_ctx);
+        VerifyThrow(s == "<5|10|15|20>");
+
+        optional<int> o;
+        VerifyThrow(format("{}", o)             == "none");
+        o = 42;
+        VerifyThrow(format("{:>4}", o)          == "  42");
+
+        variant<int, string_view, double> var{string_view("moo")};
+        VerifyThrow(format("{}", var)           == "moo");
+        var = 2.5;
+        VerifyThrow(format("{}", var)           == "2.5");
+
+        // Their state isn't all in a format_spec_t, so a compiled format
+        // keeps the parsed formatter rather than parsing on every call
+        static_assert(!presettable_formatter<formatter<vector<int>>>);
+        static_assert(!presettable_formatter<formatter<variant<int, double>>>);
+        vector<Meters> vd;
+        vd.push_back(Meters{3});
+        vd.push_back(Meters{14});
+        formatter<Meters>::parse_count = 0;
+        const compiled_format<vector<Meters>> cr("{:n:k>3}");
+        for (int i = 0; i < 5; ++i)
+            VerifyThrow(format(cr, vd) == "  3km,  14km");
+        VerifyThrow(formatter<Meters>::parse_count == 1);
+    }
+
+    void TestFormatSink()
+    {
+        sys::println_str("-- Streaming output through format_sink");
+
+        // Small output is handed over in one piece when the sink goes away
+        RecordingStream rs;
+        print(rs, "{}-{}", 1, "two");
+        VerifyThrow((rs.text == "1-two") && (rs.sinks == 1));
+
+        // Large output goes out in chunks as it is formatted
+        vector<int> v;
+        for (int i = 0; i < 10000; ++i)
+            v.push_back(i);
+        RecordingStream big;
+        {
+            format_sink<RecordingStream, 256> sink(big);
+            format_to(back_insert_iterator(sink), "{}{:>1000}", v, "x");
+            VerifyThrow(sink.get_count() == formatted_size("{}{:>1000}", v, "x"));
+            VerifyThrow(big.sinks > 100);
+        }
+        VerifyThrow(big.text == format("{}{:>1000}", v, "x"));
+        VerifyThrow(big.largest == 256);
+
+        // A stream that fails to take the output is noticed
+        RecordingStream bad;
+        bad.broken = true;
+        format_sink<RecordingStream, 16> bad_sink(bad);
+        format_to(back_insert_iterator(bad_sink), "{}", 42);
+        VerifyThrow(bad_sink.good() && !bad_sink.flush() && !bad_sink.good());
+    }
+
+    void TestBytes()
+    {
+        sys::println_str("-- Bytes as hex");
+
+        const uint8_t bytes[] = { 0xDE, 0xAD, 0xbe, 0xef, 0x01 };
+        const byte_view bv(bytes, sizeof(bytes));
+        VerifyThrow(format("{}", bv) == "deadbeef01");
+        VerifyThrow(format("{:X}", bv) == "DEADBEEF01");
+        VerifyThrow(format("{:#x}", bv) == "0xdeadbeef01");
+        VerifyThrow(format("{:*>14}", bv) == "****deadbeef01");
+        VerifyThrow(format("{:^{}X}", bv, 13) == " DEADBEEF01  ");
+        VerifyThrow(format("[{}]", byte_view{}) == "[]");
+        VerifyThrow(formatted_size("{:#}", bv) == 12);
+
+        // Longer than one encoding block
+        constexpr char digits[] = "0123456789abcdef";
+        vector<uint8_t> v;
+        string expect;
+        for (size_t i = 0; i < 300; ++i) {
+            v.push_back(static_cast<uint8_t>(i * 13));
+            expect += digits[v.back() >> 4];
+            expect += digits[v.back() & 0xF];
+        }
+        VerifyThrow(format("{}", byte_view(v)) == expect);
+    }
+
+    void TestFormatArgs()
+    {
+        sys::println_str("-- Packed format arguments");
+
+        using imp::fmt_arg_type;
+        static_assert(sizeof(imp::fmt_arg_value) == 8);
+
+        // Tags are fixed at compile time; wide values are held by pointer
+        const uint128_t big = uint128_t{1} << 100;
+        const string s("str");
+        const MyClass mc(3);
+        const char ch = 'x';
+        const float f = 2.5f;
+        const auto args = make_format_args(big, s, mc, ch, f);
+        using store = format_args_store<format_context, const uint128_t, const string,
+            const MyClass, const char, const float>;
+        static_assert(store::types[0] == fmt_arg_type::u128);
+        static_assert(store::types[1] == fmt_arg_type::str);
+        static_assert(store::types[2] == fmt_arg_type::custom);
+        static_assert(store::types[4] == fmt_arg_type::f32);
+        static_assert(store::funcs[0] == nullptr);
+
+        VerifyThrow(args.count() == 5);
+        VerifyThrow(args.get(0).value().u128 == &big);
+        VerifyThrow(args.get(1).value().str == &s);
+        VerifyThrow(!args.get(5));
+
+        VerifyThrow(vformat("{0}|{1}|{2}|{4}", args) == "1267650600228229401496703205376|str|3|2.5");
+        VerifyThrow(format("{}{}{}{}", uint8_t{1}, sint8_t{-2}, uint16_t{3}, sint64_t{-4}) == "1-23-4");
+        VerifyThrow(format("{:{}}|{:.{}}", 1, 3u, "abc", 2) == "  1|ab");
+    }
+
     bool RunTests() override
     {
         try {
             TestEasySingleConversions();
             TestFormattedSize();
+            TestBulkOutput();
+            TestBoundedOutput();
+            TestFloatingPoint();
+            TestFormatPlan();
+            TestFormatArgs();
+            TestCompiledFormat();
+            TestRanges();
+            TestFormatSink();
+            TestBytes();
         }
         catch (sys::exception& e) {
             // This is a good candidate for sys::print, but since we're testing
@@ -0,0 +1,128 @@
+#include "test_app.h"
+#include <intern_pool_.h>
+#include <string_.h>
+
+using namespace sys;
+
+class TestInternPool : public TestApp
+{
+public:
+
+    void CheckFundamental()
+    {
+        stout()->out("Checking fundamentals...\n");
+
+        const symbol null_sym;
+        Verify(!null_sym && (null_sym.id() == 0) && null_sym.view().is_empty(), "null symbol");
+        Verify((null_sym.c_str()[0] == 0) && (null_sym.hash() == 0), "null symbol c_str");
+
+        intern_pool pool;
+        Verify((pool.size() == 0) && !pool.find("Echoes"), "empty pool");
+
+        const auto a = pool.intern("Echoes");
+        const auto b = pool.intern("Fearless");
+        Verify(a && b && (a != b), "distinct symbols");
+        Verify((a.id() == 1) && (b.id() == 2) && (pool.size() == 2), "ids are dense");
+        Verify((a.view() == "Echoes") && (a.length() == 6), "view");
+        Verify(string_view(b.c_str()) == "Fearless", "c_str");
+        Verify(a.hash() == imp::hash_bytes("Echoes", 6), "cached hash");
+        Verify(a < b, "ordered by id");
+
+        // Interning again, from different storage, gives the same symbol
+        string s("Ech");
+        s += "oes";
+        const auto a2 = pool.intern(s);
+        Verify((a2 == a) && (a2.view().data() == a.view().data()), "same symbol");
+        Verify((pool.find("Fearless") == b) && !pool.find("Fearles"), "find");
+        Verify((pool.from_id(2) == b) && !pool.from_id(0) && !pool.from_id(3), "from_id");
+        Verify(pool.size() == 2, "no duplicates");
+
+        const auto e = pool.intern("");
+        Verify(e && (e.id() == 3) && e.view().is_empty() && (pool.intern("") == e), "empty string");
+
+        // Same id, different pool: not equal, and not equivalent either
+        intern_pool other;
+        const auto oa = other.intern("Echoes");
+        Verify((oa.id() == a.id()) && (oa != a) && ((oa <=> a) != 0), "different pools");
+        Verify(((oa < a) != (a < oa)) && (a <= a2) && (a >= a2), "consistent ordering");
+    }
+
+    void CheckMany()
+    {
+        stout()->out("Checking many symbols...\n");
+
+        // Enough to grow the hash table and the id list several times, with
+        // views taken early that have to stay good
+        constexpr uint32_t count = 20000;
+        intern_pool pool;
+        const auto first = pool.intern("name0");
+        const string_view first_view = first.view();
+        for (uint32_t i = 0; i < count; ++i) {
+            string name("name");
+            name += string_view(i & 1 ? "_odd_" : "");
+            name.append(static_cast<char>('a' + i % 26));
+            name.append('x', i % 7);
+            name.append(static_cast<char>('0' + i / 26 % 10));
+            name.append(static_cast<char>('0' + i / 260 % 10));
+            name.append(static_cast<char>('0' + i / 2600 % 10));
+            pool.intern(name);
+        }
+
+        bool ok = true;
+        for (uint32_t id = 1; id <= pool.size(); ++id) {
+            const auto sym = pool.from_id(id);
+            ok = ok && (sym.id() == id) && (pool.intern(sym.view()) == sym);
+        }
+        Verify(ok, "ids round trip");
+        Verify((first.view().data() == first_view.data()) && (first_view == "name0"), "views are stable");
+
+        // A string that's bigger than an arena block
+        const string big('z', 40000);
+        const auto zs = pool.intern(big);
+        Verify((zs.view() == string_view(big)) && (pool.find(big) == zs), "big string");
+        Verify(pool.from_id(1) == first, "old symbols after a big one");
+    }
+
+    void CheckSharded()
+    {
+        stout()->out("Checking sharded pool...\n");
+
+        sharded_intern_pool pool;
+        Verify((pool.size() == 0) && !pool.find("Time"), "empty pool");
+
+        string names[500];
+        symbol syms[500];
+        for (size_t i = 0; i < 500; ++i) {
+            names[i] = "Breathe";
+            names[i].append(static_cast<char>('A' + i % 26));
+            names[i].append(static_cast<char>('A' + i / 26));
+            syms[i] = pool.intern(names[i]);
+        }
+        Verify(pool.size() == 500, "size");
+
+        bool ok = true;
+        for (size_t i = 0; i < 500; ++i) {
+            ok = ok && syms[i] && (syms[i].view() == string_view(names[i]));
+            ok = ok && (pool.intern(names[i]) == syms[i]) && (pool.find(names[i]) == syms[i]);
+            ok = ok && (pool.from_id(syms[i].id()) == syms[i]);
+            for (size_t j = 0; j < i; ++j)
+                ok = ok && (syms[j].id() != syms[i].id());
+        }
+        Verify(ok, "ids are unique and round trip");
+        Verify(!pool.from_id(0) && !pool.from_id(uint32_t(-1)), "bad ids");
+    }
+
+    bool RunTests() override
+    {
+        CheckFundamental();
+        CheckMany();
+        CheckSharded();
+
+        return true;
+    }
+};
+
+sys::app* CreateApp()
+{
+    return new TestInternPool();
+}
@@ -0,0 +1,187 @@
+#include "test_app.h"
+#include <rope_.h>
+
+using namespace sys;
+
+class TestRope : public TestApp
+{
+public:
+
+    /// Returns true if every chunk is non-empty and they add up to the length
+    static bool chunks_ok(const rope& r)
+    {
+        size_t len = 0, count = 0;
+        bool ok = true;
+        r.for_each_chunk([&](string_view sv) {
+            ok = ok && !sv.is_empty();
+            len += sv.length();
+            ++count;
+        });
+        return ok && (len == r.length()) && (count == r.chunk_count());
+    }
+
+    void CheckFundamental()
+    {
+        stout()->out("Checking fundamentals...\n");
+
+        const rope r0;
+        Verify(r0.is_empty() && (r0.length() == 0) && (r0.chunk_count() == 0), "empty rope");
+        Verify(r0 == "", "empty rope compare");
+
+        rope r1("Shine On");
+        Verify((r1.length() == 8) && (r1 == "Shine On") && chunks_ok(r1), "construct");
+        Verify((r1.at(0) == 'S') && (r1.at(7) == 'n'), "at");
+        bool got_exception = false;
+        try { r1.at(8); }
+        catch (sys::error_bounds&) {
+            got_exception = true;
+        }
+        Verify(got_exception, "Didn't get an exception for bad at() index");
+
+        r1 += ' ';
+        r1 += "You Crazy";
+        r1.append(string_view(" Diamond"));
+        Verify(r1 == "Shine On You Crazy Diamond", "append");
+        Verify(r1.chunk_count() == 1, "small appends share a chunk");
+        Verify((r1.compare("Shine") > 0) && (r1.compare("Shine On You Crazy Diamonds") < 0) &&
+            (r1.compare("Shine On You Crazy Diamonc") > 0), "compare");
+
+        // Copies share, and are unaffected by later changes to either side
+        rope r2(r1);
+        r2 += ", Part I";
+        r1.erase(0, 9);
+        Verify(r1 == "You Crazy Diamond", "erase from copy");
+        Verify(r2 == "Shine On You Crazy Diamond, Part I", "copy unaffected");
+        rope r3(sys::move(r2));
+        Verify(r2.is_empty() && (r3.length() == 34), "move");
+        r3 = r1;
+        Verify(r3 == "You Crazy Diamond", "copy assign");
+        r3.clear();
+        Verify(r3.is_empty() && (r1.length() == 17), "clear");
+    }
+
+    void CheckZeroCopy()
+    {
+        stout()->out("Checking zero-copy appends...\n");
+
+        // Long strings are adopted, buffer and all
+        string s("We don't need no education, we don't need no thought control at all");
+        const char* p = s.data();
+        rope r(sys::move(s));
+        r.append(string(" - "));
+        string s2("No dark sarcasm in the classroom, teachers leave them kids alone");
+        const char* p2 = s2.data();
+        r.append(sys::move(s2));
+
+        size_t i = 0;
+        r.for_each_chunk([&](string_view sv) {
+            if (i == 0)
+                Verify(sv.data() == p, "adopted first string");
+            if (i == 2)
+                Verify(sv.data() == p2, "adopted last string");
+            ++i;
+        });
+        Verify(r.chunk_count() == 3, "three chunks");
+        Verify(r.to_string() == "We don't need no education, we don't need no thought control at all - "
+            "No dark sarcasm in the classroom, teachers leave them kids alone", "to_string");
+
+        // Appending a rope shares it, even onto itself
+        rope twice(r);
+        twice.append(twice);
+        Verify(twice.length() == 2 * r.length(), "self append");
+        Verify(twice.substr(r.length()).to_string() == r.to_string(), "self append content");
+
+        // Flattening makes a single chunk
+        const string_view flat = twice.flatten();
+        Verify((twice.chunk_count() == 1) && (flat.length() == twice.length()), "flatten");
+        Verify(flat.substr_view(0, r.length()) == string_view(r.to_string()), "flatten content");
+        Verify(twice.flatten().data() == flat.data(), "flatten when flat");
+    }
+
+    void CheckEdits()
+    {
+        stout()->out("Checking edits...\n");
+
+        rope r("Money, get away");
+        r.insert(0, "[");
+        r.insert(r.length(), "]");
+        r.insert(6, string_view(" money"));
+        Verify(r == "[Money money, get away]", "insert");
+        r.erase(1, 12);
+        Verify(r == "[ get away]", "erase");
+        r.erase(5);
+        Verify(r == "[ get", "erase to end");
+        r.insert(2, rope("Us and Them, "));
+        Verify(r == "[ Us and Them, get", "insert rope");
+        Verify(r.substr(2, 11) == "Us and Them", "substr");
+        Verify(r.substr(r.length()).is_empty(), "substr at end");
+
+        bool got_exception = false;
+        try { r.insert(r.length() + 1, "x"); }
+        catch (sys::error_bounds&) {
+            got_exception = true;
+        }
+        Verify(got_exception, "Didn't get an exception for bad insert() position");
+
+        // Random edits against a string doing the same thing
+        string ref;
+        rope big;
+        uint32_t seed = 1973;
+        auto next = [&seed](size_t n) {
+            seed = seed * 1664525u + 1013904223u;
+            return n ? (seed >> 8) % n : 0;
+        };
+        char piece[200];
+        for (int step = 0; step < 3000; ++step) {
+            const size_t len = 1 + next(sizeof(piece));
+            for (size_t i = 0; i < len; ++i)
+                piece[i] = static_cast<char>('a' + next(26));
+            const string_view sv(piece, len);
+
+            const size_t pos = next(ref.length() + 1);
+            switch (next(4)) {
+                case 0:
+                    ref.append(sv);
+                    big.append(sv);
+                    break;
+                case 1:
+                    ref.insert(pos, sv);
+                    big.insert(pos, sv);
+                    break;
+                case 2:
+                    ref.erase(pos, len / 2);
+                    big.erase(pos, len / 2);
+                    break;
+                default: {
+                    // Splice a piece of ourselves back in
+                    const size_t from = next(ref.length() + 1);
+                    const string sub(ref.substr_view(from, len));
+                    ref.insert(pos, sub);
+                    big.insert(pos, big.substr(from, len));
+                    break;
+                }
+            }
+
+            if (!Verify(big.length() == ref.length(), "random edit length"))
+                break;
+        }
+
+        Verify(big == ref, "random edits");
+        Verify(chunks_ok(big), "random edit chunks");
+        Verify(big.at(ref.length() / 2) == ref[ref.length() / 2], "random edit at");
+    }
+
+    bool RunTests() override
+    {
+        CheckFundamental();
+        CheckZeroCopy();
+        CheckEdits();
+
+        return true;
+    }
+};
+
+sys::app* CreateApp()
+{
+    return new TestRope();
+}
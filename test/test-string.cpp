@@ -1,5 +1,19 @@
 #include "test_app.h"
 #include <string_.h>
+#include <charconv_.h>
+#include <io_file_.h>
+
+#include <stdlib.h>     // mkstemp
+#include <unistd.h>     // unlink
+
+// Concatenation with qualified names and no using-directive; every + past
+// the first has to be found by ADL
+static constexpr sys::string concat_qualified(const sys::string& a, const sys::string& b, sys::string_view sv)
+{
+    sys::string s = a + b + "lit" + sv;
+    s += '<' + (sv + "|" + b) + '>';
+    return ("[" + a + "]") + ('(' + s + ')');
+}
 
 using namespace sys;
 
@@ -207,7 +221,7 @@ public:
 
         {
             // Move assignment (long)
-            constexpr const char* my_src = "Flippy dippy sippy";
+            constexpr const char* my_src = "Flippy dippy sippy, long enough for the heap";
             static_assert(string::traits_t::length(my_src) > string::sso_capacity());
             string movee(my_src);
             string s;
@@ -462,6 +476,16 @@ public:
         static_assert(0 == string("Mike ").operator+=('D').compare("Mike D"));
         static_assert(0 == string("Smurf ").operator+=("Soup").compare("Smurf Soup"));
         static_assert(0 == string("Mr ").operator+=(string_view("Twisted Sister")).compare("Mr Twisted Sister"));
+
+        // Appending grows the capacity geometrically, not a bit at a time
+        string s;
+        size_t reallocs = 0;
+        for (size_t i = 0; i < 10000; ++i) {
+            const auto cap = s.capacity();
+            s.append("abc", 3);
+            reallocs += (s.capacity() != cap);
+        }
+        Verify((s.length() == 30000) && (reallocs < 20), "append growth");
     }
 
     void CheckInsert()
@@ -533,6 +557,220 @@ public:
         static_assert(string("   \t\n\r\f\v").trim(false, true).is_empty());
         static_assert(string("   \t\n\r\f\v").trim(true, false).is_empty());
         static_assert(string("").trim().is_empty());
+
+        // With a char_set, and on the first char (which find_last_not_of used to skip)
+        static_assert(0 == string("--x--").trim(char_set("-")).compare("x"));
+        static_assert(0 == string("x   ").trim().compare("x"));
+
+        string long_str;
+        for (int i = 0; i < 100; ++i)
+            long_str += " \t";
+        long_str += "Comfortably Numb";
+        for (int i = 0; i < 100; ++i)
+            long_str += "\r\n";
+        Verify(long_str.trim() == "Comfortably Numb", "trim: long");
+        Verify(long_str.find_first_of(char_set("bN")) == 8, "find_first_of: char_set");
+        Verify(long_str.find_last_not_of(char_set("mb")) == 13, "find_last_not_of: char_set");
+    }
+
+    // Constant-initialized, so it starts out as whatever an empty string
+    // made during constant evaluation looks like
+    static constinit inline string const_empty{};
+
+    void CheckShortMode()
+    {
+        stout()->out("Checking short mode...\n");
+
+        // 23 chars fit in the object itself (on a 64-bit target)
+        static_assert(sizeof(string) == 3 * sizeof(void*));
+        static_assert(string::sso_capacity() == sizeof(string) - 1);
+
+        const string s0;
+        Verify(s0.capacity() == string::sso_capacity(), "empty string is short");
+        Verify(s0.data()[0] == 0, "empty string is terminated");
+
+        Verify(const_empty.is_empty() && (const_empty.data()[0] == 0), "constant-initialized empty");
+        const_empty = "Money";
+        Verify(const_empty == "Money", "constant-initialized assign");
+        const_empty.clear();
+
+        // Grow a char at a time across the short/long boundary
+        const char* src = "Wish You Were Here, how I wish, how I wish";
+        string s;
+        for (size_t len = 1; src[len - 1]; ++len) {
+            s.push_back(src[len - 1]);
+            Verify(s.length() == len, "push_back length");
+            Verify(s.data()[len] == 0, "push_back terminator");
+            Verify(string_view(s) == string_view(src, len), "push_back content");
+            Verify((len <= string::sso_capacity()) == (s.capacity() == string::sso_capacity()),
+                "short mode up to sso_capacity()");
+
+            // Copies and moves of each length
+            string c(s);
+            Verify(c == s, "copy");
+            string m(sys::move(c));
+            Verify(m == s, "move");
+            c = m;
+            Verify(c == s, "copy assign");
+        }
+
+        // And shrink back down; the capacity stays
+        const auto cap = s.capacity();
+        while (!s.is_empty()) {
+            s.pop_back();
+            Verify(string_view(s) == string_view(src, s.length()), "pop_back content");
+        }
+        Verify(s.capacity() == cap, "pop_back keeps capacity");
+
+        // A full short string: its last byte is the terminator
+        string full(src, string::sso_capacity());
+        Verify(full.length() == string::sso_capacity(), "full short length");
+        Verify(full.data()[string::sso_capacity()] == 0, "full short terminator");
+        full.resize(5);
+        Verify(full == "Wish ", "full short resize");
+    }
+
+    /// Fills p[0, n) with 'a', 'b', ... and keeps it all
+    static constexpr size_t fill_alpha(char* p, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            p[i] = static_cast<char>('a' + i % 26);
+        return n;
+    }
+
+    void CheckOverwrite()
+    {
+        stout()->out("Checking in-place writes...\n");
+
+        static_assert([] {
+            string s("Echoes");
+            s.resize_and_overwrite(3, [](char*, size_t) { return 2; });
+            return s == "Ec";
+        }());
+        static_assert([] {
+            string s;
+            s.resize_and_overwrite(5, fill_alpha);
+            s.append_uninitialized(2)[0] = 'x';
+            s.back() = 'y';
+            return s == "abcdexy";
+        }());
+        static_assert([] {
+            string s("Time");
+            s.reserve_discard(40);
+            return s.is_empty() && (s.capacity() >= 40);
+        }());
+
+        // Formatting straight into the string, short and long
+        string s("n=");
+        s.resize_and_overwrite(32, [](char* p, size_t n) {
+            return to_chars(p + 2, p + n, 1973).ptr - p;
+        });
+        Verify(s == "n=1973", "resize_and_overwrite to_chars");
+        Verify(s.data()[s.length()] == 0, "resize_and_overwrite terminator");
+        s.resize_and_overwrite(100, [this](char* p, size_t n) {
+            Verify(string_view(p, 6) == "n=1973", "resize_and_overwrite keeps contents");
+            return fill_alpha(p + 6, n - 6) + 6;
+        });
+        Verify((s.length() == 100) && (s[6] == 'a') && (s[99] == 'p'), "resize_and_overwrite grow");
+        Verify(s.data()[100] == 0, "resize_and_overwrite grow terminator");
+
+        // op can't claim more than it was given
+        bool got_exception = false;
+        try { s.resize_and_overwrite(4, [](char*, size_t n) { return n + 1; }); }
+        catch (sys::error_length&) {
+            got_exception = true;
+        }
+        Verify(got_exception, "resize_and_overwrite overrun");
+        Verify((s.length() == 4) && (s.data()[4] == 0), "resize_and_overwrite overrun terminator");
+
+        // Appends, across the short/long boundary
+        string a;
+        for (size_t i = 0; i < 40; ++i) {
+            char* p = a.append_uninitialized(1);
+            *p = static_cast<char>('a' + i % 26);
+            Verify(p == a.data() + i, "append_uninitialized position");
+            Verify(a.data()[i + 1] == 0, "append_uninitialized terminator");
+        }
+        string ref;
+        ref.resize_and_overwrite(40, fill_alpha);
+        Verify(a == ref, "append_uninitialized content");
+        char* tail = a.append_uninitialized(8);
+        to_chars(tail, tail + 8, 42);
+        a.resize(42);
+        Verify(a.substr_view(40) == "42", "append_uninitialized to_chars");
+
+        // Reading a file onto the end of a string; asks for more than is there.
+        // The scratch file is unlinked as soon as it's open so nothing is left
+        // behind, whatever happens.
+        char tmp_name[] = "/tmp/muse-test-string-XXXXXX";
+        io::file in(::mkstemp(tmp_name));
+        Verify(in.valid(), "read_append temp file");
+        ::unlink(tmp_name);
+        in.write_all("Wish you were here", 18);
+        in.seek(0);
+        string got("So, so you think ");
+        Verify(in.read_append(got, 4) == 4, "read_append");
+        Verify(in.read_append(got, 100) == 14, "read_append short read");
+        Verify(in.read_append(got, 100) == 0, "read_append at end");
+        Verify(got == "So, so you think Wish you were here", "read_append content");
+        Verify(got.data()[got.length()] == 0, "read_append terminator");
+
+        // Discarding, and assignments that don't keep the old contents
+        const auto cap = a.reserve_discard(10) ? a.capacity() : 0;
+        Verify(a.is_empty() && (a.capacity() == cap) && (a.data()[0] == 0), "reserve_discard no growth");
+        a.reserve_discard(200);
+        Verify(a.is_empty() && (a.capacity() == 200), "reserve_discard growth");
+        a.assign(ref);
+        Verify(a == ref, "assign after reserve_discard");
+        string b("short");
+        b = string_view(s);
+        Verify(b == s, "assign growth");
+        b.assign('z', 300);
+        Verify((b.length() == 300) && (b.find_first_not_of('z') == string::npos), "assign fill growth");
+    }
+
+    void CheckConcat()
+    {
+        stout()->out("Checking concatenation...\n");
+
+        static_assert(string(string("Dark") + " Side") == "Dark Side");
+        static_assert(string("Dark " + string("Side")) == "Dark Side");
+        static_assert(string(string("Dark") + ' ' + string_view("Side") + " of the " + string("Moon")) == "Dark Side of the Moon");
+        static_assert(string('[' + string("Animals") + ']') == "[Animals]");
+        static_assert(string((string("a") + "b") + ("c" + string("d"))) == "abcd");
+        static_assert(concat("The ", string("Wall"), ',', string_view(" 1979")) == "The Wall, 1979");
+        static_assert(concat().is_empty());
+        static_assert(string("Meddle").append_many() == "Meddle");
+        static_assert((string("Pigs") + " on the " + "Wing").length() == 16);
+        static_assert(concat_qualified("Us", "Them", "sv") == "[Us](UsThemlitsv<sv|Them>)");
+
+        // Everything's measured first, so a long result is one exact allocation
+        const string root("/usr/share");
+        const string_view dir("pink-floyd");
+        const char* name = "wish-you-were-here";
+        const string path = root + '/' + dir + '/' + name + ".flac";
+        Verify(path == "/usr/share/pink-floyd/wish-you-were-here.flac", "concat path");
+        Verify(path.capacity() == path.length(), "concat single allocation");
+        Verify(concat(root, '/', dir, '/', name, ".flac") == path, "concat()");
+
+        // Appending, with growth and without
+        string key("user:");
+        key.append_many("roger", ':', string_view("waters"));
+        Verify(key == "user:roger:waters", "append_many");
+        key.reserve(100);
+        const auto cap = key.capacity();
+        key += string(":") + "bass" + ':' + "vocals";
+        Verify((key == "user:roger:waters:bass:vocals") && (key.capacity() == cap), "append in place");
+
+        // Pieces that are views of the target itself
+        string echo("Echoes");
+        echo = echo + ", " + echo;
+        Verify(echo == "Echoes, Echoes", "self concat assign");
+        echo.append_many(' ', echo, ' ', echo.substr_view(0, 6));
+        Verify(echo == "Echoes, Echoes Echoes, Echoes Echoes", "self append_many");
+        string fits("ab");
+        fits.append_many(fits, fits);
+        Verify(fits == "ababab", "self append_many in place");
     }
 
     bool RunTests() override
@@ -548,6 +786,9 @@ public:
         CheckInsert();
         CheckReplace();
         CheckTrim();
+        CheckShortMode();
+        CheckOverwrite();
+        CheckConcat();
 
         return true;
     }
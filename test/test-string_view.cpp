@@ -299,6 +299,350 @@ public:
         Verify(sv2 == sv1c);
     }
 
+    // The run-time (vectorized) paths of char_traits<char>, checked against
+    // simple loops for every alignment and length near the block sizes
+    void CheckRuntimeTraits()
+    {
+        stout()->out("Checking run-time traits...\n");
+
+        using traits = string_view::traits_t;
+        constexpr auto npos = string_view::npos;
+
+        // Spans a page boundary so the near-page-end paths get some use
+        alignas(4096) static char buf[8192];
+        alignas(4096) static char buf2[8192];
+        for (size_t i = 0; i < sizeof(buf); ++i)
+            buf[i] = buf2[i] = static_cast<char>('a' + i % 23);
+
+        const size_t bases[] = { 0, 1, 7, 31, 4096 - 70, 4096 - 33, 4096 - 5 };
+        for (const size_t base : bases) {
+            for (size_t off = 0; off < 33; ++off) {
+                for (size_t len = 0; len < 70; ++len) {
+                    char* s = buf + base + off;
+                    char* t = buf2 + base + off;
+                    const char save = s[len];
+                    s[len] = 0;
+                    t[len] = 0;
+
+                    Verify(traits::length(s) == len, "length");
+                    Verify(traits::compare(s, t) == 0, "compare equal");
+                    Verify(traits::compare(s, t, len + 10) == 0, "compare past null");
+
+                    // A difference at the end of the string
+                    if (len) {
+                        t[len - 1] = '~';
+                        Verify(traits::compare(s, t) < 0, "compare less");
+                        Verify(traits::compare(t, s) > 0, "compare greater");
+                        Verify(traits::compare(s, t, len - 1) == 0, "compare count");
+                        t[len - 1] = s[len - 1];
+                    }
+
+                    // First and last occurrences of a char placed at either end
+                    const string_view sv(s, len);
+                    Verify(sv.find_first('#') == npos, "find_first absent");
+                    Verify(sv.find_last('#') == npos, "find_last absent");
+                    if (len) {
+                        s[len / 3] = '#';
+                        s[len - 1 - len / 4] = '#';
+                        Verify(sv.find_first('#') == len / 3, "find_first");
+                        Verify(sv.find_last('#') == len - 1 - len / 4, "find_last");
+                        Verify(sv.find_first('#', len / 3 + 1) ==
+                            ((len / 3 < len - 1 - len / 4) ? len - 1 - len / 4 : npos), "find_first pos");
+                        Verify(sv.find_last('#', len / 3) == len / 3, "find_last pos");
+                        s[len / 3] = t[len / 3];
+                        s[len - 1 - len / 4] = t[len - 1 - len / 4];
+                    }
+
+                    s[len] = save;
+                    t[len] = save;
+                }
+            }
+        }
+
+        // A null in both strings stops the comparison
+        Verify(traits::compare("abc\0x", "abc\0y", 5) == 0, "compare stops at null");
+    }
+
+    // Reference substring searches
+    static size_t naive_first(string_view h, string_view nd, size_t pos)
+    {
+        for (size_t i = pos; i + nd.length() <= h.length(); ++i) {
+            size_t k = 0;
+            for (; (k < nd.length()) && (h[i + k] == nd[k]); ++k);
+            if (k == nd.length())
+                return i;
+        }
+        return string_view::npos;
+    }
+
+    static size_t naive_last(string_view h, string_view nd, size_t pos)
+    {
+        if (nd.length() > h.length())
+            return string_view::npos;
+        size_t i = h.length() - nd.length();
+        if (pos < i)
+            i = pos;
+        for (;; --i) {
+            size_t k = 0;
+            for (; (k < nd.length()) && (h[i + k] == nd[k]); ++k);
+            if (k == nd.length())
+                return i;
+            if (!i)
+                return string_view::npos;
+        }
+    }
+
+    // Substring search at compile time (Two-Way only) and at run time
+    // (vector filter, falling back to Two-Way on hard inputs)
+    void CheckSubstringSearch()
+    {
+        stout()->out("Checking substring search...\n");
+
+        constexpr auto npos = string_view::npos;
+
+        // Periodic and non-periodic needles in constant evaluation
+        static_assert(6    == string_view("abaabaabaabb").find_first("abaabb"));
+        static_assert(npos == string_view("abaabaabaaba").find_first("abaabb"));
+        static_assert(4    == string_view("aaaaaaaab").find_first("aaaab"));
+        static_assert(6    == string_view("abcabcabcab").find_last("abcab", 7));
+        static_assert(3    == string_view("abcabcabcab").find_last("abcab", 4));
+        static_assert(0    == string_view("aaaaaaaab").find_last("aaaa", 0));
+        static_assert(npos == string_view("aaaa").find_last("aaaaa"));
+        static_assert(npos == string_view("aaaa").find_first("aaaaa"));
+
+        // Pathological inputs: long runs of a char, with a needle that
+        // almost matches everywhere
+        static char hay[20000];
+        static char ab[600], ba[600];   // a...ab and ba...a
+        for (size_t i = 0; i < sizeof(ab); ++i)
+            ab[i] = ba[i] = 'a';
+        ab[sizeof(ab) - 1] = 'b';
+        ba[0] = 'b';
+
+        const size_t needle_lens[] = { 2, 3, 17, 64, 599 };
+        for (const size_t len : needle_lens) {
+            for (size_t i = 0; i < sizeof(hay); ++i)
+                hay[i] = 'a';
+
+            const string_view h(hay, sizeof(hay));
+            string_view nd(ab + sizeof(ab) - len, len);
+            Verify(h.find_first(nd) == npos, "find_first: no match in a run");
+            Verify(h.find_last(nd) == npos, "find_last: no match in a run");
+
+            hay[sizeof(hay) - 1] = 'b';
+            Verify(h.find_first(nd) == sizeof(hay) - len, "find_first: match at end of a run");
+            Verify(h.find_last(nd) == sizeof(hay) - len, "find_last: match at end of a run");
+
+            // Needle b a...a, matching at the very front
+            nd = string_view(ba, len);
+            hay[sizeof(hay) - 1] = 'a';
+            hay[0] = 'b';
+            Verify(h.find_first(nd) == 0, "find_first: match at front");
+            Verify(h.find_last(nd) == 0, "find_last: match at front");
+            Verify(h.find_first(nd, 1) == npos, "find_first: past the match");
+        }
+
+        // Every needle and position of a small alphabet against the
+        // reference searches, for both short and block-sized haystacks
+        static char text[300];
+        uint32_t seed = 12345;
+        for (size_t i = 0; i < sizeof(text); ++i) {
+            seed = seed * 1103515245u + 12345u;
+            text[i] = static_cast<char>('a' + ((seed >> 16) % 3));
+        }
+        for (size_t hl : { size_t(7), size_t(40), size_t(300) }) {
+            const string_view h(text, hl);
+            for (size_t nl = 1; nl <= 9; ++nl) {
+                for (size_t from = 0; from + nl <= hl; from += 5) {
+                    const string_view nd(text + from, nl);
+                    for (size_t pos = 0; pos < hl; pos += 3) {
+                        Verify(h.find_first(nd, pos) == naive_first(h, nd, pos), "find_first vs reference");
+                        Verify(h.find_last(nd, pos) == naive_last(h, nd, pos), "find_last vs reference");
+                    }
+                }
+            }
+        }
+    }
+
+    void CheckCharSet()
+    {
+        stout()->out("Checking char_set...\n");
+
+        constexpr char_set delims(",;:");
+        static_assert(delims.contains(';') && !delims.contains('.'));
+        static_assert(delims.count() == 3);
+        static_assert(char_set().is_empty());
+        static_assert((~delims).count() == 253);
+        static_assert((~delims).contains('\xFF') && !(~delims).contains(','));
+        static_assert((delims | char_set("ab")).count() == 5);
+        static_assert((delims & char_set(";a")) == char_set(";"));
+        static_assert(char_set("ab").erase('a') == char_set("b"));
+        static_assert(char_set::whitespace() == char_set(" \t\n\r\f\v"));
+
+        // Every char, including those with the top bit set
+        char_set all;
+        for (int c = 0; c < 256; ++c) {
+            Verify(!all.contains(static_cast<char>(c)), "char_set: not yet a member");
+            all.insert(static_cast<char>(c));
+            Verify(all.contains(static_cast<char>(c)), "char_set: member");
+            Verify(all.count() == size_t(c) + 1, "char_set: count");
+        }
+
+        // Searches by set at compile time
+        constexpr string_view csv("alpha,beta;gamma:delta");
+        static_assert(5  == csv.find_first_of(delims));
+        static_assert(16 == csv.find_last_of(delims));
+        static_assert(0  == csv.find_first_not_of(delims));
+        static_assert(16 == csv.find_first_of(delims, 11));
+        static_assert(0  == string_view("a  ").find_last_not_of(" "));
+        static_assert(0  == string_view("a,,").find_last_of("a"));
+        static_assert(string_view("\t x \n").trim(char_set::whitespace()) == "x");
+
+        // Long haystacks go through the kernels: check against the simple
+        // loops for every position of a member near the block sizes
+        static char buf[200];
+        const char_set set("\x01z\x80\xFE");
+        const char members[] = { '\x01', 'z', '\x80', '\xFE' };
+        constexpr auto npos = string_view::npos;
+        for (size_t len = 30; len < 140; len += 7) {
+            for (size_t i = 0; i < len; ++i)
+                buf[i] = static_cast<char>('a' + i % 25);     // Never 'z'
+            const string_view sv(buf, len);
+            Verify(sv.find_first_of(set) == npos, "find_first_of: absent");
+            Verify(sv.find_last_of(set) == npos, "find_last_of: absent");
+            Verify(sv.find_first_not_of(set) == 0, "find_first_not_of: none");
+            Verify(sv.find_last_not_of(set) == len - 1, "find_last_not_of: none");
+
+            for (size_t at = 0; at < len; ++at) {
+                const char save = buf[at];
+                buf[at] = members[at % 4];
+                Verify(sv.find_first_of(set) == at, "find_first_of");
+                Verify(sv.find_last_of(set) == at, "find_last_of");
+                Verify(sv.find_first_of(set, at + 1) == npos, "find_first_of: past");
+                Verify(sv.find_last_of(set, at ? at - 1 : npos) == (at ? npos : 0), "find_last_of: before");
+                buf[at] = save;
+            }
+
+            // All members but one
+            for (size_t i = 0; i < len; ++i)
+                buf[i] = members[i % 4];
+            for (size_t at = 0; at < len; ++at) {
+                const char save = buf[at];
+                buf[at] = '.';
+                Verify(sv.find_first_not_of(set) == at, "find_first_not_of");
+                Verify(sv.find_last_not_of(set) == at, "find_last_not_of");
+                Verify(sv.find_first_of(".") == at, "find_first_of: one char");
+                buf[at] = save;
+            }
+        }
+
+        // trim of long runs of whitespace
+        for (size_t i = 0; i < sizeof(buf); ++i)
+            buf[i] = " \t\r\n"[i % 4];
+        buf[100] = 'x';
+        buf[140] = 'y';
+        string_view sv(buf, sizeof(buf));
+        Verify(sv.trim() == string_view(buf + 100, 41), "trim: long");
+        Verify(string_view(buf, 100).trim().is_empty(), "trim: all whitespace");
+    }
+
+    // Straightforward definitions to check the classification table against
+    static constexpr bool is_class_ref(unsigned c, char_class cls)
+    {
+        const bool upper = (c >= 'A') && (c <= 'Z');
+        const bool lower = (c >= 'a') && (c <= 'z');
+        const bool digit = (c >= '0') && (c <= '9');
+        const bool graph = (c >= 33) && (c <= 126);
+        switch (cls) {
+            case char_class::control: return (c < 32) || (c == 127);
+            case char_class::space:   return (c == ' ') || ((c >= 9) && (c <= 13));
+            case char_class::blank:   return (c == ' ') || (c == '\t');
+            case char_class::upper:   return upper;
+            case char_class::lower:   return lower;
+            case char_class::digit:   return digit;
+            case char_class::xdigit:  return digit || ((c | 32) >= 'a' && (c | 32) <= 'f');
+            case char_class::punct:   return graph && !upper && !lower && !digit;
+            case char_class::print:   return (c >= 32) && (c <= 126);
+            case char_class::alpha:   return upper || lower;
+            case char_class::alnum:   return upper || lower || digit;
+            case char_class::graph:   return graph;
+            default:                  return false;
+        }
+    }
+
+    static constexpr bool classes_match()
+    {
+        using traits = string_view::traits_t;
+        const char_class classes[] = {
+            char_class::control, char_class::space, char_class::blank, char_class::upper,
+            char_class::lower, char_class::digit, char_class::xdigit, char_class::punct,
+            char_class::print, char_class::alpha, char_class::alnum, char_class::graph };
+
+        for (unsigned c = 0; c < 256; ++c) {
+            const char ch = static_cast<char>(c);
+            for (const auto cls : classes) {
+                if (traits::is_class(ch, cls) != is_class_ref(c, cls))
+                    return false;
+            }
+            const unsigned lower = ((c >= 'A') && (c <= 'Z')) ? c + 32 : c;
+            const unsigned upper = ((c >= 'a') && (c <= 'z')) ? c - 32 : c;
+            if ((static_cast<unsigned char>(traits::to_lower(ch)) != lower) ||
+                (static_cast<unsigned char>(traits::to_upper(ch)) != upper))
+                return false;
+        }
+        return true;
+    }
+
+    void CheckClassification()
+    {
+        stout()->out("Checking classification...\n");
+
+        using traits = string_view::traits_t;
+
+        static_assert(classes_match());
+        static_assert(traits::is_punctuation('!') && traits::is_punctuation('~'));
+        static_assert(!traits::is_punctuation('a') && !traits::is_punctuation('5'));
+        static_assert(!traits::is_punctuation(' ') && !traits::is_punctuation('\x80'));
+        static_assert(traits::is_class('_', char_class::digit | char_class::punct));
+        static_assert(!traits::is_class('_', char_class::alnum | char_class::space));
+
+        // Bulk routines at compile time
+        static_assert([] {
+            char s[] = "Shine On You Crazy Diamond!";
+            traits::to_upper_inplace(s, sizeof(s) - 1);
+            return string_view(s, sizeof(s) - 1) == "SHINE ON YOU CRAZY DIAMOND!";
+        }());
+        static_assert(5 == traits::count_if_class("Echoes 1971", 11, char_class::digit | char_class::space));
+
+        // And at run time, for every length around the block sizes; the
+        // buffer holds every char value
+        static char buf[300], ref[300];
+        for (size_t len = 0; len < sizeof(buf); len += (len < 70) ? 1 : 23) {
+            for (size_t i = 0; i < len; ++i)
+                buf[i] = ref[i] = static_cast<char>(i * 7 + len);
+
+            traits::to_lower_inplace(buf, len);
+            bool ok = true;
+            for (size_t i = 0; i < len; ++i)
+                ok = ok && (buf[i] == traits::to_lower(ref[i]));
+            Verify(ok, "to_lower_inplace");
+
+            traits::to_upper_inplace(buf, len);
+            for (size_t i = 0; i < len; ++i)
+                ok = ok && (buf[i] == traits::to_upper(ref[i]));
+            Verify(ok, "to_upper_inplace");
+
+            for (const auto cls : { char_class::alpha, char_class::punct | char_class::space,
+                char_class::xdigit, char_class::none })
+            {
+                size_t n = 0;
+                for (size_t i = 0; i < len; ++i)
+                    n += traits::is_class(ref[i], cls);
+                Verify(traits::count_if_class(ref, len, cls) == n, "count_if_class");
+            }
+        }
+    }
+
     bool RunTests() override
     {
         CheckFundamental();
@@ -308,6 +652,10 @@ public:
         CheckSubStrings();
         CheckSearch();
         CheckModifiers();
+        CheckRuntimeTraits();
+        CheckSubstringSearch();
+        CheckCharSet();
+        CheckClassification();
 
         return true;
     }